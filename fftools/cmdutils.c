@@ -868,6 +868,33 @@ int opt_cpuflags(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+int opt_cpuflags_subsystem(void *optctx, const char *opt, const char *arg)
+{
+    char name[32];
+    const char *flags_str = strchr(arg, '=');
+    unsigned flags = av_get_cpu_flags();
+    int ret;
+
+    if (!flags_str || flags_str - arg >= sizeof(name)) {
+        av_log(NULL, AV_LOG_FATAL, "Invalid argument '%s', expected subsystem=flags\n", arg);
+        return AVERROR(EINVAL);
+    }
+    av_strlcpy(name, arg, flags_str - arg + 1);
+
+    if ((ret = av_parse_cpu_caps(&flags, flags_str + 1)) < 0)
+        return ret;
+
+    if ((ret = av_cpu_set_subsystem_mask(name, flags)) < 0) {
+        int i;
+        av_log(NULL, AV_LOG_FATAL, "Unknown subsystem '%s', known subsystems are:", name);
+        for (i = 0; av_cpu_subsystem_name(i); i++)
+            av_log(NULL, AV_LOG_FATAL, " %s", av_cpu_subsystem_name(i));
+        av_log(NULL, AV_LOG_FATAL, "\n");
+        return ret;
+    }
+    return 0;
+}
+
 int opt_loglevel(void *optctx, const char *opt, const char *arg)
 {
     const struct { const char *name; int level; } log_levels[] = {
@@ -265,6 +265,8 @@ typedef struct SingleChannelElement {
     DECLARE_ALIGNED(16, INTFLOAT, ltp_state)[3072]; ///< time signal for LTP
     DECLARE_ALIGNED(32, AAC_FLOAT, lcoeffs)[1024];  ///< MDCT of LTP coefficients (used by encoder)
     DECLARE_ALIGNED(32, AAC_FLOAT, prcoeffs)[1024]; ///< Main prediction coefs (used by encoder)
+    DECLARE_ALIGNED(32, INTFLOAT, buf_mdct)[1024];  ///< IMDCT output, kept per channel so elements can be decoded concurrently
+    DECLARE_ALIGNED(32, INTFLOAT, temp)[128];       ///< windowing scratch
     PredictorState predictor_state[MAX_PREDICTORS];
     INTFLOAT *ret;                                  ///< PCM output
 } SingleChannelElement;
@@ -308,14 +310,6 @@ struct AACContext {
     int warned_remapping_once;
     /** @} */
 
-    /**
-     * @name temporary aligned temporary buffers
-     * (We do not want to have these on the stack.)
-     * @{
-     */
-    DECLARE_ALIGNED(32, INTFLOAT, buf_mdct)[1024];
-    /** @} */
-
     /**
      * @name Computed / set up during initialization
      * @{
@@ -351,8 +345,6 @@ struct AACContext {
     int dmono_mode;      ///< 0->not dmono, 1->use first channel, 2->use second channel
     /** @} */
 
-    DECLARE_ALIGNED(32, INTFLOAT, temp)[128];
-
     OutputConfiguration oc[2];
     int warned_num_aac_frames;
     int warned_960_sbr;
@@ -86,7 +86,7 @@ void ff_h264_idct8_add4_neon(uint8_t *dst, const int *block_offset,
 av_cold void ff_h264dsp_init_aarch64(H264DSPContext *c, const int bit_depth,
                                      const int chroma_format_idc)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("h264dsp");
 
     if (have_neon(cpu_flags) && bit_depth == 8) {
         c->h264_v_loop_filter_luma   = ff_h264_v_loop_filter_luma_neon;
@@ -323,15 +323,14 @@ static av_cold void exponent_init(AC3EncodeContext *s)
 
 
 /*
- * Extract exponents from the MDCT coefficients.
+ * Extract exponents from the MDCT coefficients for all blocks in 1 channel.
  */
-static void extract_exponents(AC3EncodeContext *s)
+static void extract_exponents_ch(AC3EncodeContext *s, int ch)
 {
-    int ch        = !s->cpl_on;
-    int chan_size = AC3_MAX_COEFS * s->num_blocks * (s->channels - ch + 1);
     AC3Block *block = &s->blocks[0];
 
-    s->ac3dsp.extract_exponents(block->exp[ch], block->fixed_coef[ch], chan_size);
+    s->ac3dsp.extract_exponents(block->exp[ch], block->fixed_coef[ch],
+                                AC3_MAX_COEFS * s->num_blocks);
 }
 
 
@@ -352,64 +351,57 @@ static const uint8_t exp_strategy_reuse_tab[4][6] = {
 };
 
 /*
- * Calculate exponent strategies for all channels.
+ * Calculate exponent strategies for 1 channel.
  * Array arrangement is reversed to simplify the per-channel calculation.
  */
-static void compute_exp_strategy(AC3EncodeContext *s)
+static void compute_exp_strategy_ch(AC3EncodeContext *s, int ch)
 {
-    int ch, blk, blk1;
-
-    for (ch = !s->cpl_on; ch <= s->fbw_channels; ch++) {
-        uint8_t *exp_strategy = s->exp_strategy[ch];
-        uint8_t *exp          = s->blocks[0].exp[ch];
-        int exp_diff;
-
-        /* estimate if the exponent variation & decide if they should be
-           reused in the next frame */
-        exp_strategy[0] = EXP_NEW;
-        exp += AC3_MAX_COEFS;
-        for (blk = 1; blk < s->num_blocks; blk++, exp += AC3_MAX_COEFS) {
-            if (ch == CPL_CH) {
-                if (!s->blocks[blk-1].cpl_in_use) {
-                    exp_strategy[blk] = EXP_NEW;
-                    continue;
-                } else if (!s->blocks[blk].cpl_in_use) {
-                    exp_strategy[blk] = EXP_REUSE;
-                    continue;
-                }
-            } else if (s->blocks[blk].channel_in_cpl[ch] != s->blocks[blk-1].channel_in_cpl[ch]) {
+    uint8_t *exp_strategy = s->exp_strategy[ch];
+    uint8_t *exp          = s->blocks[0].exp[ch];
+    int blk, blk1, exp_diff;
+
+    if (ch == s->lfe_channel) {
+        exp_strategy[0] = EXP_D15;
+        for (blk = 1; blk < s->num_blocks; blk++)
+            exp_strategy[blk] = EXP_REUSE;
+        return;
+    }
+
+    /* estimate if the exponent variation & decide if they should be
+       reused in the next frame */
+    exp_strategy[0] = EXP_NEW;
+    exp += AC3_MAX_COEFS;
+    for (blk = 1; blk < s->num_blocks; blk++, exp += AC3_MAX_COEFS) {
+        if (ch == CPL_CH) {
+            if (!s->blocks[blk-1].cpl_in_use) {
                 exp_strategy[blk] = EXP_NEW;
                 continue;
+            } else if (!s->blocks[blk].cpl_in_use) {
+                exp_strategy[blk] = EXP_REUSE;
+                continue;
             }
-            exp_diff = s->mecc.sad[0](NULL, exp, exp - AC3_MAX_COEFS, 16, 16);
-            exp_strategy[blk] = EXP_REUSE;
-            if (ch == CPL_CH && exp_diff > (EXP_DIFF_THRESHOLD * (s->blocks[blk].end_freq[ch] - s->start_freq[ch]) / AC3_MAX_COEFS))
-                exp_strategy[blk] = EXP_NEW;
-            else if (ch > CPL_CH && exp_diff > EXP_DIFF_THRESHOLD)
-                exp_strategy[blk] = EXP_NEW;
-        }
-
-        /* now select the encoding strategy type : if exponents are often
-           recoded, we use a coarse encoding */
-        blk = 0;
-        while (blk < s->num_blocks) {
-            blk1 = blk + 1;
-            while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE)
-                blk1++;
-            exp_strategy[blk] = exp_strategy_reuse_tab[s->num_blks_code][blk1-blk-1];
-            blk = blk1;
+        } else if (s->blocks[blk].channel_in_cpl[ch] != s->blocks[blk-1].channel_in_cpl[ch]) {
+            exp_strategy[blk] = EXP_NEW;
+            continue;
         }
-    }
-    if (s->lfe_on) {
-        ch = s->lfe_channel;
-        s->exp_strategy[ch][0] = EXP_D15;
-        for (blk = 1; blk < s->num_blocks; blk++)
-            s->exp_strategy[ch][blk] = EXP_REUSE;
+        exp_diff = s->mecc.sad[0](NULL, exp, exp - AC3_MAX_COEFS, 16, 16);
+        exp_strategy[blk] = EXP_REUSE;
+        if (ch == CPL_CH && exp_diff > (EXP_DIFF_THRESHOLD * (s->blocks[blk].end_freq[ch] - s->start_freq[ch]) / AC3_MAX_COEFS))
+            exp_strategy[blk] = EXP_NEW;
+        else if (ch > CPL_CH && exp_diff > EXP_DIFF_THRESHOLD)
+            exp_strategy[blk] = EXP_NEW;
     }
 
-    /* for E-AC-3, determine frame exponent strategy */
-    if (CONFIG_EAC3_ENCODER && s->eac3)
-        ff_eac3_get_frame_exp_strategy(s);
+    /* now select the encoding strategy type : if exponents are often
+       recoded, we use a coarse encoding */
+    blk = 0;
+    while (blk < s->num_blocks) {
+        blk1 = blk + 1;
+        while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE)
+            blk1++;
+        exp_strategy[blk] = exp_strategy_reuse_tab[s->num_blks_code][blk1-blk-1];
+        blk = blk1;
+    }
 }
 
 
@@ -494,50 +486,45 @@ static void encode_exponents_blk_ch(uint8_t *exp, int nb_exps, int exp_strategy,
  * deltas between adjacent exponent groups so that they can be differentially
  * encoded.
  */
-static void encode_exponents(AC3EncodeContext *s)
+static void encode_exponents_ch(AC3EncodeContext *s, int ch)
 {
-    int blk, blk1, ch, cpl;
+    int blk, blk1, cpl;
     uint8_t *exp, *exp_strategy;
     int nb_coefs, num_reuse_blocks;
 
-    for (ch = !s->cpl_on; ch <= s->channels; ch++) {
-        exp          = s->blocks[0].exp[ch] + s->start_freq[ch];
-        exp_strategy = s->exp_strategy[ch];
+    exp          = s->blocks[0].exp[ch] + s->start_freq[ch];
+    exp_strategy = s->exp_strategy[ch];
 
-        cpl = (ch == CPL_CH);
-        blk = 0;
-        while (blk < s->num_blocks) {
-            AC3Block *block = &s->blocks[blk];
-            if (cpl && !block->cpl_in_use) {
-                exp += AC3_MAX_COEFS;
-                blk++;
-                continue;
-            }
-            nb_coefs = block->end_freq[ch] - s->start_freq[ch];
-            blk1 = blk + 1;
-
-            /* count the number of EXP_REUSE blocks after the current block
-               and set exponent reference block numbers */
-            s->exp_ref_block[ch][blk] = blk;
-            while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE) {
-                s->exp_ref_block[ch][blk1] = blk;
-                blk1++;
-            }
-            num_reuse_blocks = blk1 - blk - 1;
+    cpl = (ch == CPL_CH);
+    blk = 0;
+    while (blk < s->num_blocks) {
+        AC3Block *block = &s->blocks[blk];
+        if (cpl && !block->cpl_in_use) {
+            exp += AC3_MAX_COEFS;
+            blk++;
+            continue;
+        }
+        nb_coefs = block->end_freq[ch] - s->start_freq[ch];
+        blk1 = blk + 1;
 
-            /* for the EXP_REUSE case we select the min of the exponents */
-            s->ac3dsp.ac3_exponent_min(exp-s->start_freq[ch], num_reuse_blocks,
-                                       AC3_MAX_COEFS);
+        /* count the number of EXP_REUSE blocks after the current block
+           and set exponent reference block numbers */
+        s->exp_ref_block[ch][blk] = blk;
+        while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE) {
+            s->exp_ref_block[ch][blk1] = blk;
+            blk1++;
+        }
+        num_reuse_blocks = blk1 - blk - 1;
 
-            encode_exponents_blk_ch(exp, nb_coefs, exp_strategy[blk], cpl);
+        /* for the EXP_REUSE case we select the min of the exponents */
+        s->ac3dsp.ac3_exponent_min(exp-s->start_freq[ch], num_reuse_blocks,
+                                   AC3_MAX_COEFS);
 
-            exp += AC3_MAX_COEFS * (num_reuse_blocks + 1);
-            blk = blk1;
-        }
-    }
+        encode_exponents_blk_ch(exp, nb_coefs, exp_strategy[blk], cpl);
 
-    /* reference block numbers have been changed, so reset ref_bap_set */
-    s->ref_bap_set = 0;
+        exp += AC3_MAX_COEFS * (num_reuse_blocks + 1);
+        blk = blk1;
+    }
 }
 
 
@@ -627,6 +614,27 @@ void ff_ac3_group_exponents(AC3EncodeContext *s)
 }
 
 
+/*
+ * Extract, choose a strategy for, and encode the exponents of 1 channel.
+ */
+static int process_exponents_thread(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
+{
+    AC3EncodeContext *s = avctx->priv_data;
+    int ch = !s->cpl_on + jobnr;
+
+    extract_exponents_ch(s, ch);
+
+    compute_exp_strategy_ch(s, ch);
+
+    encode_exponents_ch(s, ch);
+
+    emms_c();
+
+    return 0;
+}
+
+
 /**
  * Calculate final exponents from the supplied MDCT coefficients and exponent shift.
  * Extract exponents from MDCT coefficients, calculate exponent strategies,
@@ -636,13 +644,16 @@ void ff_ac3_group_exponents(AC3EncodeContext *s)
  */
 void ff_ac3_process_exponents(AC3EncodeContext *s)
 {
-    extract_exponents(s);
-
-    compute_exp_strategy(s);
+    /* channels are independent until the frame exponent strategy is chosen */
+    s->avctx->execute2(s->avctx, process_exponents_thread, NULL, NULL,
+                       s->channels + s->cpl_on);
 
-    encode_exponents(s);
+    /* for E-AC-3, determine frame exponent strategy */
+    if (CONFIG_EAC3_ENCODER && s->eac3)
+        ff_eac3_get_frame_exp_strategy(s);
 
-    emms_c();
+    /* reference block numbers have been changed, so reset ref_bap_set */
+    s->ref_bap_set = 0;
 }
 
 
@@ -935,32 +946,36 @@ static void count_frame_bits(AC3EncodeContext *s)
 
 
 /*
- * Calculate masking curve based on the final exponents.
+ * Calculate masking curve based on the final exponents for 1 channel.
  * Also calculate the power spectral densities to use in future calculations.
  */
-static void bit_alloc_masking(AC3EncodeContext *s)
+static int bit_alloc_masking_thread(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
 {
-    int blk, ch;
+    AC3EncodeContext *s = avctx->priv_data;
+    int blk, ch = !s->cpl_on + jobnr;
 
     for (blk = 0; blk < s->num_blocks; blk++) {
         AC3Block *block = &s->blocks[blk];
-        for (ch = !block->cpl_in_use; ch <= s->channels; ch++) {
-            /* We only need psd and mask for calculating bap.
-               Since we currently do not calculate bap when exponent
-               strategy is EXP_REUSE we do not need to calculate psd or mask. */
-            if (s->exp_strategy[ch][blk] != EXP_REUSE) {
-                ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
-                                          block->end_freq[ch], block->psd[ch],
-                                          block->band_psd[ch]);
-                ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
-                                           s->start_freq[ch], block->end_freq[ch],
-                                           ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
-                                           ch == s->lfe_channel,
-                                           DBA_NONE, 0, NULL, NULL, NULL,
-                                           block->mask[ch]);
-            }
+        if (ch == CPL_CH && !block->cpl_in_use)
+            continue;
+        /* We only need psd and mask for calculating bap.
+           Since we currently do not calculate bap when exponent
+           strategy is EXP_REUSE we do not need to calculate psd or mask. */
+        if (s->exp_strategy[ch][blk] != EXP_REUSE) {
+            ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
+                                      block->end_freq[ch], block->psd[ch],
+                                      block->band_psd[ch]);
+            ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
+                                       s->start_freq[ch], block->end_freq[ch],
+                                       ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
+                                       ch == s->lfe_channel,
+                                       DBA_NONE, 0, NULL, NULL, NULL,
+                                       block->mask[ch]);
         }
     }
+
+    return 0;
 }
 
 
@@ -987,65 +1002,70 @@ static void reset_block_bap(AC3EncodeContext *s)
 
 
 /**
- * Initialize mantissa counts.
- * These are set so that they are padded to the next whole group size when bits
- * are counted in compute_mantissa_size.
- *
- * @param[in,out] mant_cnt  running counts for each bap value for each block
- */
-static void count_mantissa_bits_init(uint16_t mant_cnt[AC3_MAX_BLOCKS][16])
-{
-    int blk;
-
-    for (blk = 0; blk < AC3_MAX_BLOCKS; blk++) {
-        memset(mant_cnt[blk], 0, sizeof(mant_cnt[blk]));
-        mant_cnt[blk][1] = mant_cnt[blk][2] = 2;
-        mant_cnt[blk][4] = 1;
-    }
-}
-
-
-/**
- * Update mantissa bit counts for all blocks in 1 channel in a given bandwidth
- * range.
- *
- * @param s                 AC-3 encoder private context
- * @param ch                channel index
- * @param[in,out] mant_cnt  running counts for each bap value for each block
- * @param start             starting coefficient bin
- * @param end               ending coefficient bin
+ * Run the bit allocation for 1 channel with a given SNR offset and count the
+ * mantissas for each bap value in each block.
+ * Blocks which reuse exponents also reuse the bap values of their reference
+ * block, so their counts are copied instead of being recounted when the
+ * bandwidth is the same.
  */
-static void count_mantissa_bits_update_ch(AC3EncodeContext *s, int ch,
-                                          uint16_t mant_cnt[AC3_MAX_BLOCKS][16],
-                                          int start, int end)
+static void bit_alloc_ch(AC3EncodeContext *s, int ch, int snr_offset)
 {
-    int blk;
+    int max_end_freq = s->bandwidth_code * 3 + 73;
+    uint16_t (*mant_cnt)[16] = s->mant_cnt[ch];
+    int blk, end, ref_end = -1;
 
     for (blk = 0; blk < s->num_blocks; blk++) {
         AC3Block *block = &s->blocks[blk];
-        if (ch == CPL_CH && !block->cpl_in_use)
+
+        memset(mant_cnt[blk], 0, sizeof(mant_cnt[blk]));
+        if (ch == CPL_CH && !block->cpl_in_use) {
+            ref_end = -1;
+            continue;
+        }
+        end = FFMIN(max_end_freq, block->end_freq[ch]);
+
+        /* Currently the only bit allocation parameters which vary across
+           blocks within a frame are the exponent values.  We can take
+           advantage of that by reusing the bit allocation pointers
+           whenever we reuse exponents. */
+        if (s->exp_strategy[ch][blk] != EXP_REUSE) {
+            s->ac3dsp.bit_alloc_calc_bap(block->mask[ch], block->psd[ch],
+                                         s->start_freq[ch], block->end_freq[ch],
+                                         snr_offset, s->bit_alloc.floor,
+                                         ff_ac3_bap_tab, s->ref_bap[ch][blk]);
+        } else if (end == ref_end) {
+            memcpy(mant_cnt[blk], mant_cnt[blk-1], sizeof(mant_cnt[blk]));
             continue;
+        }
         s->ac3dsp.update_bap_counts(mant_cnt[blk],
-                                    s->ref_bap[ch][blk] + start,
-                                    FFMIN(end, block->end_freq[ch]) - start);
+                                    s->ref_bap[ch][blk] + s->start_freq[ch],
+                                    end - s->start_freq[ch]);
+        ref_end = end;
     }
 }
 
 
 /*
- * Count the number of mantissa bits in the frame based on the bap values.
+ * Count the number of mantissa bits in the frame based on the per-channel
+ * mantissa counts.
+ * The counts are initialized so that they are padded to the next whole group
+ * size when bits are counted in compute_mantissa_size.
  */
 static int count_mantissa_bits(AC3EncodeContext *s)
 {
-    int ch, max_end_freq;
+    int blk, ch, i;
     LOCAL_ALIGNED_16(uint16_t, mant_cnt, [AC3_MAX_BLOCKS], [16]);
 
-    count_mantissa_bits_init(mant_cnt);
+    for (blk = 0; blk < AC3_MAX_BLOCKS; blk++) {
+        memset(mant_cnt[blk], 0, sizeof(mant_cnt[blk]));
+        mant_cnt[blk][1] = mant_cnt[blk][2] = 2;
+        mant_cnt[blk][4] = 1;
+    }
 
-    max_end_freq = s->bandwidth_code * 3 + 73;
     for (ch = !s->cpl_enabled; ch <= s->channels; ch++)
-        count_mantissa_bits_update_ch(s, ch, mant_cnt, s->start_freq[ch],
-                                      max_end_freq);
+        for (blk = 0; blk < s->num_blocks; blk++)
+            for (i = 0; i < 16; i++)
+                mant_cnt[blk][i] += s->mant_cnt[ch][blk][i];
 
     return s->ac3dsp.compute_mantissa_size(mant_cnt);
 }
@@ -1063,27 +1083,17 @@ static int count_mantissa_bits(AC3EncodeContext *s)
  */
 static int bit_alloc(AC3EncodeContext *s, int snr_offset)
 {
-    int blk, ch;
+    int ch;
 
     snr_offset = (snr_offset - 240) << 2;
 
+    /* The SNR offset is shared by all channels and each search step needs the
+       total over all of them, so this runs on the calling thread instead of
+       handing a few hundred bins per channel to the worker threads. */
     reset_block_bap(s);
-    for (blk = 0; blk < s->num_blocks; blk++) {
-        AC3Block *block = &s->blocks[blk];
+    for (ch = !s->cpl_enabled; ch <= s->channels; ch++)
+        bit_alloc_ch(s, ch, snr_offset);
 
-        for (ch = !block->cpl_in_use; ch <= s->channels; ch++) {
-            /* Currently the only bit allocation parameters which vary across
-               blocks within a frame are the exponent values.  We can take
-               advantage of that by reusing the bit allocation pointers
-               whenever we reuse exponents. */
-            if (s->exp_strategy[ch][blk] != EXP_REUSE) {
-                s->ac3dsp.bit_alloc_calc_bap(block->mask[ch], block->psd[ch],
-                                             s->start_freq[ch], block->end_freq[ch],
-                                             snr_offset, s->bit_alloc.floor,
-                                             ff_ac3_bap_tab, s->ref_bap[ch][blk]);
-            }
-        }
-    }
     return count_mantissa_bits(s);
 }
 
@@ -1149,7 +1159,8 @@ int ff_ac3_compute_bit_allocation(AC3EncodeContext *s)
 
     s->exponent_bits = count_exponent_bits(s);
 
-    bit_alloc_masking(s);
+    s->avctx->execute2(s->avctx, bit_alloc_masking_thread, NULL, NULL,
+                       s->channels + s->cpl_on);
 
     return cbr_bit_allocation(s);
 }
@@ -1292,6 +1303,37 @@ static void quantize_mantissas_blk_ch(AC3Mant *s, int32_t *fixed_coef,
 }
 
 
+/*
+ * Quantize mantissas for all channels in 1 block.
+ * Mantissa grouping does not cross block boundaries, so blocks are independent.
+ */
+static int quantize_mantissas_thread(AVCodecContext *avctx, void *arg,
+                                     int blk, int threadnr)
+{
+    AC3EncodeContext *s = avctx->priv_data;
+    AC3Block *block = &s->blocks[blk];
+    AC3Mant m = { 0 };
+    int ch, ch0 = 0, got_cpl;
+
+    got_cpl = !block->cpl_in_use;
+    for (ch = 1; ch <= s->channels; ch++) {
+        if (!got_cpl && ch > 1 && block->channel_in_cpl[ch-1]) {
+            ch0     = ch - 1;
+            ch      = CPL_CH;
+            got_cpl = 1;
+        }
+        quantize_mantissas_blk_ch(&m, block->fixed_coef[ch],
+                                  s->blocks[s->exp_ref_block[ch][blk]].exp[ch],
+                                  s->ref_bap[ch][blk], block->qmant[ch],
+                                  s->start_freq[ch], block->end_freq[ch]);
+        if (ch == CPL_CH)
+            ch = ch0;
+    }
+
+    return 0;
+}
+
+
 /**
  * Quantize mantissas using coefficients, exponents, and bit allocation pointers.
  *
@@ -1299,27 +1341,8 @@ static void quantize_mantissas_blk_ch(AC3Mant *s, int32_t *fixed_coef,
  */
 void ff_ac3_quantize_mantissas(AC3EncodeContext *s)
 {
-    int blk, ch, ch0=0, got_cpl;
-
-    for (blk = 0; blk < s->num_blocks; blk++) {
-        AC3Block *block = &s->blocks[blk];
-        AC3Mant m = { 0 };
-
-        got_cpl = !block->cpl_in_use;
-        for (ch = 1; ch <= s->channels; ch++) {
-            if (!got_cpl && ch > 1 && block->channel_in_cpl[ch-1]) {
-                ch0     = ch - 1;
-                ch      = CPL_CH;
-                got_cpl = 1;
-            }
-            quantize_mantissas_blk_ch(&m, block->fixed_coef[ch],
-                                      s->blocks[s->exp_ref_block[ch][blk]].exp[ch],
-                                      s->ref_bap[ch][blk], block->qmant[ch],
-                                      s->start_freq[ch], block->end_freq[ch]);
-            if (ch == CPL_CH)
-                ch = ch0;
-        }
-    }
+    s->avctx->execute2(s->avctx, quantize_mantissas_thread, NULL, NULL,
+                       s->num_blocks);
 }
 
 
@@ -2474,6 +2497,9 @@ av_cold int ff_ac3_encode_init(AVCodecContext *avctx)
 
     bit_alloc_init(s);
 
+    s->nb_threads = avctx->active_thread_type & FF_THREAD_SLICE ?
+                    FFMAX(avctx->thread_count, 1) : 1;
+
     ret = s->mdct_init(s);
     if (ret)
         goto init_fail;
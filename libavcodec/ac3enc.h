@@ -233,7 +233,8 @@ typedef struct AC3EncodeContext {
     int frame_bits;                         ///< all frame bits except exponents and mantissas
     int exponent_bits;                      ///< number of bits used for exponents
 
-    SampleType *windowed_samples;
+    int nb_threads;                         ///< number of slice threads
+    SampleType *windowed_samples;           ///< windowing buffer for each slice thread
     SampleType **planar_samples;
     uint8_t *bap_buffer;
     uint8_t *bap1_buffer;
@@ -254,6 +255,7 @@ typedef struct AC3EncodeContext {
     uint8_t exp_ref_block[AC3_MAX_CHANNELS][AC3_MAX_BLOCKS]; ///< reference blocks for EXP_REUSE
     uint8_t *ref_bap     [AC3_MAX_CHANNELS][AC3_MAX_BLOCKS]; ///< bit allocation pointers (bap)
     int ref_bap_set;                                         ///< indicates if ref_bap pointers have been set
+    uint16_t mant_cnt[AC3_MAX_CHANNELS][AC3_MAX_BLOCKS][16]; ///< per-channel mantissa counts for each bap value
 
     /* fixed vs. float function pointers */
     void (*mdct_end)(struct AC3EncodeContext *s);
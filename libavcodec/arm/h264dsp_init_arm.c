@@ -105,7 +105,7 @@ static av_cold void h264dsp_init_neon(H264DSPContext *c, const int bit_depth,
 av_cold void ff_h264dsp_init_arm(H264DSPContext *c, const int bit_depth,
                                  const int chroma_format_idc)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("h264dsp");
 
 #if HAVE_ARMV6
     if (have_setend(cpu_flags))
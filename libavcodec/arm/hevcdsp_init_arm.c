@@ -27,7 +27,7 @@
 
 av_cold void ff_hevc_dsp_init_arm(HEVCDSPContext *c, const int bit_depth)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("hevcdsp");
 
     if (have_neon(cpu_flags))
         ff_hevc_dsp_init_neon(c, bit_depth);
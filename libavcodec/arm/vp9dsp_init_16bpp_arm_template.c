@@ -99,7 +99,7 @@ define_8tap_2d_funcs(4,  BPP)
 
 static av_cold void vp9dsp_mc_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
 #define init_fpel(idx1, idx2, sz, type, suffix)      \
@@ -163,7 +163,7 @@ define_itxfm(iwht, iwht, 4,  BPP);
 
 static av_cold void vp9dsp_itxfm_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
 #define init_itxfm2(tx, sz, bpp)                                               \
@@ -208,7 +208,7 @@ define_loop_filters(88, 16, BPP);
 
 static av_cold void vp9dsp_loopfilter_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
 #define init_lpf_func_8(idx1, idx2, dir, wd, bpp) \
@@ -98,7 +98,7 @@ define_8tap_2d_funcs(4)
 
 static av_cold void vp9dsp_mc_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
 #define init_fpel(idx1, idx2, sz, type)              \
@@ -161,7 +161,7 @@ define_itxfm(iwht, iwht, 4);
 
 static av_cold void vp9dsp_itxfm_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
 #define init_itxfm(tx, sz)                                             \
@@ -217,7 +217,7 @@ lf_mix_fns(8, 8)
 
 static av_cold void vp9dsp_loopfilter_init_arm(VP9DSPContext *dsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (have_neon(cpu_flags)) {
         dsp->loop_filter_8[0][1] = ff_vp9_loop_filter_v_4_8_neon;
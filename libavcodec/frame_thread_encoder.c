@@ -29,6 +29,7 @@
 #include "libavutil/thread.h"
 #include "avcodec.h"
 #include "internal.h"
+#include "mpegvideo.h"
 #include "thread.h"
 
 #define MAX_THREADS 64
@@ -39,6 +40,13 @@ typedef struct{
     void *outdata;
     int64_t return_code;
     unsigned index;
+    int frame_number;
+    int64_t prev_pts;
+
+    /* a whole GOP, coded by one instance into nb_frames consecutive slots */
+    AVFrame **frames;
+    AVPacket **pkts;
+    int nb_frames;
 } Task;
 
 typedef struct{
@@ -49,17 +57,101 @@ typedef struct{
     pthread_mutex_t task_fifo_mutex;
     pthread_cond_t task_fifo_cond;
 
-    Task finished_tasks[BUFFER_SIZE];
+    Task *finished_tasks;
+    unsigned buffer_size;
     pthread_mutex_t finished_task_mutex;
     pthread_cond_t finished_task_cond;
 
     unsigned task_index;
     unsigned finished_task_index;
+    int frame_number;
+
+    int64_t prev_pts;
+    AVFrame *first_frame;   ///< held until the next one gives the frame distance
+
+    int gop_size;           ///< frames per task, 0 for one task per frame
+    AVFrame **gop;
+    int nb_gop_frames;
 
     pthread_t worker[MAX_THREADS];
     atomic_int exit;
 } ThreadContext;
 
+static void finish_task(ThreadContext *c, unsigned index, AVPacket *pkt, int ret)
+{
+    pthread_mutex_lock(&c->finished_task_mutex);
+    c->finished_tasks[index].outdata = pkt;
+    c->finished_tasks[index].return_code = ret;
+    pthread_cond_signal(&c->finished_task_cond);
+    pthread_mutex_unlock(&c->finished_task_mutex);
+}
+
+static void free_gop_task(Task *task)
+{
+    int i;
+
+    for (i = 0; i < task->nb_frames; i++) {
+        av_frame_free(&task->frames[i]);
+        av_packet_free(&task->pkts[i]);
+    }
+    av_freep(&task->frames);
+    av_freep(&task->pkts);
+}
+
+/**
+ * Code a closed GOP from its first frame on and drain the encoder at its
+ * end, so the next GOP given to this instance starts from scratch. The
+ * packets go out in coding order; slots of skipped frames stay empty.
+ */
+static void encode_gop(AVCodecContext *avctx, ThreadContext *c, Task *task)
+{
+    int i, nb_packets = 0, ret = 0;
+
+    avctx->internal->frame_thread_prev_pts = task->prev_pts;
+
+    for (i = 0; i <= task->nb_frames && ret >= 0; i++) {
+        AVFrame *frame = i < task->nb_frames ? task->frames[i] : NULL;
+        int got_packet;
+
+        do {
+            AVPacket *pkt;
+
+            if (nb_packets == task->nb_frames)
+                break;
+            pkt = task->pkts[nb_packets];
+
+            avctx->frame_number = task->frame_number + i;
+            ret = avcodec_encode_video2(avctx, pkt, frame, &got_packet);
+            if (ret >= 0 && got_packet)
+                ret = av_packet_make_refcounted(pkt);
+            if (ret < 0)
+                break;
+            if (got_packet) {
+                task->pkts[nb_packets] = NULL;
+                finish_task(c, (task->index + nb_packets++) % c->buffer_size, pkt, 0);
+            }
+        } while (!frame && got_packet);
+
+        if (frame) {
+            pthread_mutex_lock(&c->buffer_mutex);
+            av_frame_unref(frame);
+            pthread_mutex_unlock(&c->buffer_mutex);
+        }
+    }
+
+    for (; nb_packets < task->nb_frames; nb_packets++) {
+        AVPacket *pkt = task->pkts[nb_packets];
+
+        av_packet_unref(pkt);
+        task->pkts[nb_packets] = NULL;
+        finish_task(c, (task->index + nb_packets) % c->buffer_size, pkt, ret);
+    }
+
+    pthread_mutex_lock(&c->buffer_mutex);
+    free_gop_task(task);
+    pthread_mutex_unlock(&c->buffer_mutex);
+}
+
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
@@ -84,8 +176,16 @@ static void * attribute_align_arg worker(void *v){
         }
         av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
         pthread_mutex_unlock(&c->task_fifo_mutex);
+
+        if (task.frames) {
+            encode_gop(avctx, c, &task);
+            continue;
+        }
         frame = task.indata;
 
+        /* every worker sees only some of the frames, tell it where it is */
+        avctx->frame_number = task.frame_number;
+        avctx->internal->frame_thread_prev_pts = task.prev_pts;
         ret = avcodec_encode_video2(avctx, pkt, frame, &got_packet);
         pthread_mutex_lock(&c->buffer_mutex);
         av_frame_unref(frame);
@@ -99,11 +199,8 @@ static void * attribute_align_arg worker(void *v){
             pkt->data = NULL;
             pkt->size = 0;
         }
-        pthread_mutex_lock(&c->finished_task_mutex);
-        c->finished_tasks[task.index].outdata = pkt; pkt = NULL;
-        c->finished_tasks[task.index].return_code = ret;
-        pthread_cond_signal(&c->finished_task_cond);
-        pthread_mutex_unlock(&c->finished_task_mutex);
+        finish_task(c, task.index, pkt, ret);
+        pkt = NULL;
     }
 end:
     av_free(pkt);
@@ -116,13 +213,49 @@ end:
 
 int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     int i=0;
+    int gop_size = 0;
     ThreadContext *c;
 
 
-    if(   !(avctx->thread_type & FF_THREAD_FRAME)
-       || !(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY))
+    if(!(avctx->thread_type & FF_THREAD_FRAME))
         return 0;
 
+    if(!(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY)) {
+        /* Encoders which can also code intra-only streams (the mpegvideo
+         * based ones with gop_size <= 1) get one instance per frame as well.
+         * With closed GOPs of a fixed length (+cgop and +strict_gop) each
+         * instance codes whole GOPs instead, P and B frames included.
+         * Two pass stats would get interleaved between the instances, and an
+         * automatic thread count leaves rate controlled encodes to slice
+         * threading, where the rate control sees every frame. */
+        int64_t mpv_flags = 0;
+
+        if(   !(avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+           || avctx->flags & (AV_CODEC_FLAG_PASS1 | AV_CODEC_FLAG_PASS2)
+           || (!avctx->thread_count && !(avctx->flags & AV_CODEC_FLAG_QSCALE)))
+            return 0;
+        if (avctx->gop_size > 1) {
+            if (avctx->codec->priv_class)
+                av_opt_get_int(avctx->priv_data, "mpv_flags", 0, &mpv_flags);
+            if(   !(avctx->flags & AV_CODEC_FLAG_CLOSED_GOP)
+               || !(mpv_flags & FF_MPV_FLAG_STRICT_GOP))
+                return 0;
+            gop_size = avctx->gop_size;
+        }
+        if(avctx->thread_count > 1 && !(avctx->flags & AV_CODEC_FLAG_QSCALE))
+            av_log(avctx, AV_LOG_WARNING,
+                   "Rate control works badly with frame multi-threading, consider "
+                   "using -thread_type slice or a constant quantizer.\n");
+    }
+
+    if (avctx->codec_id == AV_CODEC_ID_PRORES) {
+        AVDictionaryEntry *rc = av_dict_get(options, "rc", NULL, AV_DICT_MATCH_CASE);
+
+        // the frame level rate control of prores_ks has to see every frame
+        if (rc && rc->value && (!strcmp(rc->value, "frame") || atoi(rc->value) == 1))
+            return 0;
+    }
+
     if(   !avctx->thread_count
        && avctx->codec_id == AV_CODEC_ID_MJPEG
        && !(avctx->flags & AV_CODEC_FLAG_QSCALE)) {
@@ -179,9 +312,20 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
         return AVERROR(ENOMEM);
 
     c->parent_avctx = avctx;
+    c->gop_size = gop_size;
+    c->prev_pts = AV_NOPTS_VALUE;
 
+    /* room for a GOP per thread, the one being collected and the one
+     * being returned */
+    if (gop_size) {
+        if (gop_size > (INT_MAX / sizeof(Task)) / (avctx->thread_count + 1))
+            goto fail;
+        c->buffer_size = (avctx->thread_count + 1) * gop_size;
+    } else
+        c->buffer_size = BUFFER_SIZE;
+    c->finished_tasks = av_mallocz_array(c->buffer_size, sizeof(Task));
     c->task_fifo = av_fifo_alloc_array(BUFFER_SIZE, sizeof(Task));
-    if(!c->task_fifo)
+    if(!c->finished_tasks || !c->task_fifo)
         goto fail;
 
     pthread_mutex_init(&c->task_fifo_mutex, NULL);
@@ -255,12 +399,19 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
         Task task;
         AVFrame *frame;
         av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
+        if (task.frames)
+            free_gop_task(&task);
         frame = task.indata;
         av_frame_free(&frame);
         task.indata = NULL;
     }
 
-    for (i=0; i<BUFFER_SIZE; i++) {
+    av_frame_free(&c->first_frame);
+    for (i = 0; i < c->nb_gop_frames; i++)
+        av_frame_free(&c->gop[i]);
+    av_freep(&c->gop);
+
+    for (i = 0; c->finished_tasks && i < c->buffer_size; i++) {
         if (c->finished_tasks[i].outdata != NULL) {
             AVPacket *pkt = c->finished_tasks[i].outdata;
             av_packet_free(&pkt);
@@ -274,11 +425,82 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
     pthread_cond_destroy(&c->task_fifo_cond);
     pthread_cond_destroy(&c->finished_task_cond);
     av_fifo_freep(&c->task_fifo);
+    av_freep(&c->finished_tasks);
     av_freep(&avctx->internal->frame_thread_encoder);
 }
 
+static void submit_frame(ThreadContext *c, AVFrame *frame, unsigned index,
+                         int frame_number, int64_t prev_pts)
+{
+    Task task = { 0 };
+
+    task.index        = index;
+    task.frame_number = frame_number;
+    task.prev_pts     = prev_pts;
+    task.indata       = frame;
+
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
+    pthread_cond_signal(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+}
+
+/**
+ * Hand out the first frame, whose dts lies one frame distance before its
+ * pts, as with an encoder which sees every frame.
+ */
+static void submit_first_frame(ThreadContext *c, int64_t next_pts)
+{
+    int64_t pts = c->first_frame->pts;
+    int64_t prev_pts = pts;
+
+    if (pts != AV_NOPTS_VALUE && next_pts != AV_NOPTS_VALUE)
+        prev_pts = pts - (next_pts - pts);
+    submit_frame(c, c->first_frame, 0, 0, prev_pts);
+    c->first_frame = NULL;
+}
+
+static int submit_gop(ThreadContext *c)
+{
+    Task task = { 0 };
+    int i;
+
+    task.pkts = av_mallocz_array(c->gop_size, sizeof(*task.pkts));
+    if (!task.pkts)
+        return AVERROR(ENOMEM);
+    task.nb_frames = c->nb_gop_frames;
+    for (i = 0; i < task.nb_frames; i++) {
+        task.pkts[i] = av_packet_alloc();
+        if (!task.pkts[i]) {
+            while (i--)
+                av_packet_free(&task.pkts[i]);
+            av_freep(&task.pkts);
+            return AVERROR(ENOMEM);
+        }
+    }
+    task.frames       = c->gop;
+    task.index        = (c->task_index + c->buffer_size - task.nb_frames) % c->buffer_size;
+    task.frame_number = c->frame_number - task.nb_frames;
+    task.prev_pts     = c->prev_pts;
+
+    c->prev_pts      = c->gop[task.nb_frames - 1]->pts;
+    c->gop           = NULL;
+    c->nb_gop_frames = 0;
+
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
+    pthread_cond_signal(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+
+    return 0;
+}
+
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet_ptr){
     ThreadContext *c = avctx->internal->frame_thread_encoder;
+    /* tasks which may be in flight before waiting for the oldest one; a
+     * GOP is only handed out once all of its frames are there */
+    unsigned max_pending = c->gop_size ? avctx->thread_count * c->gop_size
+                                       : avctx->thread_count;
     Task task;
     int ret;
 
@@ -294,33 +516,61 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
             return ret;
         }
 
-        task.index = c->task_index;
-        task.indata = (void*)new;
-        pthread_mutex_lock(&c->task_fifo_mutex);
-        av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
-        pthread_cond_signal(&c->task_fifo_cond);
-        pthread_mutex_unlock(&c->task_fifo_mutex);
-
-        c->task_index = (c->task_index+1) % BUFFER_SIZE;
+        if (c->gop_size) {
+            if (!c->gop) {
+                c->gop = av_malloc_array(c->gop_size, sizeof(*c->gop));
+                if (!c->gop) {
+                    av_frame_free(&new);
+                    return AVERROR(ENOMEM);
+                }
+            }
+            c->gop[c->nb_gop_frames++] = new;
+            c->frame_number++;
+            c->task_index = (c->task_index+1) % c->buffer_size;
+            if (c->nb_gop_frames == c->gop_size) {
+                ret = submit_gop(c);
+                if (ret < 0)
+                    return ret;
+            }
+        } else {
+            if (c->first_frame)
+                submit_first_frame(c, new->pts);
+            if (!c->frame_number)
+                c->first_frame = new;
+            else
+                submit_frame(c, new, c->task_index, c->frame_number, c->prev_pts);
+            c->prev_pts = new->pts;
+            c->frame_number++;
+            c->task_index = (c->task_index+1) % c->buffer_size;
+        }
+    } else if (c->first_frame) {
+        submit_first_frame(c, AV_NOPTS_VALUE);
+    } else if (c->nb_gop_frames) {
+        ret = submit_gop(c);
+        if (ret < 0)
+            return ret;
     }
 
     pthread_mutex_lock(&c->finished_task_mutex);
-    if (c->task_index == c->finished_task_index ||
-        (frame && !c->finished_tasks[c->finished_task_index].outdata &&
-         (c->task_index - c->finished_task_index) % BUFFER_SIZE <= avctx->thread_count)) {
-            pthread_mutex_unlock(&c->finished_task_mutex);
-            return 0;
-        }
+    do {
+        if (c->task_index == c->finished_task_index ||
+            (frame && !c->finished_tasks[c->finished_task_index].outdata &&
+             (c->task_index + c->buffer_size - c->finished_task_index) % c->buffer_size <= max_pending)) {
+                pthread_mutex_unlock(&c->finished_task_mutex);
+                return 0;
+            }
 
-    while (!c->finished_tasks[c->finished_task_index].outdata) {
-        pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
-    }
-    task = c->finished_tasks[c->finished_task_index];
-    *pkt = *(AVPacket*)(task.outdata);
-    if(pkt->data)
-        *got_packet_ptr = 1;
-    av_freep(&c->finished_tasks[c->finished_task_index].outdata);
-    c->finished_task_index = (c->finished_task_index+1) % BUFFER_SIZE;
+        while (!c->finished_tasks[c->finished_task_index].outdata) {
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        }
+        task = c->finished_tasks[c->finished_task_index];
+        *pkt = *(AVPacket*)(task.outdata);
+        if(pkt->data)
+            *got_packet_ptr = 1;
+        av_freep(&c->finished_tasks[c->finished_task_index].outdata);
+        c->finished_task_index = (c->finished_task_index+1) % c->buffer_size;
+        /* a skipped frame of a GOP must not end the draining */
+    } while (!frame && c->gop_size && !*got_packet_ptr && task.return_code >= 0);
     pthread_mutex_unlock(&c->finished_task_mutex);
 
     return task.return_code;
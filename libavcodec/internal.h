@@ -179,6 +179,13 @@ typedef struct AVCodecInternal {
 
     void *frame_thread_encoder;
 
+    /**
+     * Set by the frame thread encoder on its instances: pts of the frame
+     * before the current picture or GOP, i.e. its dts with one frame of
+     * delay. For the first frame it lies one frame distance before the pts.
+     */
+    int64_t frame_thread_prev_pts;
+
     /**
      * Number of audio samples to skip at the start of the next decoded frame
      */
@@ -102,6 +102,13 @@ typedef struct {
    Jpeg2000Component *comp;
 } Jpeg2000Tile;
 
+/** a row of code-blocks of one band, the unit of work of the tier-1 stage */
+typedef struct {
+    uint16_t tileno, compno;
+    uint8_t reslevelno, bandno;
+    int cblky;
+} Jpeg2000CblkRow;
+
 typedef struct {
     AVClass *class;
     AVCodecContext *avctx;
@@ -127,6 +134,9 @@ typedef struct {
 
     Jpeg2000Tile *tile;
 
+    Jpeg2000CblkRow *cblk_rows;
+    int nb_cblk_rows;
+
     int format;
     int pred;
 } Jpeg2000EncoderContext;
@@ -205,23 +215,38 @@ static void dump(Jpeg2000EncoderContext *s, FILE *fd)
 /* bitstream routines */
 
 /** put n times val bit */
-static void put_bits(Jpeg2000EncoderContext *s, int val, int n) // TODO: optimize
+static void put_bits(Jpeg2000EncoderContext *s, int val, int n)
 {
-    while (n-- > 0){
+    while (n > 0){
+        int k;
         if (s->bit_index == 8)
         {
             s->bit_index = *s->buf == 0xff;
             *(++s->buf) = 0;
         }
-        *s->buf |= val << (7 - s->bit_index++);
+        k = FFMIN(n, 8 - s->bit_index);
+        if (val)
+            *s->buf |= ((1 << k) - 1) << (8 - s->bit_index - k);
+        s->bit_index += k;
+        n -= k;
     }
 }
 
 /** put n least significant bits of a number num */
 static void put_num(Jpeg2000EncoderContext *s, int num, int n)
 {
-    while(--n >= 0)
-        put_bits(s, (num >> n) & 1, 1);
+    while (n > 0){
+        int k;
+        if (s->bit_index == 8)
+        {
+            s->bit_index = *s->buf == 0xff;
+            *(++s->buf) = 0;
+        }
+        k = FFMIN(n, 8 - s->bit_index);
+        n -= k;
+        *s->buf |= ((num >> n) & ((1 << k) - 1)) << (8 - s->bit_index - k);
+        s->bit_index += k;
+    }
 }
 
 /** flush the bitstream */
@@ -880,84 +905,159 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+static int dwt_thread(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
-    Jpeg2000T1Context t1;
-    Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000Component *comp = s->tile[jobnr / s->ncomponents].comp + jobnr % s->ncomponents;
 
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
+    return ff_dwt_encode(&comp->dwt, comp->i_data);
+}
 
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+static int encode_cblk_row(Jpeg2000EncoderContext *s, Jpeg2000T1Context *t1, Jpeg2000CblkRow *row)
+{
+    Jpeg2000CodingStyle *codsty = &s->codsty;
+    Jpeg2000Tile *tile = s->tile + row->tileno;
+    Jpeg2000Component *comp = tile->comp + row->compno;
+    int reslevelno = row->reslevelno, bandno = row->bandno, cblky = row->cblky;
+    Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    Jpeg2000Band *band = reslevel->band + bandno;
+    Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+    int cblkx, cblkno, xx0, x0, xx1, y0, yy0, yy1, bandpos, first;
+
+    y0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+    first = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                  band->coord[1][1]) - band->coord[1][0];
+    yy0 = cblky ? first + (cblky - 1 << band->log2_cblk_height) + y0 : y0;
+    yy1 = FFMIN(first + (cblky << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0]) + y0;
+
+    bandpos = bandno + (reslevelno > 0);
+
+    if (reslevelno == 0 || bandno == 1)
+        xx0 = 0;
+    else
+        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+    x0 = xx0;
+    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                band->coord[0][1]) - band->coord[0][0] + xx0;
+
+    for (cblkx = 0, cblkno = cblky * prec->nb_codeblocks_width; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
+        int y, x;
+        if (codsty->transform == FF_DWT53){
+            for (y = yy0; y < yy1; y++){
+                int *ptr = t1->data + (y-yy0)*t1->stride;
+                for (x = xx0; x < xx1; x++){
+                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] << NMSEDEC_FRACBITS;
+                }
+            }
+        } else{
+            for (y = yy0; y < yy1; y++){
+                int *ptr = t1->data + (y-yy0)*t1->stride;
+                for (x = xx0; x < xx1; x++){
+                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
+                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                    ptr++;
+                }
+            }
+        }
+        if (!prec->cblk[cblkno].data)
+            prec->cblk[cblkno].data = av_malloc(1 + 8192);
+        if (!prec->cblk[cblkno].passes)
+            prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
+        if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
+            return AVERROR(ENOMEM);
+        encode_cblk(s, t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
+                    bandpos, codsty->nreslevels - reslevelno - 1);
+        xx0 = xx1;
+        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
+    }
+    return 0;
+}
 
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+static int tier1_thread(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000T1Context t1;
 
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
+    t1.stride = (1<<s->codsty.log2_cblk_width) + 2;
 
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
+    return encode_cblk_row(s, &t1, s->cblk_rows + jobnr);
+}
 
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
-
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] << NMSEDEC_FRACBITS;
-                                }
-                            }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
+/**
+ * list the rows of code-blocks of all tiles, so that the tier-1 coding
+ * of the whole frame can be split among the slice threads
+ */
+static int init_cblk_rows(Jpeg2000EncoderContext *s)
+{
+    int pass, tileno, compno, reslevelno, bandno, cblky;
+
+    for (pass = 0; pass < 2; pass++) {
+        s->nb_cblk_rows = 0;
+        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++)
+            for (compno = 0; compno < s->ncomponents; compno++) {
+                Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+                for (reslevelno = 0; reslevelno < s->codsty.nreslevels; reslevelno++) {
+                    Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+                    for (bandno = 0; bandno < reslevel->nbands; bandno++) {
+                        Jpeg2000Band *band = reslevel->band + bandno;
+
+                        if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                            continue;
+
+                        for (cblky = 0; cblky < band->prec->nb_codeblocks_height; cblky++, s->nb_cblk_rows++) {
+                            if (pass) {
+                                Jpeg2000CblkRow *row = s->cblk_rows + s->nb_cblk_rows;
+                                row->tileno     = tileno;
+                                row->compno     = compno;
+                                row->reslevelno = reslevelno;
+                                row->bandno     = bandno;
+                                row->cblky      = cblky;
                             }
                         }
-                        if (!prec->cblk[cblkno].data)
-                            prec->cblk[cblkno].data = av_malloc(1 + 8192);
-                        if (!prec->cblk[cblkno].passes)
-                            prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
-                        if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
-                            return AVERROR(ENOMEM);
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
                     }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
                 }
             }
+        if (!pass) {
+            s->cblk_rows = av_malloc_array(s->nb_cblk_rows, sizeof(*s->cblk_rows));
+            if (!s->cblk_rows)
+                return AVERROR(ENOMEM);
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
     }
+    return 0;
+}
+
+static int encode_tiles(Jpeg2000EncoderContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, ret;
+    int nb_comps = s->numXtiles * s->numYtiles * s->ncomponents;
+    int *rets;
+
+    rets = av_malloc_array(FFMAX(nb_comps, s->nb_cblk_rows), sizeof(*rets));
+    if (!rets)
+        return AVERROR(ENOMEM);
+
+    av_log(avctx, AV_LOG_DEBUG, "dwt\n");
+    avctx->execute2(avctx, dwt_thread, NULL, rets, nb_comps);
+    for (i = 0; i < nb_comps; i++)
+        if ((ret = rets[i]) < 0)
+            goto end;
+
+    av_log(avctx, AV_LOG_DEBUG, "after dwt -> tier1\n");
+    avctx->execute2(avctx, tier1_thread, NULL, rets, s->nb_cblk_rows);
+    for (i = 0; i < s->nb_cblk_rows; i++)
+        if ((ret = rets[i]) < 0)
+            goto end;
+    av_log(avctx, AV_LOG_DEBUG, "after tier1\n");
+    ret = 0;
+end:
+    av_free(rets);
+    return ret;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     truncpasses(s, tile);
@@ -980,6 +1080,7 @@ static void cleanup(Jpeg2000EncoderContext *s)
         av_freep(&s->tile[tileno].comp);
     }
     av_freep(&s->tile);
+    av_freep(&s->cblk_rows);
 }
 
 static void reinit(Jpeg2000EncoderContext *s)
@@ -1106,6 +1207,9 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     if ((ret = put_com(s, 0)) < 0)
         return ret;
 
+    if ((ret = encode_tiles(s)) < 0)
+        return ret;
+
     for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){
         uint8_t *psotptr;
         if (!(psotptr = put_sot(s, tileno)))
@@ -1203,6 +1307,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
     init_quantization(s);
     if ((ret=init_tiles(s)) < 0)
         return ret;
+    if ((ret = init_cblk_rows(s)) < 0)
+        return ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "after init\n");
 
@@ -1250,6 +1356,8 @@ AVCodec ff_jpeg2000_encoder = {
     .init           = j2kenc_init,
     .encode2        = encode_frame,
     .close          = j2kenc_destroy,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV444P, AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P,
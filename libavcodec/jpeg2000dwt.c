@@ -48,6 +48,11 @@
 #define I_LFTG_X       53274ll
 #define I_PRESHIFT 8
 
+/* The vertical pass of the forward transforms filters FF_DWT_COLS columns
+ * at once from an interleaved copy, so that every lifting step reads one
+ * cache line per row instead of striding over full lines of the tile. */
+#define DWT_COLS FF_DWT_COLS
+
 static inline void extend53(int *p, int i0, int i1)
 {
     p[i0 - 1] = p[i0 + 1];
@@ -76,6 +81,11 @@ static inline void extend97_int(int32_t *p, int i0, int i1)
     }
 }
 
+static inline void copy_cols(int *p, int dst, int src)
+{
+    memcpy(p + dst * DWT_COLS, p + src * DWT_COLS, DWT_COLS * sizeof(*p));
+}
+
 static void sd_1d53(int *p, int i0, int i1)
 {
     int i;
@@ -94,11 +104,66 @@ static void sd_1d53(int *p, int i0, int i1)
         p[2*i] += (p[2*i-1] + p[2*i+1] + 2) >> 2;
 }
 
+static void sd53_predict_cols_c(int *p, int n)
+{
+    int i, c;
+
+    for (i = 0; i < n; i++, p += 2 * DWT_COLS)
+        for (c = 0; c < DWT_COLS; c++)
+            p[c] -= (p[c - DWT_COLS] + p[c + DWT_COLS]) >> 1;
+}
+
+static void sd53_update_cols_c(int *p, int n)
+{
+    int i, c;
+
+    for (i = 0; i < n; i++, p += 2 * DWT_COLS)
+        for (c = 0; c < DWT_COLS; c++)
+            p[c] += (p[c - DWT_COLS] + p[c + DWT_COLS] + 2) >> 2;
+}
+
+/* same as sd_1d53() on DWT_COLS interleaved columns */
+static void sd_1d53_cols(const Jpeg2000DWTDSPContext *dsp, int *p, int i0, int i1)
+{
+    int c, start, end = (i1+1)>>1;
+
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (c = 0; c < DWT_COLS; c++)
+                p[DWT_COLS + c] <<= 1;
+        return;
+    }
+
+    copy_cols(p, i0 - 1, i0 + 1);
+    copy_cols(p, i1,     i1 - 2);
+    copy_cols(p, i0 - 2, i0 + 2);
+    copy_cols(p, i1 + 1, i1 - 3);
+
+    start = ((i0+1)>>1) - 1;
+    dsp->sd53_predict_cols(p + (2*start+1) * DWT_COLS, end - start);
+    start = ((i0+1)>>1);
+    dsp->sd53_update_cols(p + 2*start * DWT_COLS, end - start);
+}
+
+/* load n columns of t starting at lp, zero filling the remaining ones */
+static void load_cols(int *l, const int *t, int w, int lp, int n, int lv)
+{
+    int i, c;
+
+    for (i = 0; i < lv; i++) {
+        for (c = 0; c < n; c++)
+            l[i * DWT_COLS + c] = t[w*i + lp + c];
+        for (; c < DWT_COLS; c++)
+            l[i * DWT_COLS + c] = 0;
+    }
+}
+
 static void dwt_encode53(DWTContext *s, int *t)
 {
     int lev,
         w = s->linelen[s->ndeclevels-1][0];
     int *line = s->i_linebuf;
+    int *cols = s->i_colbuf + 3 * DWT_COLS;
     line += 3;
 
     for (lev = s->ndeclevels-1; lev >= 0; lev--){
@@ -110,20 +175,21 @@ static void dwt_encode53(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
-            int i, j = 0;
+        l = cols + mv * DWT_COLS;
+        for (lp = 0; lp < lh; lp += DWT_COLS) {
+            int i, j = 0, c, n = FFMIN(DWT_COLS, lh - lp);
 
-            for (i = 0; i < lv; i++)
-                l[i] = t[w*i + lp];
+            load_cols(l, t, w, lp, n, lv);
 
-            sd_1d53(line, mv, mv + lv);
+            sd_1d53_cols(&s->dsp, cols, mv, mv + lv);
 
             // copy back and deinterleave
             for (i =   mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
+                for (c = 0; c < n; c++)
+                    t[w*j + lp + c] = l[i * DWT_COLS + c];
             for (i = 1-mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
+                for (c = 0; c < n; c++)
+                    t[w*j + lp + c] = l[i * DWT_COLS + c];
         }
 
         // HOR_SD
@@ -245,6 +311,52 @@ static void sd_1d97_int(int *p, int i0, int i1)
         p[2 * i]     += (I_LFTG_DELTA * (p[2 * i - 1] + p[2 * i + 1]) + (1 << 15)) >> 16;
 }
 
+static void sd97_int_cols_c(int *p, int n, int coef, int rnd)
+{
+    int i, c;
+
+    for (i = 0; i < n; i++, p += 2 * DWT_COLS)
+        for (c = 0; c < DWT_COLS; c++)
+            p[c] += (coef * (int64_t)(p[c - DWT_COLS] + p[c + DWT_COLS]) + rnd) >> 16;
+}
+
+/* same as sd_1d97_int() on DWT_COLS interleaved columns, the subtracted
+ * steps use the negated coefficient with a rounding constant one lower,
+ * -((x + (1 << 15)) >> 16) being (-x + (1 << 15) - 1) >> 16 */
+static void sd_1d97_int_cols(const Jpeg2000DWTDSPContext *dsp, int *p, int i0, int i1)
+{
+    int i, c, start;
+
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (c = 0; c < DWT_COLS; c++)
+                p[DWT_COLS + c] = (p[DWT_COLS + c] * I_LFTG_X + (1<<14)) >> 15;
+        else
+            for (c = 0; c < DWT_COLS; c++)
+                p[c] = (p[c] * I_LFTG_K + (1<<15)) >> 16;
+        return;
+    }
+
+    for (i = 1; i <= 4; i++) {
+        copy_cols(p, i0 - i,     i0 + i);
+        copy_cols(p, i1 + i - 1, i1 - i - 1);
+    }
+    i0++; i1++;
+
+    start = (i0>>1) - 2;
+    dsp->sd97_int_cols(p + (2 * start + 1) * DWT_COLS, (i1>>1) + 1 - start,
+                       -I_LFTG_ALPHA, (1 << 15) - 1);
+    start = (i0>>1) - 1;
+    dsp->sd97_int_cols(p + 2 * start * DWT_COLS, (i1>>1) + 1 - start,
+                       -I_LFTG_BETA,  (1 << 15) - 1);
+    start = (i0>>1) - 1;
+    dsp->sd97_int_cols(p + (2 * start + 1) * DWT_COLS, (i1>>1) - start,
+                       I_LFTG_GAMMA,  1 << 15);
+    start = (i0>>1);
+    dsp->sd97_int_cols(p + 2 * start * DWT_COLS, (i1>>1) - start,
+                       I_LFTG_DELTA,  1 << 15);
+}
+
 static void dwt_encode97_int(DWTContext *s, int *t)
 {
     int lev;
@@ -252,6 +364,7 @@ static void dwt_encode97_int(DWTContext *s, int *t)
     int h = s->linelen[s->ndeclevels-1][1];
     int i;
     int *line = s->i_linebuf;
+    int *cols = s->i_colbuf + 5 * DWT_COLS;
     line += 5;
 
     for (i = 0; i < w * h; i++)
@@ -266,20 +379,21 @@ static void dwt_encode97_int(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
-            int i, j = 0;
+        l = cols + mv * DWT_COLS;
+        for (lp = 0; lp < lh; lp += DWT_COLS) {
+            int i, j = 0, c, n = FFMIN(DWT_COLS, lh - lp);
 
-            for (i = 0; i < lv; i++)
-                l[i] = t[w*i + lp];
+            load_cols(l, t, w, lp, n, lv);
 
-            sd_1d97_int(line, mv, mv + lv);
+            sd_1d97_int_cols(&s->dsp, cols, mv, mv + lv);
 
             // copy back and deinterleave
             for (i =   mv; i < lv; i+=2, j++)
-                t[w*j + lp] = ((l[i] * I_LFTG_X) + (1 << 15)) >> 16;
+                for (c = 0; c < n; c++)
+                    t[w*j + lp + c] = ((l[i * DWT_COLS + c] * I_LFTG_X) + (1 << 15)) >> 16;
             for (i = 1-mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
+                for (c = 0; c < n; c++)
+                    t[w*j + lp + c] = l[i * DWT_COLS + c];
         }
 
         // HOR_SD
@@ -534,6 +648,16 @@ static void dwt_decode97_int(DWTContext *s, int32_t *t)
         data[i] = (data[i] + ((1LL<<I_PRESHIFT)>>1)) >> I_PRESHIFT;
 }
 
+av_cold void ff_jpeg2000dwt_dsp_init(Jpeg2000DWTDSPContext *c)
+{
+    c->sd53_predict_cols = sd53_predict_cols_c;
+    c->sd53_update_cols  = sd53_update_cols_c;
+    c->sd97_int_cols     = sd97_int_cols_c;
+
+    if (ARCH_X86)
+        ff_jpeg2000dwt_dsp_init_x86(c);
+}
+
 int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
                          int decomp_levels, int type)
 {
@@ -542,6 +666,7 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
 
     s->ndeclevels = decomp_levels;
     s->type       = type;
+    ff_jpeg2000dwt_dsp_init(&s->dsp);
 
     for (i = 0; i < 2; i++)
         for (j = 0; j < 2; j++)
@@ -583,6 +708,14 @@ int ff_dwt_encode(DWTContext *s, void *t)
     if (s->ndeclevels == 0)
         return 0;
 
+    if (s->type != FF_DWT97 && !s->i_colbuf) {
+        int maxlen = FFMAX(s->linelen[s->ndeclevels-1][0],
+                           s->linelen[s->ndeclevels-1][1]);
+        s->i_colbuf = av_malloc_array((maxlen + 12) * DWT_COLS, sizeof(*s->i_colbuf));
+        if (!s->i_colbuf)
+            return AVERROR(ENOMEM);
+    }
+
     switch(s->type){
         case FF_DWT97:
             dwt_encode97_float(s, t); break;
@@ -621,4 +754,5 @@ void ff_dwt_destroy(DWTContext *s)
 {
     av_freep(&s->f_linebuf);
     av_freep(&s->i_linebuf);
+    av_freep(&s->i_colbuf);
 }
@@ -40,6 +40,20 @@ enum DWTType {
     FF_DWT_NB
 };
 
+#define FF_DWT_COLS 8  ///< columns filtered at once by the vertical pass of the forward transforms
+
+typedef struct Jpeg2000DWTDSPContext {
+    /**
+     * Lifting steps of the vertical pass of the forward transforms, on
+     * FF_DWT_COLS interleaved columns. Row k of the n rows updated starts at
+     * p + 2 * k * FF_DWT_COLS and is updated from the rows above and below
+     * it. p must be aligned to 32 bytes.
+     */
+    void (*sd53_predict_cols)(int *p, int n);                 ///< p -= (above + below) >> 1
+    void (*sd53_update_cols)(int *p, int n);                  ///< p += (above + below + 2) >> 2
+    void (*sd97_int_cols)(int *p, int n, int coef, int rnd);  ///< p += (coef * (above + below) + rnd) >> 16
+} Jpeg2000DWTDSPContext;
+
 typedef struct DWTContext {
     /// line lengths { horizontal, vertical } in consecutive decomposition levels
     int linelen[FF_DWT_MAX_DECLVLS][2];
@@ -47,7 +61,9 @@ typedef struct DWTContext {
     uint8_t ndeclevels;                  ///< number of decomposition levels
     uint8_t type;                        ///< 0 for 9/7; 1 for 5/3
     int32_t *i_linebuf;                  ///< int buffer used by transform
+    int32_t *i_colbuf;                   ///< int buffer used by the vertical pass of the forward transform
     float   *f_linebuf;                  ///< float buffer used by transform
+    Jpeg2000DWTDSPContext dsp;
 } DWTContext;
 
 /**
@@ -65,4 +81,7 @@ int ff_dwt_decode(DWTContext *s, void *t);
 
 void ff_dwt_destroy(DWTContext *s);
 
+void ff_jpeg2000dwt_dsp_init(Jpeg2000DWTDSPContext *c);
+void ff_jpeg2000dwt_dsp_init_x86(Jpeg2000DWTDSPContext *c);
+
 #endif /* AVCODEC_JPEG2000DWT_H */
@@ -687,6 +687,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (s->avctx->thread_count > 1         &&
+        !(avctx->active_thread_type & FF_THREAD_FRAME) &&
         s->codec_id != AV_CODEC_ID_MPEG4      &&
         s->codec_id != AV_CODEC_ID_MPEG1VIDEO &&
         s->codec_id != AV_CODEC_ID_MPEG2VIDEO &&
@@ -1147,12 +1148,45 @@ static int alloc_picture(MpegEncContext *s, Picture *pic, int shared)
                             &s->linesize, &s->uvlinesize);
 }
 
+/**
+ * Check if this context is one of the frame thread encoder instances, which
+ * code every n-th frame of an intra-only stream and must return it at once.
+ */
+static int is_frame_thread(MpegEncContext *s)
+{
+    return CONFIG_FRAME_THREAD_ENCODER && s->intra_only &&
+           s->avctx->internal->frame_thread_encoder;
+}
+
+/**
+ * Check if the stream consists of closed GOPs of a fixed length, whose
+ * coding must not depend on the previous GOPs so that the frame thread
+ * encoder can hand them to different contexts.
+ */
+static int is_fixed_closed_gop(MpegEncContext *s)
+{
+    return (s->avctx->flags & AV_CODEC_FLAG_CLOSED_GOP) &&
+           (s->mpv_flags & FF_MPV_FLAG_STRICT_GOP);
+}
+
+/**
+ * Check if pic_arg starts one of the closed GOPs which the frame thread
+ * encoder hands to this context as a whole.
+ */
+static int is_gop_thread_start(MpegEncContext *s, const AVFrame *pic_arg)
+{
+    return CONFIG_FRAME_THREAD_ENCODER && !s->intra_only && pic_arg &&
+           s->avctx->internal->frame_thread_encoder &&
+           !(s->avctx->frame_number % s->gop_size);
+}
+
 static int load_input_picture(MpegEncContext *s, const AVFrame *pic_arg)
 {
     Picture *pic = NULL;
     int64_t pts;
     int i, display_picture_number = 0, ret;
-    int encoding_delay = s->max_b_frames ? s->max_b_frames
+    int encoding_delay = is_frame_thread(s) ? 0 :
+                         s->max_b_frames ? s->max_b_frames
                                          : (s->low_delay ? 0 : 1);
     int flush_offset = 1;
     int direct = 1;
@@ -1276,6 +1310,10 @@ static int load_input_picture(MpegEncContext *s, const AVFrame *pic_arg)
 
         pic->f->display_picture_number = display_picture_number;
         pic->f->pts = pts; // we set this here to avoid modifying pic_arg
+
+        /* the previous GOP went to another context, nothing to refer to */
+        if (is_gop_thread_start(s, pic_arg))
+            pic->f->pict_type = AV_PICTURE_TYPE_I;
     } else {
         /* Flushing: When we have not received enough input frames,
          * ensure s->input_picture[0] contains the first picture */
@@ -1363,28 +1401,130 @@ static int encode_frame(AVCodecContext *c, AVFrame *frame)
     return size;
 }
 
+typedef struct BCountTrials {
+    MpegEncContext *s;
+    const AVCodec *codec;
+    int width, height;
+    int p_lambda, b_lambda, lambda2;
+    int nb_frames;          ///< frames to code after the reference
+    int64_t rd[MAX_B_FRAMES + 1];
+    int ret[MAX_B_FRAMES + 1];
+} BCountTrials;
+
+/**
+ * Encode the downscaled lookahead with jobnr B-frames between the P-frames
+ * and store its rate-distortion cost. The trials only share the downscaled
+ * input, so they are run on the slice threads.
+ */
+static int b_count_trial_thread(AVCodecContext *avctx, void *arg,
+                                int j, int threadnr)
+{
+    BCountTrials *t = arg;
+    MpegEncContext *s = t->s;
+    AVCodecContext *c;
+    AVFrame *in;
+    int64_t rd = 0;
+    int i, out_size, ret = 0;
+
+    c  = avcodec_alloc_context3(NULL);
+    in = av_frame_alloc();
+    if (!c || !in) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    c->width        = t->width;
+    c->height       = t->height;
+    c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
+    c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
+    c->mb_decision  = s->avctx->mb_decision;
+    c->me_cmp       = s->avctx->me_cmp;
+    c->mb_cmp       = s->avctx->mb_cmp;
+    c->me_sub_cmp   = s->avctx->me_sub_cmp;
+    c->pix_fmt      = AV_PIX_FMT_YUV420P;
+    c->time_base    = s->avctx->time_base;
+    c->max_b_frames = s->max_b_frames;
+
+    ret = avcodec_open2(c, t->codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    /* the downscaled frames are shared by all trials, so the picture type
+     * and quality are set on a reference of our own */
+    if ((ret = av_frame_ref(in, s->tmp_frames[0])) < 0)
+        goto fail;
+    in->pict_type = AV_PICTURE_TYPE_I;
+    in->quality   = 1 * FF_QP2LAMBDA;
+
+    out_size = encode_frame(c, in);
+    av_frame_unref(in);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+
+    //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
+
+    for (i = 0; i < t->nb_frames; i++) {
+        int is_p = i % (j + 1) == j || i == t->nb_frames - 1;
+
+        if ((ret = av_frame_ref(in, s->tmp_frames[i + 1])) < 0)
+            goto fail;
+        in->pict_type = is_p ? AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
+        in->quality   = is_p ? t->p_lambda : t->b_lambda;
+
+        out_size = encode_frame(c, in);
+        av_frame_unref(in);
+        if (out_size < 0) {
+            ret = out_size;
+            goto fail;
+        }
+
+        rd += (out_size * t->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    }
+
+    /* get the delayed frames */
+    out_size = encode_frame(c, NULL);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+    rd += (out_size * t->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+
+    rd += c->error[0] + c->error[1] + c->error[2];
+
+    t->rd[j] = rd;
+
+fail:
+    av_frame_free(&in);
+    avcodec_free_context(&c);
+    t->ret[j] = ret;
+    return ret;
+}
+
 static int estimate_best_b_count(MpegEncContext *s)
 {
-    const AVCodec *codec = avcodec_find_encoder(s->avctx->codec_id);
     const int scale = s->brd_scale;
-    int width  = s->width  >> scale;
-    int height = s->height >> scale;
-    int i, j, out_size, p_lambda, b_lambda, lambda2;
+    BCountTrials t = { s };
+    int i, j, nb_trials;
     int64_t best_rd  = INT64_MAX;
     int best_b_count = -1;
-    int ret = 0;
 
     av_assert0(scale >= 0 && scale <= 3);
 
+    t.codec  = avcodec_find_encoder(s->avctx->codec_id);
+    t.width  = s->width  >> scale;
+    t.height = s->height >> scale;
+
     //emms_c();
     //s->next_picture_ptr->quality;
-    p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
+    t.p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
     //p_lambda * FFABS(s->avctx->b_quant_factor) + s->avctx->b_quant_offset;
-    b_lambda = s->last_lambda_for[AV_PICTURE_TYPE_B];
-    if (!b_lambda) // FIXME we should do this somewhere else
-        b_lambda = p_lambda;
-    lambda2  = (b_lambda * b_lambda + (1 << FF_LAMBDA_SHIFT) / 2) >>
-               FF_LAMBDA_SHIFT;
+    t.b_lambda = s->last_lambda_for[AV_PICTURE_TYPE_B];
+    if (!t.b_lambda) // FIXME we should do this somewhere else
+        t.b_lambda = t.p_lambda;
+    t.lambda2  = (t.b_lambda * t.b_lambda + (1 << FF_LAMBDA_SHIFT) / 2) >>
+                 FF_LAMBDA_SHIFT;
 
     for (i = 0; i < s->max_b_frames + 2; i++) {
         Picture pre_input, *pre_input_ptr = i ? s->input_picture[i - 1] :
@@ -1405,93 +1545,41 @@ static int estimate_best_b_count(MpegEncContext *s)
                                        s->tmp_frames[i]->linesize[0],
                                        data[0],
                                        pre_input.f->linesize[0],
-                                       width, height);
+                                       t.width, t.height);
             s->mpvencdsp.shrink[scale](s->tmp_frames[i]->data[1],
                                        s->tmp_frames[i]->linesize[1],
                                        data[1],
                                        pre_input.f->linesize[1],
-                                       width >> 1, height >> 1);
+                                       t.width >> 1, t.height >> 1);
             s->mpvencdsp.shrink[scale](s->tmp_frames[i]->data[2],
                                        s->tmp_frames[i]->linesize[2],
                                        data[2],
                                        pre_input.f->linesize[2],
-                                       width >> 1, height >> 1);
+                                       t.width >> 1, t.height >> 1);
         }
     }
 
-    for (j = 0; j < s->max_b_frames + 1; j++) {
-        AVCodecContext *c;
-        int64_t rd = 0;
-
-        if (!s->input_picture[j])
+    for (nb_trials = 0; nb_trials < s->max_b_frames + 1; nb_trials++)
+        if (!s->input_picture[nb_trials])
             break;
 
-        c = avcodec_alloc_context3(NULL);
-        if (!c)
-            return AVERROR(ENOMEM);
-
-        c->width        = width;
-        c->height       = height;
-        c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
-        c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
-        c->mb_decision  = s->avctx->mb_decision;
-        c->me_cmp       = s->avctx->me_cmp;
-        c->mb_cmp       = s->avctx->mb_cmp;
-        c->me_sub_cmp   = s->avctx->me_sub_cmp;
-        c->pix_fmt      = AV_PIX_FMT_YUV420P;
-        c->time_base    = s->avctx->time_base;
-        c->max_b_frames = s->max_b_frames;
-
-        ret = avcodec_open2(c, codec, NULL);
-        if (ret < 0)
-            goto fail;
-
-        s->tmp_frames[0]->pict_type = AV_PICTURE_TYPE_I;
-        s->tmp_frames[0]->quality   = 1 * FF_QP2LAMBDA;
-
-        out_size = encode_frame(c, s->tmp_frames[0]);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-
-        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
-
-        for (i = 0; i < s->max_b_frames + 1; i++) {
-            int is_p = i % (j + 1) == j || i == s->max_b_frames;
-
-            s->tmp_frames[i + 1]->pict_type = is_p ?
-                                     AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
-            s->tmp_frames[i + 1]->quality   = is_p ? p_lambda : b_lambda;
-
-            out_size = encode_frame(c, s->tmp_frames[i + 1]);
-            if (out_size < 0) {
-                ret = out_size;
-                goto fail;
-            }
-
-            rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-        }
-
-        /* get the delayed frames */
-        out_size = encode_frame(c, NULL);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-        rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    /* a closed GOP of a fixed length must not look into the next one */
+    t.nb_frames = s->max_b_frames + 1;
+    if (is_fixed_closed_gop(s)) {
+        nb_trials   = FFMIN(nb_trials,
+                            FFMAX(s->gop_size - s->picture_in_gop_number, 1));
+        t.nb_frames = nb_trials;
+    }
 
-        rd += c->error[0] + c->error[1] + c->error[2];
+    s->avctx->execute2(s->avctx, b_count_trial_thread, &t, NULL, nb_trials);
 
-        if (rd < best_rd) {
-            best_rd = rd;
+    for (j = 0; j < nb_trials; j++) {
+        if (t.ret[j] < 0)
+            return t.ret[j];
+        if (t.rd[j] < best_rd) {
+            best_rd = t.rd[j];
             best_b_count = j;
         }
-
-fail:
-        avcodec_free_context(&c);
-        if (ret < 0)
-            return ret;
     }
 
     return best_b_count;
@@ -1825,6 +1913,15 @@ int ff_mpv_encode_picture(AVCodecContext *avctx, AVPacket *pkt,
 
     s->vbv_ignore_qmax = 0;
 
+    /* keep the picture numbers (temporal references, time codes) of the
+     * whole stream when only every n-th frame passes through this context */
+    if (is_frame_thread(s))
+        s->input_picture_number = s->coded_picture_number = avctx->frame_number;
+    else if (is_gop_thread_start(s, pic_arg)) {
+        s->input_picture_number = s->coded_picture_number = avctx->frame_number;
+        s->reordered_pts = avctx->internal->frame_thread_prev_pts;
+    }
+
     s->picture_in_gop_number++;
 
     if (load_input_picture(s, pic_arg) < 0)
@@ -2049,7 +2146,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         pkt->pts = s->current_picture.f->pts;
         if (!s->low_delay && s->pict_type != AV_PICTURE_TYPE_B) {
-            if (!s->current_picture.f->coded_picture_number)
+            if (is_frame_thread(s))
+                pkt->dts = avctx->internal->frame_thread_prev_pts;
+            else if (!s->current_picture.f->coded_picture_number)
                 pkt->dts = pkt->pts - s->dts_delta;
             else
                 pkt->dts = s->reordered_pts;
@@ -3650,6 +3749,44 @@ static void set_frame_distances(MpegEncContext * s){
     }
 }
 
+/**
+ * Forget the motion vectors, vector ranges and B-frame trial lambdas of
+ * the previous pictures, which would otherwise steer the coding of the
+ * next ones.
+ */
+static void reset_motion_state(MpegEncContext *s)
+{
+    const size_t mv_table_size = ((s->mb_height + 2) * s->mb_stride + 1) *
+                                 2 * sizeof(int16_t);
+    int i, j, k;
+
+    s->f_code = 1;
+    s->b_code = 1;
+
+    /* with a constant quantizer only the B-frame decision looks at these */
+    if (s->fixed_qscale) {
+        s->last_lambda_for[AV_PICTURE_TYPE_P] = 0;
+        s->last_lambda_for[AV_PICTURE_TYPE_B] = 0;
+    }
+
+    memset(s->p_mv_table_base,            0, mv_table_size);
+    memset(s->b_forw_mv_table_base,       0, mv_table_size);
+    memset(s->b_back_mv_table_base,       0, mv_table_size);
+    memset(s->b_bidir_forw_mv_table_base, 0, mv_table_size);
+    memset(s->b_bidir_back_mv_table_base, 0, mv_table_size);
+    memset(s->b_direct_mv_table_base,     0, mv_table_size);
+
+    if (s->p_field_mv_table_base[0][0]) {
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < 2; j++) {
+                for (k = 0; k < 2; k++)
+                    memset(s->b_field_mv_table_base[i][j][k], 0, mv_table_size);
+                memset(s->p_field_mv_table_base[i][j], 0, mv_table_size);
+            }
+        }
+    }
+}
+
 static int encode_picture(MpegEncContext *s, int picture_number)
 {
     int i, ret;
@@ -3671,6 +3808,9 @@ static int encode_picture(MpegEncContext *s, int picture_number)
 
     s->me.scene_change_score=0;
 
+    if (s->pict_type == AV_PICTURE_TYPE_I && is_fixed_closed_gop(s))
+        reset_motion_state(s);
+
 //    s->lambda= s->current_picture_ptr->quality; //FIXME qscale / ... stuff for ME rate distortion
 
     if(s->pict_type==AV_PICTURE_TYPE_I){
@@ -4812,6 +4952,7 @@ AVCodec ff_h263_encoder = {
     .init           = ff_mpv_encode_init,
     .encode2        = ff_mpv_encode_picture,
     .close          = ff_mpv_encode_end,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts= (const enum AVPixelFormat[]){AV_PIX_FMT_YUV420P, AV_PIX_FMT_NONE},
     .priv_class     = &h263_class,
 };
@@ -4840,7 +4981,7 @@ AVCodec ff_h263p_encoder = {
     .init           = ff_mpv_encode_init,
     .encode2        = ff_mpv_encode_picture,
     .close          = ff_mpv_encode_end,
-    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]){ AV_PIX_FMT_YUV420P, AV_PIX_FMT_NONE },
     .priv_class     = &h263p_class,
 };
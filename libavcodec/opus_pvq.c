@@ -362,14 +362,19 @@ static inline float celt_decode_pulses(OpusRangeCoder *rc, int *y, uint32_t N, u
 /*
  * Faster than libopus's search, operates entirely in the signed domain.
  * Slightly worse/better depending on N, K and the input vector.
+ * The magnitudes are cached as floats and the pulse adding and removing cases
+ * get their own loops, which keeps the inner loops free of conversions.
  */
 static float ppp_pvq_search_c(float *X, int *y, int K, int N)
 {
     int i, y_norm = 0;
     float res = 0.0f, xy_norm = 0.0f;
+    float abs_x[256], abs_y2[256];
 
-    for (i = 0; i < N; i++)
-        res += FFABS(X[i]);
+    for (i = 0; i < N; i++) {
+        abs_x[i] = FFABS(X[i]);
+        res     += abs_x[i];
+    }
 
     res = K/(res + FLT_EPSILON);
 
@@ -378,26 +383,41 @@ static float ppp_pvq_search_c(float *X, int *y, int K, int N)
         y_norm  += y[i]*y[i];
         xy_norm += y[i]*X[i];
         K -= FFABS(y[i]);
+        abs_y2[i] = 2*FFABS(y[i]);
     }
 
     while (K) {
         int max_idx = 0, phase = FFSIGN(K);
         float max_num = 0.0f;
         float max_den = 1.0f;
+        float y_base;
         y_norm += 1.0f;
-
-        for (i = 0; i < N; i++) {
-            /* If the sum has been overshot and the best place has 0 pulses allocated
-             * to it, attempting to decrease it further will actually increase the
-             * sum. Prevent this by disregarding any 0 positions when decrementing. */
-            const int ca = 1 ^ ((y[i] == 0) & (phase < 0));
-            const int y_new = y_norm  + 2*phase*FFABS(y[i]);
-            float xy_new = xy_norm + 1*phase*FFABS(X[i]);
-            xy_new = xy_new * xy_new;
-            if (ca && (max_den*xy_new) > (y_new*max_num)) {
-                max_den = y_new;
-                max_num = xy_new;
-                max_idx = i;
+        y_base  = y_norm;
+
+        if (phase > 0) {
+            for (i = 0; i < N; i++) {
+                const float y_new = y_base + abs_y2[i];
+                float xy_new = xy_norm + abs_x[i];
+                xy_new = xy_new * xy_new;
+                if ((max_den*xy_new) > (y_new*max_num)) {
+                    max_den = y_new;
+                    max_num = xy_new;
+                    max_idx = i;
+                }
+            }
+        } else {
+            for (i = 0; i < N; i++) {
+                /* If the sum has been overshot and the best place has 0 pulses allocated
+                 * to it, attempting to decrease it further will actually increase the
+                 * sum. Prevent this by disregarding any 0 positions when decrementing. */
+                const float y_new = y_base - abs_y2[i];
+                float xy_new = xy_norm - abs_x[i];
+                xy_new = xy_new * xy_new;
+                if (abs_y2[i] != 0.0f && (max_den*xy_new) > (y_new*max_num)) {
+                    max_den = y_new;
+                    max_num = xy_new;
+                    max_idx = i;
+                }
             }
         }
 
@@ -407,6 +427,7 @@ static float ppp_pvq_search_c(float *X, int *y, int K, int N)
         xy_norm += 1*phase*X[max_idx];
         y_norm  += 2*phase*y[max_idx];
         y[max_idx] += phase;
+        abs_y2[max_idx] = 2*FFABS(y[max_idx]);
     }
 
     return (float)y_norm;
@@ -379,38 +379,84 @@ static int bands_dist(OpusPsyContext *s, CeltFrame *f, float *total_dist)
     return 0;
 }
 
+/* Distortion of a set of stereo configurations of a frame */
+typedef struct OpusPsyTrials {
+    OpusPsyContext *s;
+    const CeltFrame *f;
+    int nb_trials;
+    int intensity_stereo[CELT_MAX_BANDS + 1];
+    int dual_stereo[CELT_MAX_BANDS + 1];
+    float dist[CELT_MAX_BANDS + 1];
+} OpusPsyTrials;
+
+static int bands_dist_thread(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    OpusPsyTrials *t  = arg;
+    OpusPsyContext *s = t->s;
+    CeltFrame *f      = &s->trial_frames[jobnr];
+    int i;
+
+    /* Every trial starts from the same state, including the noise seed, so
+     * the result does not depend on how the trials are split between jobs */
+    memcpy(f, t->f, sizeof(*f));
+    f->pvq = s->trial_pvq[jobnr];
+
+    for (i = jobnr; i < t->nb_trials; i += s->nb_trial_jobs) {
+        f->intensity_stereo = t->intensity_stereo[i];
+        f->dual_stereo      = t->dual_stereo[i];
+        f->seed             = t->f->seed;
+        bands_dist(s, f, &t->dist[i]);
+    }
+
+    return 0;
+}
+
+static void run_trials(OpusPsyContext *s, OpusPsyTrials *t)
+{
+    s->avctx->execute2(s->avctx, bands_dist_thread, t, NULL,
+                       FFMIN(s->nb_trial_jobs, t->nb_trials));
+}
+
 static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
 {
-    float td1, td2;
+    OpusPsyTrials t = { .s = s, .f = f, .nb_trials = 2 };
     f->dual_stereo = 0;
 
     if (s->avctx->channels < 2)
         return;
 
-    bands_dist(s, f, &td1);
-    f->dual_stereo = 1;
-    bands_dist(s, f, &td2);
+    t.intensity_stereo[0] = t.intensity_stereo[1] = f->intensity_stereo;
+    t.dual_stereo[0] = 0;
+    t.dual_stereo[1] = 1;
+    run_trials(s, &t);
 
-    f->dual_stereo = td2 < td1;
-    s->dual_stereo_used += td2 < td1;
+    f->dual_stereo = t.dist[1] < t.dist[0];
+    s->dual_stereo_used += t.dist[1] < t.dist[0];
 }
 
 static void celt_search_for_intensity(OpusPsyContext *s, CeltFrame *f)
 {
     int i, best_band = CELT_MAX_BANDS - 1;
-    float dist, best_dist = FLT_MAX;
+    float best_dist = FLT_MAX;
     /* TODO: fix, make some heuristic up here using the lambda value */
     float end_band = 0;
+    /* Lower compression levels only try every step-th band */
+    int step = 11 - av_clip(s->avctx->compression_level, 0, 10);
+    OpusPsyTrials t = { .s = s, .f = f };
 
     if (s->avctx->channels < 2)
         return;
 
-    for (i = f->end_band; i >= end_band; i--) {
-        f->intensity_stereo = i;
-        bands_dist(s, f, &dist);
-        if (best_dist > dist) {
-            best_dist = dist;
-            best_band = i;
+    for (i = f->end_band; i >= end_band; i -= step) {
+        t.intensity_stereo[t.nb_trials] = i;
+        t.dual_stereo[t.nb_trials++]    = f->dual_stereo;
+    }
+    run_trials(s, &t);
+
+    for (i = 0; i < t.nb_trials; i++) {
+        if (best_dist > t.dist[i]) {
+            best_dist = t.dist[i];
+            best_band = t.intensity_stereo[i];
         }
     }
 
@@ -555,6 +601,18 @@ av_cold int ff_opus_psy_init(OpusPsyContext *s, AVCodecContext *avctx,
         }
     }
 
+    s->nb_trial_jobs = avctx->active_thread_type & FF_THREAD_SLICE ?
+                       FFMAX(avctx->thread_count, 1) : 1;
+    s->trial_frames  = av_malloc_array(s->nb_trial_jobs, sizeof(*s->trial_frames));
+    s->trial_pvq     = av_mallocz_array(s->nb_trial_jobs, sizeof(*s->trial_pvq));
+    if (!s->trial_frames || !s->trial_pvq) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (i = 0; i < s->nb_trial_jobs; i++)
+        if ((ret = ff_celt_pvq_init(&s->trial_pvq[i], 1)) < 0)
+            goto fail;
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         float tmp;
         const int len = OPUS_BLOCK_SIZE(i);
@@ -582,6 +640,11 @@ fail:
     for (i = 0; i < s->max_steps; i++)
         av_freep(&s->steps[i]);
 
+    for (i = 0; s->trial_pvq && i < s->nb_trial_jobs; i++)
+        ff_celt_pvq_uninit(&s->trial_pvq[i]);
+    av_freep(&s->trial_pvq);
+    av_freep(&s->trial_frames);
+
     return ret;
 }
 
@@ -605,6 +668,11 @@ av_cold int ff_opus_psy_end(OpusPsyContext *s)
     for (i = 0; i < s->max_steps; i++)
         av_freep(&s->steps[i]);
 
+    for (i = 0; s->trial_pvq && i < s->nb_trial_jobs; i++)
+        ff_celt_pvq_uninit(&s->trial_pvq[i]);
+    av_freep(&s->trial_pvq);
+    av_freep(&s->trial_frames);
+
     av_log(s->avctx, AV_LOG_INFO, "Average Intensity Stereo band: %0.1f\n", s->avg_is_band);
     av_log(s->avctx, AV_LOG_INFO, "Dual Stereo used: %0.2f%%\n", ((float)s->dual_stereo_used/s->total_packets_out)*100.0f);
 
@@ -73,6 +73,11 @@ typedef struct OpusPsyContext {
 
     DECLARE_ALIGNED(32, float, scratch)[2048];
 
+    /* Per-job state for the stereo searches */
+    CeltFrame *trial_frames;
+    CeltPVQ  **trial_pvq;
+    int nb_trial_jobs;
+
     /* Stats */
     float rc_waste;
     float avg_is_band;
@@ -37,6 +37,10 @@
 
 #define IOBUF_SIZE 4096
 
+/* minimum amount of filtered data compressed as one independent band
+ * when slice threading is used */
+#define BAND_SIZE (128 * 1024)
+
 typedef struct APNGFctlChunk {
     uint32_t sequence_number;
     uint32_t width, height;
@@ -56,6 +60,8 @@ typedef struct PNGEncContext {
     int filter_type;
 
     z_stream zstream;
+    z_stream *band_zstream;      ///< raw deflate streams of the slice threads
+    int nb_band_zstreams;
     uint8_t buf[IOBUF_SIZE];
     int dpi;                     ///< Physical pixel density, in dots per inch, if set
     int dpm;                     ///< Physical pixel density, in dots per meter, if set
@@ -202,12 +208,16 @@ static uint8_t *png_choose_filter(PNGEncContext *s, uint8_t *dst,
         int i;
         int cost, bcost = INT_MAX;
         uint8_t *buf1 = dst, *buf2 = dst + size + 16;
-        for (pred = 0; pred < 5; pred++) {
+        for (pred = 0; pred < 5 && bcost; pred++) {
             png_filter_row(s, buf1 + 1, pred, src, top, size, bpp);
             buf1[0] = pred;
             cost = 0;
-            for (i = 0; i <= size; i++)
-                cost += abs((int8_t) buf1[i]);
+            // stop summing as soon as the filter cannot be the best one
+            for (i = 0; i <= size && cost < bcost; i += 64) {
+                int j, end = FFMIN(i + 64, size + 1);
+                for (j = i; j < end; j++)
+                    cost += FFABS((int8_t) buf1[j]);
+            }
             if (cost < bcost) {
                 bcost = cost;
                 FFSWAP(uint8_t *, buf1, buf2);
@@ -428,6 +438,155 @@ static int encode_headers(AVCodecContext *avctx, const AVFrame *pict)
     return 0;
 }
 
+typedef struct PNGBandContext {
+    const AVFrame *frame;
+    uint8_t *filtered;           ///< filtered rows, each one preceded by its filter type
+    uint8_t *out;                ///< compressed bands, out_size bytes apart
+    int *out_len;
+    uLong *adler;
+    int row_size;
+    int rows_per_band;
+    int nb_bands;
+    size_t out_size;
+} PNGBandContext;
+
+static int filter_band(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    PNGEncContext *s   = avctx->priv_data;
+    PNGBandContext *bc = arg;
+    const AVFrame *p   = bc->frame;
+    int y0 = jobnr * bc->rows_per_band;
+    int y1 = FFMIN(y0 + bc->rows_per_band, p->height);
+    int bpp = s->bits_per_pixel >> 3;
+    uint8_t *crow_base, *crow_buf, *crow;
+    int y;
+
+    crow_base = av_malloc((bc->row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
+    if (!crow_base)
+        return AVERROR(ENOMEM);
+    // pixel data should be aligned, but there's a control byte before it
+    crow_buf = crow_base + 15;
+
+    for (y = y0; y < y1; y++) {
+        uint8_t *ptr = p->data[0] + y * p->linesize[0];
+        uint8_t *top = y ? ptr - p->linesize[0] : NULL;
+        crow = png_choose_filter(s, crow_buf, ptr, top, bc->row_size, bpp);
+        memcpy(bc->filtered + (size_t)y * (bc->row_size + 1), crow, bc->row_size + 1);
+    }
+
+    av_free(crow_base);
+    return 0;
+}
+
+static int deflate_band(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    PNGEncContext *s   = avctx->priv_data;
+    PNGBandContext *bc = arg;
+    z_stream *zstream  = &s->band_zstream[threadnr];
+    size_t stride = bc->row_size + 1;
+    size_t start  = jobnr * bc->rows_per_band * stride;
+    size_t len    = FFMIN(bc->rows_per_band, bc->frame->height - jobnr * bc->rows_per_band) * stride;
+    int last = jobnr == bc->nb_bands - 1;
+    int ret;
+
+    deflateReset(zstream);
+    // prime the window with the end of the previous band, as a single stream would see it
+    if (jobnr) {
+        size_t dict_len = FFMIN(start, 32768);
+        if (deflateSetDictionary(zstream, bc->filtered + start - dict_len, dict_len) != Z_OK)
+            return AVERROR_EXTERNAL;
+    }
+
+    zstream->next_in   = bc->filtered + start;
+    zstream->avail_in  = len;
+    zstream->next_out  = bc->out + jobnr * bc->out_size;
+    zstream->avail_out = bc->out_size;
+    // all bands but the last end on a byte boundary and are simply concatenated
+    ret = deflate(zstream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (ret != (last ? Z_STREAM_END : Z_OK) || zstream->avail_in || !zstream->avail_out)
+        return AVERROR_EXTERNAL;
+
+    bc->out_len[jobnr] = bc->out_size - zstream->avail_out;
+    bc->adler[jobnr]   = adler32(adler32(0, NULL, 0), bc->filtered + start, len);
+    return 0;
+}
+
+/**
+ * Compress the image as bands of rows deflated in parallel, and join them
+ * into a single zlib stream.
+ */
+static int encode_frame_bands(AVCodecContext *avctx, const AVFrame *pict,
+                              int row_size, int rows_per_band)
+{
+    PNGEncContext *s = avctx->priv_data;
+    PNGBandContext bc = { 0 };
+    int *rets = NULL;
+    uint8_t *data = NULL;
+    size_t len;
+    unsigned header;
+    uLong adler;
+    int i, level, ret;
+
+    bc.frame         = pict;
+    bc.row_size      = row_size;
+    bc.rows_per_band = rows_per_band;
+    bc.nb_bands      = (pict->height + rows_per_band - 1) / rows_per_band;
+    bc.out_size      = deflateBound(&s->band_zstream[0], (size_t)rows_per_band * (row_size + 1)) + 16;
+
+    bc.filtered = av_malloc((size_t)pict->height * (row_size + 1));
+    data        = av_malloc(2 + bc.nb_bands * bc.out_size + 4);
+    bc.out_len  = av_malloc_array(bc.nb_bands, sizeof(*bc.out_len));
+    bc.adler    = av_malloc_array(bc.nb_bands, sizeof(*bc.adler));
+    rets        = av_malloc_array(bc.nb_bands, sizeof(*rets));
+    if (!bc.filtered || !data || !bc.out_len || !bc.adler || !rets) {
+        ret = AVERROR(ENOMEM);
+        goto the_end;
+    }
+    bc.out = data + 2;
+
+    avctx->execute2(avctx, filter_band, &bc, rets, bc.nb_bands);
+    for (i = 0; i < bc.nb_bands; i++)
+        if ((ret = rets[i]) < 0)
+            goto the_end;
+    avctx->execute2(avctx, deflate_band, &bc, rets, bc.nb_bands);
+    for (i = 0; i < bc.nb_bands; i++)
+        if ((ret = rets[i]) < 0)
+            goto the_end;
+
+    // zlib header, with the level flags deflate() would have written
+    level  = avctx->compression_level == FF_COMPRESSION_DEFAULT ? 6
+           : av_clip(avctx->compression_level, 0, 9);
+    header = 0x7800 | (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+    header += 31 - header % 31;
+    AV_WB16(data, header);
+
+    len   = 2 + bc.out_len[0];
+    adler = bc.adler[0];
+    for (i = 1; i < bc.nb_bands; i++) {
+        size_t band_len = FFMIN(rows_per_band, pict->height - i * rows_per_band) * (size_t)(row_size + 1);
+        memmove(data + len, bc.out + i * bc.out_size, bc.out_len[i]);
+        len  += bc.out_len[i];
+        adler = adler32_combine(adler, bc.adler[i], band_len);
+    }
+    AV_WB32(data + len, adler);
+    len += 4;
+
+    if (s->bytestream_end - s->bytestream < len + 100) {
+        ret = AVERROR(ENOMEM);
+        goto the_end;
+    }
+    png_write_image_data(avctx, data, len);
+    ret = 0;
+
+the_end:
+    av_freep(&bc.filtered);
+    av_freep(&data);
+    av_freep(&bc.out_len);
+    av_freep(&bc.adler);
+    av_freep(&rets);
+    return ret;
+}
+
 static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 {
     PNGEncContext *s       = avctx->priv_data;
@@ -441,6 +600,12 @@ static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 
     row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
 
+    if (s->band_zstream && !s->is_progressive) {
+        int rows_per_band = FFMAX(1, BAND_SIZE / (row_size + 1));
+        if (pict->height > rows_per_band)
+            return encode_frame_bands(avctx, pict, row_size, rows_per_band);
+    }
+
     crow_base = av_malloc((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
     if (!crow_base) {
         ret = AVERROR(ENOMEM);
@@ -1092,14 +1257,40 @@ FF_ENABLE_DEPRECATION_WARNINGS
     if (deflateInit2(&s->zstream, compression_level, Z_DEFLATED, 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
         return -1;
 
+    /* Follow the requested rather than the active thread type, so that the
+     * output is the same for any number of threads, including one. */
+    if ((avctx->thread_type & FF_THREAD_SLICE) &&
+        !(avctx->thread_type & FF_THREAD_FRAME)) {
+        int i, nb_threads = FFMAX(avctx->thread_count, 1);
+
+        s->band_zstream = av_mallocz_array(nb_threads, sizeof(*s->band_zstream));
+        if (!s->band_zstream)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < nb_threads; i++) {
+            z_stream *zstream = &s->band_zstream[i];
+            zstream->zalloc = ff_png_zalloc;
+            zstream->zfree  = ff_png_zfree;
+            zstream->opaque = NULL;
+            // raw deflate, the zlib header and checksum are written separately
+            if (deflateInit2(zstream, compression_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                return -1;
+            s->nb_band_zstreams++;
+        }
+    }
+
     return 0;
 }
 
 static av_cold int png_enc_close(AVCodecContext *avctx)
 {
     PNGEncContext *s = avctx->priv_data;
+    int i;
 
     deflateEnd(&s->zstream);
+    for (i = 0; i < s->nb_band_zstreams; i++)
+        deflateEnd(&s->band_zstream[i]);
+    av_freep(&s->band_zstream);
+    s->nb_band_zstreams = 0;
     av_frame_free(&s->last_frame);
     av_frame_free(&s->prev_frame);
     av_freep(&s->last_frame_packet);
@@ -1146,7 +1337,8 @@ AVCodec ff_png_encoder = {
     .init           = png_enc_init,
     .close          = png_enc_close,
     .encode2        = encode_png,
-    .capabilities   = AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_INTRA_ONLY,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA,
         AV_PIX_FMT_RGB48BE, AV_PIX_FMT_RGBA64BE,
@@ -1167,7 +1359,7 @@ AVCodec ff_apng_encoder = {
     .init           = png_enc_init,
     .close          = png_enc_close,
     .encode2        = encode_apng,
-    .capabilities   = AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_DELAY | AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA,
         AV_PIX_FMT_RGB48BE, AV_PIX_FMT_RGBA64BE,
@@ -790,7 +790,7 @@ av_cold void ff_h264dsp_init_ppc(H264DSPContext *c, const int bit_depth,
                                  const int chroma_format_idc)
 {
 #if HAVE_ALTIVEC
-    if (!PPC_ALTIVEC(av_get_cpu_flags()))
+    if (!PPC_ALTIVEC(av_cpu_get_subsystem_flags("h264dsp")))
         return;
 
     if (bit_depth == 8) {
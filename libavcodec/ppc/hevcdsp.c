@@ -110,7 +110,7 @@ static av_always_inline void scale(vec_s32 res[4], vec_s16 res_packed[2],
 av_cold void ff_hevc_dsp_init_ppc(HEVCDSPContext *c, const int bit_depth)
 {
 #if HAVE_ALTIVEC
-    if (!PPC_ALTIVEC(av_get_cpu_flags()))
+    if (!PPC_ALTIVEC(av_cpu_get_subsystem_flags("hevcdsp")))
         return;
 
     if (bit_depth == 8)
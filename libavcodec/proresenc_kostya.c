@@ -23,6 +23,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avcodec.h"
@@ -40,6 +41,14 @@
 
 #define MAX_PLANES 4
 
+#define MAX_RC_LOOKAHEAD 64
+#define RC_MAX_FACTOR    2
+
+enum {
+    RC_MODE_SLICE = 0,
+    RC_MODE_FRAME,
+};
+
 enum {
     PRORES_PROFILE_AUTO  = -1,
     PRORES_PROFILE_PROXY = 0,
@@ -226,6 +235,12 @@ typedef struct ProresThreadData {
     struct TrellisNode *nodes;
 } ProresThreadData;
 
+typedef struct ProresRCFrame {
+    AVFrame *frame;
+    int64_t cplx;      ///< sum of the row complexities
+    int64_t *row_cplx; ///< intra complexity of every row of slices
+} ProresRCFrame;
+
 typedef struct ProresContext {
     AVClass *class;
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
@@ -267,6 +282,14 @@ typedef struct ProresContext {
     int *slice_q;
 
     ProresThreadData *tdata;
+
+    int rc_mode;
+    int rc_lookahead;
+    ProresRCFrame *rc_queue;  ///< analysed frames waiting to be coded, rc_lookahead + 1 entries
+    int rc_queued;
+    int *row_bits_per_mb;     ///< budget of every row of slices in the current frame
+    int64_t rc_debt;          ///< target minus spent slice data bits so far
+    int64_t rc_frames, rc_bits;
 } ProresContext;
 
 static void get_slice_data(ProresContext *ctx, const uint16_t *src,
@@ -803,7 +826,7 @@ static int estimate_alpha_plane(ProresContext *ctx,
 
 static int find_slice_quant(AVCodecContext *avctx,
                             int trellis_node, int x, int y, int mbs_per_slice,
-                            ProresThreadData *td)
+                            int bits_per_mb, ProresThreadData *td)
 {
     ProresContext *ctx = avctx->priv_data;
     int i, q, pq, xp, yp;
@@ -891,7 +914,7 @@ static int find_slice_quant(AVCodecContext *avctx,
         slice_bits[q]  = bits;
         slice_score[q] = error;
     }
-    if (slice_bits[max_quant] <= ctx->bits_per_mb * mbs_per_slice) {
+    if (slice_bits[max_quant] <= bits_per_mb * mbs_per_slice) {
         slice_bits[max_quant + 1]  = slice_bits[max_quant];
         slice_score[max_quant + 1] = slice_score[max_quant] + 1;
         overquant = max_quant;
@@ -922,7 +945,7 @@ static int find_slice_quant(AVCodecContext *avctx,
                                              num_cblocks[i], plane_factor[i],
                                              qmat_chroma, td);
             }
-            if (bits <= ctx->bits_per_mb * mbs_per_slice)
+            if (bits <= bits_per_mb * mbs_per_slice)
                 break;
         }
 
@@ -932,7 +955,7 @@ static int find_slice_quant(AVCodecContext *avctx,
     }
     td->nodes[trellis_node + max_quant + 1].quant = overquant;
 
-    bits_limit = mbs * ctx->bits_per_mb;
+    bits_limit = mbs * bits_per_mb;
     for (pq = min_quant; pq < max_quant + 2; pq++) {
         prev = trellis_node - TRELLIS_WIDTH + pq;
 
@@ -977,13 +1000,15 @@ static int find_quant_thread(AVCodecContext *avctx, void *arg,
     ProresThreadData *td = ctx->tdata + threadnr;
     int mbs_per_slice = ctx->mbs_per_slice;
     int x, y = jobnr, mb, q = 0;
+    int bits_per_mb = ctx->row_bits_per_mb ? ctx->row_bits_per_mb[y]
+                                           : ctx->bits_per_mb;
 
     for (x = mb = 0; x < ctx->mb_width; x += mbs_per_slice, mb++) {
         while (ctx->mb_width - x < mbs_per_slice)
             mbs_per_slice >>= 1;
         q = find_slice_quant(avctx,
                              (mb + 1) * TRELLIS_WIDTH, x, y,
-                             mbs_per_slice, td);
+                             mbs_per_slice, bits_per_mb, td);
     }
 
     for (x = ctx->slices_width - 1; x >= 0; x--) {
@@ -994,6 +1019,114 @@ static int find_quant_thread(AVCodecContext *avctx, void *arg,
     return 0;
 }
 
+/* Cheap intra complexity of a row of slices: the sum of the horizontal and
+ * vertical gradients on every other sample and line of the colour planes. */
+static int analyse_row_thread(AVCodecContext *avctx, void *arg,
+                              int jobnr, int threadnr)
+{
+    ProresContext *ctx = avctx->priv_data;
+    ProresRCFrame *rcf = arg;
+    const AVFrame *pic = rcf->frame;
+    const int ppf = ctx->pictures_per_frame;
+    const int y_start = jobnr * 16 * ppf;
+    const int y_end   = FFMIN(y_start + 16 * ppf, avctx->height);
+    int64_t cplx = 0;
+    int i, x, y;
+
+    for (i = 0; i < 3; i++) {
+        const int width = i && ctx->chroma_factor == CFACTOR_Y422 ? avctx->width >> 1
+                                                                   : avctx->width;
+        const ptrdiff_t linesize = pic->linesize[i] >> 1;
+
+        for (y = FFMAX(y_start, ppf); y < y_end; y++) {
+            const uint16_t *src  = (const uint16_t *)pic->data[i] + y * linesize;
+            const uint16_t *prev = src - ppf * linesize; // previous line of the field
+
+            if ((y / ppf) & 1)
+                continue;
+            for (x = 1; x < width; x += 2)
+                cplx += FFABS(src[x] - src[x - 1]) + FFABS(src[x] - prev[x]);
+        }
+    }
+    rcf->row_cplx[jobnr] = cplx;
+
+    return 0;
+}
+
+static int rc_queue_frame(AVCodecContext *avctx, const AVFrame *pic)
+{
+    ProresContext *ctx = avctx->priv_data;
+    ProresRCFrame *rcf = &ctx->rc_queue[ctx->rc_queued];
+    int y;
+
+    if (!(rcf->frame = av_frame_clone(pic)))
+        return AVERROR(ENOMEM);
+
+    avctx->execute2(avctx, analyse_row_thread, rcf, NULL, ctx->mb_height);
+    rcf->cplx = 0;
+    for (y = 0; y < ctx->mb_height; y++)
+        rcf->cplx += rcf->row_cplx[y];
+    ctx->rc_queued++;
+
+    return 0;
+}
+
+/* Frames more complex than the average of the lookahead window get their
+ * share of its bits by complexity, the others keep the nominal budget, and
+ * what the previous frames left over or overspent is paid back over the
+ * window. Within the frame, half of the budget is spread evenly over the
+ * rows of slices and half by their complexity. */
+static void rc_frame_budget(AVCodecContext *avctx)
+{
+    ProresContext *ctx = avctx->priv_data;
+    const ProresRCFrame *cur = &ctx->rc_queue[0];
+    const int num_mbs = ctx->mb_width * ctx->mb_height * ctx->pictures_per_frame;
+    const int max_bits_per_mb = ctx->bits_per_mb * RC_MAX_FACTOR;
+    const int64_t target = (int64_t)ctx->bits_per_mb * num_mbs;
+    int64_t sum = 0, row_sum = 0, bits;
+    int i, y, bits_per_mb;
+
+    for (i = 0; i < ctx->rc_queued; i++)
+        sum += ctx->rc_queue[i].cplx + 1;
+
+    bits = FFMAX(av_rescale(target * ctx->rc_queued, cur->cplx + 1, sum), target) +
+           ctx->rc_debt / ctx->rc_queued;
+    bits_per_mb = av_clip64(bits / num_mbs, ctx->bits_per_mb / RC_MAX_FACTOR,
+                            max_bits_per_mb);
+
+    for (y = 0; y < ctx->mb_height; y++)
+        row_sum += cur->row_cplx[y] + 1;
+    for (y = 0; y < ctx->mb_height; y++)
+        ctx->row_bits_per_mb[y] =
+            FFMIN(av_rescale(bits_per_mb,
+                             (cur->row_cplx[y] + 1) * ctx->mb_height + row_sum,
+                             2 * row_sum),
+                  max_bits_per_mb * RC_MAX_FACTOR);
+
+    av_log(avctx, AV_LOG_DEBUG, "frame %"PRId64": complexity %"PRId64", "
+           "%d bits per MB\n", ctx->rc_frames, cur->cplx, bits_per_mb);
+}
+
+static void rc_frame_done(AVCodecContext *avctx, int64_t slice_bits,
+                          int frame_size)
+{
+    ProresContext *ctx = avctx->priv_data;
+    const int64_t target = (int64_t)ctx->bits_per_mb * ctx->mb_width *
+                           ctx->mb_height * ctx->pictures_per_frame;
+    const int64_t max_debt = target * (ctx->rc_lookahead + 1);
+    ProresRCFrame done = ctx->rc_queue[0];
+
+    ctx->rc_debt = av_clip64(ctx->rc_debt + target - slice_bits,
+                             -max_debt, max_debt);
+    ctx->rc_frames++;
+    ctx->rc_bits += frame_size * 8LL;
+
+    av_frame_free(&done.frame);
+    memmove(ctx->rc_queue, ctx->rc_queue + 1,
+            (ctx->rc_queued - 1) * sizeof(*ctx->rc_queue));
+    ctx->rc_queue[--ctx->rc_queued] = done;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pic, int *got_packet)
 {
@@ -1007,8 +1140,20 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     int frame_size, picture_size, slice_size;
     int pkt_size, ret;
     int max_slice_size = (ctx->frame_size_upper_bound - 200) / (ctx->pictures_per_frame * ctx->slices_per_picture + 1);
+    int64_t slice_bits = 0;
     uint8_t frame_flags;
 
+    if (ctx->rc_mode == RC_MODE_FRAME) {
+        if (pic && (ret = rc_queue_frame(avctx, pic)) < 0)
+            return ret;
+        if (pic ? ctx->rc_queued <= ctx->rc_lookahead : !ctx->rc_queued)
+            return 0;
+        pic = ctx->rc_queue[0].frame;
+        rc_frame_budget(avctx);
+    } else if (!pic) {
+        return 0;
+    }
+
     ctx->pic = pic;
     pkt_size = ctx->frame_size_upper_bound;
 
@@ -1135,6 +1280,7 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                 }
                 bytestream_put_be16(&slice_sizes, slice_size);
                 buf += slice_size - slice_hdr_size;
+                slice_bits += (slice_size - slice_hdr_size) * 8;
                 if (max_slice_size < slice_size)
                     max_slice_size = slice_size;
             }
@@ -1149,9 +1295,14 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     bytestream_put_be32(&orig_buf, frame_size);
 
     pkt->size   = frame_size;
+    pkt->pts    = pic->pts;
+    pkt->dts    = pic->pts;
     pkt->flags |= AV_PKT_FLAG_KEY;
     *got_packet = 1;
 
+    if (ctx->rc_mode == RC_MODE_FRAME)
+        rc_frame_done(avctx, slice_bits, frame_size);
+
     return 0;
 }
 
@@ -1167,6 +1318,19 @@ static av_cold int encode_close(AVCodecContext *avctx)
     av_freep(&ctx->tdata);
     av_freep(&ctx->slice_q);
 
+    if (ctx->rc_queue) {
+        for (i = 0; i <= ctx->rc_lookahead; i++) {
+            av_frame_free(&ctx->rc_queue[i].frame);
+            av_freep(&ctx->rc_queue[i].row_cplx);
+        }
+        if (ctx->rc_frames)
+            av_log(avctx, AV_LOG_VERBOSE,
+                   "%"PRId64" frames, average frame size %"PRId64" bits\n",
+                   ctx->rc_frames, ctx->rc_bits / ctx->rc_frames);
+    }
+    av_freep(&ctx->rc_queue);
+    av_freep(&ctx->row_bits_per_mb);
+
     return 0;
 }
 
@@ -1319,10 +1483,41 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 ctx->tdata[j].nodes[i].score     = 0;
             }
         }
+
+        if (ctx->rc_mode == RC_MODE_FRAME) {
+            if (CONFIG_FRAME_THREAD_ENCODER &&
+                avctx->internal->frame_thread_encoder) {
+                av_log(avctx, AV_LOG_ERROR, "Frame level rate control has to "
+                       "see every frame, use -thread_type slice.\n");
+                encode_close(avctx);
+                return AVERROR(EINVAL);
+            }
+            ctx->rc_queue        = av_mallocz_array(ctx->rc_lookahead + 1,
+                                                    sizeof(*ctx->rc_queue));
+            ctx->row_bits_per_mb = av_malloc_array(ctx->mb_height,
+                                                   sizeof(*ctx->row_bits_per_mb));
+            if (!ctx->rc_queue || !ctx->row_bits_per_mb) {
+                encode_close(avctx);
+                return AVERROR(ENOMEM);
+            }
+            for (i = 0; i <= ctx->rc_lookahead; i++) {
+                ctx->rc_queue[i].row_cplx = av_malloc_array(ctx->mb_height,
+                                                            sizeof(*ctx->rc_queue[i].row_cplx));
+                if (!ctx->rc_queue[i].row_cplx) {
+                    encode_close(avctx);
+                    return AVERROR(ENOMEM);
+                }
+            }
+        }
     } else {
         int ls = 0;
         int ls_chroma = 0;
 
+        if (ctx->rc_mode == RC_MODE_FRAME) {
+            av_log(avctx, AV_LOG_WARNING,
+                   "Rate control is not used with a fixed quantiser.\n");
+            ctx->rc_mode = RC_MODE_SLICE;
+        }
         if (ctx->force_quant > 64) {
             av_log(avctx, AV_LOG_ERROR, "too large quantiser, maximum is 64\n");
             return AVERROR_INVALIDDATA;
@@ -1343,7 +1538,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
     ctx->frame_size_upper_bound = (ctx->pictures_per_frame *
                                    ctx->slices_per_picture + 1) *
                                   (2 + 2 * ctx->num_planes +
-                                   (mps * ctx->bits_per_mb) / 8)
+                                   (mps * ctx->bits_per_mb *
+                                    (ctx->rc_mode == RC_MODE_FRAME ? RC_MAX_FACTOR : 1)) / 8)
                                   + 200;
 
     if (ctx->alpha_bits) {
@@ -1409,6 +1605,14 @@ static const AVOption options[] = {
         0, 0, VE, "quant_mat" },
     { "alpha_bits", "bits for alpha plane", OFFSET(alpha_bits), AV_OPT_TYPE_INT,
         { .i64 = 16 }, 0, 16, VE },
+    { "rc", "rate control mode", OFFSET(rc_mode), AV_OPT_TYPE_INT,
+        { .i64 = RC_MODE_SLICE }, RC_MODE_SLICE, RC_MODE_FRAME, VE, "rc" },
+    { "slice",         "every frame gets the same budget", 0, AV_OPT_TYPE_CONST,
+        { .i64 = RC_MODE_SLICE }, 0, 0, VE, "rc" },
+    { "frame",         "frame level rate control with lookahead", 0, AV_OPT_TYPE_CONST,
+        { .i64 = RC_MODE_FRAME }, 0, 0, VE, "rc" },
+    { "rc_lookahead", "number of frames analysed ahead by the frame level rate control",
+        OFFSET(rc_lookahead), AV_OPT_TYPE_INT, { .i64 = 8 }, 0, MAX_RC_LOOKAHEAD, VE },
     { NULL }
 };
 
@@ -1428,7 +1632,8 @@ AVCodec ff_prores_ks_encoder = {
     .init           = encode_init,
     .close          = encode_close,
     .encode2        = encode_frame,
-    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_INTRA_ONLY,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY | AV_CODEC_CAP_DELAY,
     .pix_fmts       = (const enum AVPixelFormat[]) {
                           AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV444P10,
                           AV_PIX_FMT_YUVA444P10, AV_PIX_FMT_NONE
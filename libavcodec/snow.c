@@ -21,6 +21,7 @@
 #include "libavutil/intmath.h"
 #include "libavutil/log.h"
 #include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
 #include "avcodec.h"
 #include "me_cmp.h"
 #include "snow_dwt.h"
@@ -122,6 +123,11 @@ int ff_snow_alloc_blocks(SnowContext *s){
     return 0;
 }
 
+int ff_snow_slice_threads(AVCodecContext *avctx)
+{
+    return avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+}
+
 static av_cold void init_qexp(void){
     int i;
     double v=128;
@@ -429,7 +435,7 @@ mca( 8, 8,8)
 
 av_cold int ff_snow_common_init(AVCodecContext *avctx){
     SnowContext *s = avctx->priv_data;
-    int width, height;
+    int width, height, plane_size, threads;
     int i, j;
 
     s->avctx= avctx;
@@ -487,10 +493,20 @@ av_cold int ff_snow_common_init(AVCodecContext *avctx){
     width= s->avctx->width;
     height= s->avctx->height;
 
-    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->spatial_idwt_buffer, width, height * sizeof(IDWTELEM), fail);
-    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->spatial_dwt_buffer,  width, height * sizeof(DWTELEM),  fail); //FIXME this does not belong here
-    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->temp_dwt_buffer,     width, sizeof(DWTELEM),  fail);
-    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->temp_idwt_buffer,    width, sizeof(IDWTELEM), fail);
+    plane_size = width * height;
+    if (av_codec_is_encoder(avctx->codec)) {
+        // the encoder keeps all planes to transform them in parallel
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(avctx->pix_fmt);
+        if (desc && desc->nb_components > 1)
+            plane_size += 2 * AV_CEIL_RSHIFT(width,  desc->log2_chroma_w) *
+                              AV_CEIL_RSHIFT(height, desc->log2_chroma_h);
+    }
+    threads = ff_snow_slice_threads(avctx);
+
+    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->spatial_idwt_buffer, plane_size, sizeof(IDWTELEM), fail);
+    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->spatial_dwt_buffer,  plane_size, sizeof(DWTELEM),  fail); //FIXME this does not belong here
+    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->temp_dwt_buffer,     width, threads * sizeof(DWTELEM),  fail);
+    FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->temp_idwt_buffer,    width, threads * sizeof(IDWTELEM), fail);
     FF_ALLOC_ARRAY_OR_GOTO(avctx,  s->run_buffer,          ((width + 1) >> 1), ((height + 1) >> 1) * sizeof(*s->run_buffer), fail);
 
     for(i=0; i<MAX_REF_FRAMES; i++) {
@@ -515,12 +531,14 @@ int ff_snow_common_init_after_header(AVCodecContext *avctx) {
     SnowContext *s = avctx->priv_data;
     int plane_index, level, orientation;
     int ret, emu_buf_size;
+    int plane_offset = 0;
 
     if(!s->scratchbuf) {
         if ((ret = ff_get_buffer(s->avctx, s->mconly_picture,
                                  AV_GET_BUFFER_FLAG_REF)) < 0)
             return ret;
-        FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->scratchbuf, FFMAX(s->mconly_picture->linesize[0], 2*avctx->width+256), 7*MB_SIZE, fail);
+        s->scratchbuf_size = FFMAX(s->mconly_picture->linesize[0], 2*avctx->width+256) * 7*MB_SIZE;
+        FF_ALLOCZ_ARRAY_OR_GOTO(avctx, s->scratchbuf, s->scratchbuf_size, ff_snow_slice_threads(avctx), fail);
         emu_buf_size = FFMAX(s->mconly_picture->linesize[0], 2*avctx->width+256) * (2 * MB_SIZE + HTAPS_MAX - 1);
         FF_ALLOC_OR_GOTO(avctx, s->emu_edge_buffer, emu_buf_size, fail);
     }
@@ -540,12 +558,16 @@ int ff_snow_common_init_after_header(AVCodecContext *avctx) {
         }
         s->plane[plane_index].width = w;
         s->plane[plane_index].height= h;
+        s->plane[plane_index].dwt_buffer = s->spatial_dwt_buffer + plane_offset;
+        s->plane[plane_index].idwt_buffer= s->spatial_idwt_buffer + plane_offset;
+        if (av_codec_is_encoder(avctx->codec))
+            plane_offset += w * h;
 
         for(level=s->spatial_decomposition_count-1; level>=0; level--){
             for(orientation=level ? 1 : 0; orientation<4; orientation++){
                 SubBand *b= &s->plane[plane_index].band[level][orientation];
 
-                b->buf= s->spatial_dwt_buffer;
+                b->buf= s->plane[plane_index].dwt_buffer;
                 b->level= level;
                 b->stride= s->plane[plane_index].width << (s->spatial_decomposition_count - level);
                 b->width = (w + !(orientation&1))>>1;
@@ -100,6 +100,8 @@ typedef struct Plane{
     int width;
     int height;
     SubBand band[MAX_DECOMPOSITIONS][4];
+    DWTELEM *dwt_buffer;                 ///< part of spatial_dwt_buffer holding this plane
+    IDWTELEM *idwt_buffer;               ///< part of spatial_idwt_buffer holding this plane
 
     int htaps;
     int8_t hcoeff[HTAPS_MAX/2];
@@ -183,6 +185,7 @@ typedef struct SnowContext{
     MpegEncContext m; // needed for motion estimation, should not be used for anything else, the idea is to eventually make the motion estimation independent of MpegEncContext, so this will be removed then (FIXME/XXX)
 
     uint8_t *scratchbuf;
+    int scratchbuf_size;                 ///< size of the part of scratchbuf used by each slice thread
     uint8_t *emu_edge_buffer;
 
     AVMotionVector *avmv;
@@ -243,6 +246,7 @@ void ff_snow_common_end(SnowContext *s);
 void ff_snow_release_buffer(AVCodecContext *avctx);
 void ff_snow_reset_contexts(SnowContext *s);
 int ff_snow_alloc_blocks(SnowContext *s);
+int ff_snow_slice_threads(AVCodecContext *avctx);
 int ff_snow_frame_start(SnowContext *s);
 void ff_snow_pred_block(SnowContext *s, uint8_t *dst, uint8_t *tmp, ptrdiff_t stride,
                      int sx, int sy, int b_w, int b_h, const BlockNode *block,
@@ -277,7 +281,7 @@ static av_always_inline int same_block(BlockNode *a, BlockNode *b){
 
 //FIXME name cleanup (b_w, block_w, b_width stuff)
 //XXX should we really inline it?
-static av_always_inline void add_yblock(SnowContext *s, int sliced, slice_buffer *sb, IDWTELEM *dst, uint8_t *dst8, const uint8_t *obmc, int src_x, int src_y, int b_w, int b_h, int w, int h, int dst_stride, int src_stride, int obmc_stride, int b_x, int b_y, int add, int offset_dst, int plane_index){
+static av_always_inline void add_yblock(SnowContext *s, int sliced, slice_buffer *sb, IDWTELEM *dst, uint8_t *dst8, const uint8_t *obmc, int src_x, int src_y, int b_w, int b_h, int w, int h, int dst_stride, int src_stride, int obmc_stride, int b_x, int b_y, int add, int offset_dst, int plane_index, uint8_t *tmp){
     const int b_width = s->b_width  << s->block_max_depth;
     const int b_height= s->b_height << s->block_max_depth;
     const int b_stride= b_width;
@@ -289,7 +293,6 @@ static av_always_inline void add_yblock(SnowContext *s, int sliced, slice_buffer
     // When src_stride is large enough, it is possible to interleave the blocks.
     // Otherwise the blocks are written sequentially in the tmp buffer.
     int tmp_step= src_stride >= 7*MB_SIZE ? MB_SIZE : MB_SIZE*src_stride;
-    uint8_t *tmp = s->scratchbuf;
     uint8_t *ptmp;
     int x,y;
 
@@ -401,7 +404,7 @@ static av_always_inline void add_yblock(SnowContext *s, int sliced, slice_buffer
     }
 }
 
-static av_always_inline void predict_slice(SnowContext *s, IDWTELEM *buf, int plane_index, int add, int mb_y){
+static av_always_inline void predict_slice(SnowContext *s, IDWTELEM *buf, int plane_index, int add, int mb_y, uint8_t *tmp){
     Plane *p= &s->plane[plane_index];
     const int mb_w= s->b_width  << s->block_max_depth;
     const int mb_h= s->b_height << s->block_max_depth;
@@ -448,7 +451,7 @@ static av_always_inline void predict_slice(SnowContext *s, IDWTELEM *buf, int pl
                    w, h,
                    w, ref_stride, obmc_stride,
                    mb_x - 1, mb_y - 1,
-                   add, 1, plane_index);
+                   add, 1, plane_index, tmp);
     }
 }
 
@@ -456,7 +459,7 @@ static av_always_inline void predict_plane(SnowContext *s, IDWTELEM *buf, int pl
     const int mb_h= s->b_height << s->block_max_depth;
     int mb_y;
     for(mb_y=0; mb_y<=mb_h; mb_y++)
-        predict_slice(s, buf, plane_index, add, mb_y);
+        predict_slice(s, buf, plane_index, add, mb_y, s->scratchbuf);
 }
 
 static inline void set_blocks(SnowContext *s, int level, int x, int y, int l, int cb, int cr, int mx, int my, int ref, int type){
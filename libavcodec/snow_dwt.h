@@ -114,6 +114,26 @@ int ff_w97_32_c(struct MpegEncContext *v, uint8_t *pix1, uint8_t *pix2, ptrdiff_
 void ff_spatial_dwt(int *buffer, int *temp, int width, int height, int stride,
                     int type, int decomposition_count);
 
+/**
+ * Separable parts of ff_spatial_dwt() and ff_spatial_idwt() for slice
+ * threading. A decomposition level is a horizontal pass over the rows
+ * [start, end) followed by a vertical pass over the columns [start, end),
+ * a composition level is the vertical pass followed by the horizontal one.
+ * Rows and columns are counted in units of the level being transformed.
+ * Running the levels in order, with every slice of a pass finished before
+ * the next pass starts, gives the same result as the whole plane functions.
+ */
+void ff_spatial_dwt_horizontal(DWTELEM *buffer, DWTELEM *temp, int width,
+                               int stride, int type, int level,
+                               int start, int end);
+void ff_spatial_dwt_vertical(DWTELEM *buffer, int height, int stride,
+                             int type, int level, int start, int end);
+void ff_spatial_idwt_vertical(IDWTELEM *buffer, int height, int stride,
+                              int type, int level, int start, int end);
+void ff_spatial_idwt_horizontal(IDWTELEM *buffer, IDWTELEM *temp, int width,
+                                int stride, int type, int level,
+                                int start, int end);
+
 void ff_spatial_idwt_buffered_init(DWTCompose *cs, slice_buffer *sb, int width,
                                    int height, int stride_line, int type,
                                    int decomposition_count);
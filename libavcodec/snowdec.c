@@ -85,7 +85,7 @@ static av_always_inline void predict_slice_buffered(SnowContext *s, slice_buffer
                    w, h,
                    w, ref_stride, obmc_stride,
                    mb_x - 1, mb_y - 1,
-                   add, 0, plane_index);
+                   add, 0, plane_index, s->scratchbuf);
     }
 
     if(s->avmv && mb_y < mb_h && plane_index == 0)
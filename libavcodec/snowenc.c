@@ -541,7 +541,7 @@ static int get_dc(SnowContext *s, int mb_x, int mb_y, int plane_index){
         int y= block_h*mb_y2 + block_h/2;
 
         add_yblock(s, 0, NULL, dst + (i&1)*block_w + (i>>1)*obmc_stride*block_h, NULL, obmc,
-                    x, y, block_w, block_h, w, h, obmc_stride, ref_stride, obmc_stride, mb_x2, mb_y2, 0, 0, plane_index);
+                    x, y, block_w, block_h, w, h, obmc_stride, ref_stride, obmc_stride, mb_x2, mb_y2, 0, 0, plane_index, s->scratchbuf);
 
         for(y2= FFMAX(y, 0); y2<FFMIN(h, y+block_h); y2++){
             for(x2= FFMAX(x, 0); x2<FFMIN(w, x+block_w); x2++){
@@ -735,7 +735,7 @@ static int get_4block_rd(SnowContext *s, int mb_x, int mb_y, int plane_index){
         int y= block_h*mb_y2 + block_h/2;
 
         add_yblock(s, 0, NULL, zero_dst, dst, obmc,
-                   x, y, block_w, block_h, w, h, /*dst_stride*/0, ref_stride, obmc_stride, mb_x2, mb_y2, 1, 1, plane_index);
+                   x, y, block_w, block_h, w, h, /*dst_stride*/0, ref_stride, obmc_stride, mb_x2, mb_y2, 1, 1, plane_index, s->scratchbuf);
 
         //FIXME find a cleaner/simpler way to skip the outside stuff
         for(y2= y; y2<0; y2++)
@@ -1547,12 +1547,12 @@ static void calculate_visual_weight(SnowContext *s, Plane *p){
             IDWTELEM *ibuf= b->ibuf;
             int64_t error=0;
 
-            memset(s->spatial_idwt_buffer, 0, sizeof(*s->spatial_idwt_buffer)*width*height);
+            memset(p->idwt_buffer, 0, sizeof(*p->idwt_buffer)*width*height);
             ibuf[b->width/2 + b->height/2*b->stride]= 256*16;
-            ff_spatial_idwt(s->spatial_idwt_buffer, s->temp_idwt_buffer, width, height, width, s->spatial_decomposition_type, s->spatial_decomposition_count);
+            ff_spatial_idwt(p->idwt_buffer, s->temp_idwt_buffer, width, height, width, s->spatial_decomposition_type, s->spatial_decomposition_count);
             for(y=0; y<height; y++){
                 for(x=0; x<width; x++){
-                    int64_t d= s->spatial_idwt_buffer[x + y*width]*16;
+                    int64_t d= p->idwt_buffer[x + y*width]*16;
                     error += d*d;
                 }
             }
@@ -1562,6 +1562,231 @@ static void calculate_visual_weight(SnowContext *s, Plane *p){
     }
 }
 
+/**
+ * One step of the plane coding, run with execute2() over all planes at once.
+ * The transforms and the predictions are split further into nb_slices
+ * slices per plane, the quantization into one job per subband.
+ */
+typedef struct PlanePass {
+    const AVFrame *pict;
+    enum AVPictureType pict_type;
+    int first_plane;
+    int nb_slices;
+    int level;
+    int vertical;
+    int add;
+} PlanePass;
+
+static Plane *pass_plane(SnowContext *s, const PlanePass *pass, int jobnr,
+                         int nb_jobs, int *plane_index)
+{
+    *plane_index = pass->first_plane + jobnr / nb_jobs;
+    return &s->plane[*plane_index];
+}
+
+static void pass_slice(const PlanePass *pass, int jobnr, int total,
+                       int *start, int *end)
+{
+    const int slice = jobnr % pass->nb_slices;
+
+    *start = total *  slice      / pass->nb_slices;
+    *end   = total * (slice + 1) / pass->nb_slices;
+}
+
+static SubBand *pass_band(SnowContext *s, const PlanePass *pass, int jobnr,
+                          int *orientation)
+{
+    const int nb_bands = 3 * s->spatial_decomposition_count + 1;
+    const int idx      = jobnr % nb_bands;
+    const int level    = idx ? (idx - 1) / 3 : 0;
+    int plane_index;
+    Plane *p = pass_plane(s, pass, jobnr, nb_bands, &plane_index);
+
+    *orientation = idx ? (idx - 1) % 3 + 1 : 0;
+    return &p->band[level][*orientation];
+}
+
+static int load_plane_thread(AVCodecContext *avctx, void *arg,
+                             int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    const AVFrame *pict = pass->pict;
+    int plane_index, start, end, x, y;
+    Plane *p = pass_plane(s, pass, jobnr, pass->nb_slices, &plane_index);
+
+    pass_slice(pass, jobnr, p->height, &start, &end);
+    if (pict->data[plane_index]) //FIXME gray hack
+        for (y = start; y < end; y++)
+            for (x = 0; x < p->width; x++)
+                p->idwt_buffer[y * p->width + x] =
+                    pict->data[plane_index][y * pict->linesize[plane_index] + x] << FRAC_BITS;
+
+    return 0;
+}
+
+static int predict_plane_thread(AVCodecContext *avctx, void *arg,
+                                int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    const int mb_h = s->b_height << s->block_max_depth;
+    int plane_index, start, end, mb_y;
+    Plane *p = pass_plane(s, pass, jobnr, pass->nb_slices, &plane_index);
+
+    pass_slice(pass, jobnr, mb_h + 1, &start, &end);
+    for (mb_y = start; mb_y < end; mb_y++)
+        predict_slice(s, p->idwt_buffer, plane_index, pass->add, mb_y,
+                      s->scratchbuf + threadnr * s->scratchbuf_size);
+    emms_c();
+
+    return 0;
+}
+
+static int dwt_plane_thread(AVCodecContext *avctx, void *arg,
+                            int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    DWTELEM *temp = s->temp_dwt_buffer + threadnr * avctx->width;
+    int plane_index, start, end, x, y;
+    Plane *p = pass_plane(s, pass, jobnr, pass->nb_slices, &plane_index);
+    const int w = p->width;
+    const int h = p->height;
+
+    if (pass->vertical)
+        pass_slice(pass, jobnr, w >> pass->level, &start, &end);
+    else
+        pass_slice(pass, jobnr, h >> pass->level, &start, &end);
+
+    if (!pass->vertical && !pass->level) {
+        if (s->qlog == LOSSLESS_QLOG) {
+            for (y = start; y < end; y++)
+                for (x = 0; x < w; x++)
+                    p->dwt_buffer[y * w + x] = (p->idwt_buffer[y * w + x] + (1 << (FRAC_BITS - 1)) - 1) >> FRAC_BITS;
+        } else {
+            for (y = start; y < end; y++)
+                for (x = 0; x < w; x++)
+                    p->dwt_buffer[y * w + x] = p->idwt_buffer[y * w + x] << ENCODER_EXTRA_BITS;
+        }
+    }
+
+    if (pass->nb_slices == 1)
+        ff_spatial_dwt(p->dwt_buffer, temp, w, h, w,
+                       s->spatial_decomposition_type,
+                       s->spatial_decomposition_count);
+    else if (pass->vertical)
+        ff_spatial_dwt_vertical(p->dwt_buffer, h, w,
+                                s->spatial_decomposition_type,
+                                pass->level, start, end);
+    else
+        ff_spatial_dwt_horizontal(p->dwt_buffer, temp, w, w,
+                                  s->spatial_decomposition_type,
+                                  pass->level, start, end);
+
+    return 0;
+}
+
+static int idwt_plane_thread(AVCodecContext *avctx, void *arg,
+                             int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    IDWTELEM *temp = s->temp_idwt_buffer + threadnr * avctx->width;
+    int plane_index, start, end, x, y;
+    Plane *p = pass_plane(s, pass, jobnr, pass->nb_slices, &plane_index);
+    const int w = p->width;
+    const int h = p->height;
+
+    if (pass->vertical)
+        pass_slice(pass, jobnr, w >> pass->level, &start, &end);
+    else
+        pass_slice(pass, jobnr, h >> pass->level, &start, &end);
+
+    if (pass->nb_slices == 1)
+        ff_spatial_idwt(p->idwt_buffer, temp, w, h, w,
+                        s->spatial_decomposition_type,
+                        s->spatial_decomposition_count);
+    else if (pass->vertical)
+        ff_spatial_idwt_vertical(p->idwt_buffer, h, w,
+                                 s->spatial_decomposition_type,
+                                 pass->level, start, end);
+    else
+        ff_spatial_idwt_horizontal(p->idwt_buffer, temp, w, w,
+                                   s->spatial_decomposition_type,
+                                   pass->level, start, end);
+
+    if (!pass->vertical && !pass->level && s->qlog == LOSSLESS_QLOG)
+        for (y = start; y < end; y++)
+            for (x = 0; x < w; x++)
+                p->idwt_buffer[y * w + x] <<= FRAC_BITS;
+
+    return 0;
+}
+
+static int quantize_band_thread(AVCodecContext *avctx, void *arg,
+                                int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    int orientation;
+    SubBand *b = pass_band(s, pass, jobnr, &orientation);
+
+    quantize(s, b, b->ibuf, b->buf, b->stride, s->qbias);
+    if (orientation == 0)
+        decorrelate(s, b, b->ibuf, b->stride, pass->pict_type == AV_PICTURE_TYPE_P, 0);
+
+    return 0;
+}
+
+static int dequantize_band_thread(AVCodecContext *avctx, void *arg,
+                                  int jobnr, int threadnr)
+{
+    SnowContext *s = avctx->priv_data;
+    const PlanePass *pass = arg;
+    int orientation;
+    SubBand *b = pass_band(s, pass, jobnr, &orientation);
+
+    if (orientation == 0)
+        correlate(s, b, b->ibuf, b->stride, 1, 0);
+    dequantize(s, b, b->ibuf, b->stride);
+
+    return 0;
+}
+
+/* Levels are transformed in order, the passes of a level one after the other. */
+static void dwt_planes(SnowContext *s, PlanePass *pass)
+{
+    AVCodecContext *avctx = s->avctx;
+    const int nb_jobs = (s->nb_planes - pass->first_plane) * pass->nb_slices;
+
+    pass->level = pass->vertical = 0;
+    if (pass->nb_slices == 1) {
+        avctx->execute2(avctx, dwt_plane_thread, pass, NULL, nb_jobs);
+        return;
+    }
+    for (pass->level = 0; pass->level < s->spatial_decomposition_count; pass->level++)
+        for (pass->vertical = 0; pass->vertical < 2; pass->vertical++)
+            avctx->execute2(avctx, dwt_plane_thread, pass, NULL, nb_jobs);
+    pass->level = pass->vertical = 0;
+}
+
+static void idwt_planes(SnowContext *s, PlanePass *pass)
+{
+    AVCodecContext *avctx = s->avctx;
+    const int nb_jobs = (s->nb_planes - pass->first_plane) * pass->nb_slices;
+
+    pass->level = pass->vertical = 0;
+    if (pass->nb_slices == 1) {
+        avctx->execute2(avctx, idwt_plane_thread, pass, NULL, nb_jobs);
+        return;
+    }
+    for (pass->level = s->spatial_decomposition_count - 1; pass->level >= 0; pass->level--)
+        for (pass->vertical = 1; pass->vertical >= 0; pass->vertical--)
+            avctx->execute2(avctx, idwt_plane_thread, pass, NULL, nb_jobs);
+    pass->level = pass->vertical = 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
@@ -1729,105 +1954,92 @@ redo_frame:
     encode_blocks(s, 1);
     s->m.mv_bits = 8*(s->c.bytestream - s->c.bytestream_start) - s->m.misc_bits;
 
-    for(plane_index=0; plane_index < s->nb_planes; plane_index++){
-        Plane *p= &s->plane[plane_index];
-        int w= p->width;
-        int h= p->height;
-        int x, y;
-//        int bits= put_bits_count(&s->c.pb);
-
-        if (!s->memc_only) {
-            //FIXME optimize
-            if(pict->data[plane_index]) //FIXME gray hack
-                for(y=0; y<h; y++){
-                    for(x=0; x<w; x++){
-                        s->spatial_idwt_buffer[y*w + x]= pict->data[plane_index][y*pict->linesize[plane_index] + x]<<FRAC_BITS;
-                    }
-                }
-            predict_plane(s, s->spatial_idwt_buffer, plane_index, 0);
+    if (!s->memc_only) {
+        PlanePass pass = {
+            .pict      = pict,
+            .pict_type = pic->pict_type,
+            .nb_slices = ff_snow_slice_threads(avctx),
+        };
+        const int nb_bands = 3 * s->spatial_decomposition_count + 1;
+        const int lossless = s->qlog == LOSSLESS_QLOG;
 
 #if FF_API_PRIVATE_OPT
 FF_DISABLE_DEPRECATION_WARNINGS
-            if(s->avctx->scenechange_threshold)
-                s->scenechange_threshold = s->avctx->scenechange_threshold;
+        if(s->avctx->scenechange_threshold)
+            s->scenechange_threshold = s->avctx->scenechange_threshold;
 FF_ENABLE_DEPRECATION_WARNINGS
 #endif
 
-            if(   plane_index==0
-               && pic->pict_type == AV_PICTURE_TYPE_P
-               && !(avctx->flags&AV_CODEC_FLAG_PASS2)
-               && s->m.me.scene_change_score > s->scenechange_threshold){
+        if(   pic->pict_type == AV_PICTURE_TYPE_P
+           && !(avctx->flags&AV_CODEC_FLAG_PASS2)
+           && s->m.me.scene_change_score > s->scenechange_threshold){
+            ff_init_range_encoder(c, pkt->data, pkt->size);
+            ff_build_rac_states(c, (1LL<<32)/20, 256-8);
+            pic->pict_type= AV_PICTURE_TYPE_I;
+            s->keyframe=1;
+            s->current_picture->key_frame=1;
+            goto redo_frame;
+        }
+
+        avctx->execute2(avctx, load_plane_thread, &pass, NULL,
+                        s->nb_planes * pass.nb_slices);
+        avctx->execute2(avctx, predict_plane_thread, &pass, NULL,
+                        s->nb_planes * pass.nb_slices);
+        dwt_planes(s, &pass);
+
+        if(s->pass1_rc){
+            int delta_qlog = ratecontrol_1pass(s, pic);
+            if (delta_qlog <= INT_MIN)
+                return -1;
+            if(delta_qlog){
+                //reordering qlog in the bitstream would eliminate this reset
                 ff_init_range_encoder(c, pkt->data, pkt->size);
-                ff_build_rac_states(c, (1LL<<32)/20, 256-8);
-                pic->pict_type= AV_PICTURE_TYPE_I;
-                s->keyframe=1;
-                s->current_picture->key_frame=1;
-                goto redo_frame;
+                memcpy(s->header_state, rc_header_bak, sizeof(s->header_state));
+                memcpy(s->block_state, rc_block_bak, sizeof(s->block_state));
+                encode_header(s);
+                encode_blocks(s, 0);
             }
-
-            if(s->qlog == LOSSLESS_QLOG){
-                for(y=0; y<h; y++){
-                    for(x=0; x<w; x++){
-                        s->spatial_dwt_buffer[y*w + x]= (s->spatial_idwt_buffer[y*w + x] + (1<<(FRAC_BITS-1))-1)>>FRAC_BITS;
-                    }
-                }
-            }else{
-                for(y=0; y<h; y++){
-                    for(x=0; x<w; x++){
-                        s->spatial_dwt_buffer[y*w + x]=s->spatial_idwt_buffer[y*w + x]<<ENCODER_EXTRA_BITS;
-                    }
-                }
+            // the other planes were transformed for the previous qlog
+            if (lossless != (s->qlog == LOSSLESS_QLOG) && s->nb_planes > 1) {
+                pass.first_plane = 1;
+                dwt_planes(s, &pass);
+                pass.first_plane = 0;
             }
+        }
 
-            ff_spatial_dwt(s->spatial_dwt_buffer, s->temp_dwt_buffer, w, h, w, s->spatial_decomposition_type, s->spatial_decomposition_count);
-
-            if(s->pass1_rc && plane_index==0){
-                int delta_qlog = ratecontrol_1pass(s, pic);
-                if (delta_qlog <= INT_MIN)
-                    return -1;
-                if(delta_qlog){
-                    //reordering qlog in the bitstream would eliminate this reset
-                    ff_init_range_encoder(c, pkt->data, pkt->size);
-                    memcpy(s->header_state, rc_header_bak, sizeof(s->header_state));
-                    memcpy(s->block_state, rc_block_bak, sizeof(s->block_state));
-                    encode_header(s);
-                    encode_blocks(s, 0);
-                }
-            }
+        avctx->execute2(avctx, quantize_band_thread, &pass, NULL,
+                        s->nb_planes * nb_bands);
+
+        // a single range coder, so the bands have to be coded in order
+        for(plane_index=0; plane_index < s->nb_planes; plane_index++){
+            Plane *p= &s->plane[plane_index];
 
             for(level=0; level<s->spatial_decomposition_count; level++){
                 for(orientation=level ? 1 : 0; orientation<4; orientation++){
                     SubBand *b= &p->band[level][orientation];
 
-                    quantize(s, b, b->ibuf, b->buf, b->stride, s->qbias);
-                    if(orientation==0)
-                        decorrelate(s, b, b->ibuf, b->stride, pic->pict_type == AV_PICTURE_TYPE_P, 0);
                     if (!s->no_bitstream)
                     encode_subband(s, b, b->ibuf, b->parent ? b->parent->ibuf : NULL, b->stride, orientation);
                     av_assert0(b->parent==NULL || b->parent->stride == b->stride*2);
-                    if(orientation==0)
-                        correlate(s, b, b->ibuf, b->stride, 1, 0);
                 }
             }
+        }
 
-            for(level=0; level<s->spatial_decomposition_count; level++){
-                for(orientation=level ? 1 : 0; orientation<4; orientation++){
-                    SubBand *b= &p->band[level][orientation];
+        avctx->execute2(avctx, dequantize_band_thread, &pass, NULL,
+                        s->nb_planes * nb_bands);
+        idwt_planes(s, &pass);
+        pass.add = 1;
+        avctx->execute2(avctx, predict_plane_thread, &pass, NULL,
+                        s->nb_planes * pass.nb_slices);
+    }
 
-                    dequantize(s, b, b->ibuf, b->stride);
-                }
-            }
+    for(plane_index=0; plane_index < s->nb_planes; plane_index++){
+        Plane *p= &s->plane[plane_index];
+        int w= p->width;
+        int h= p->height;
+        int x, y;
 
-            ff_spatial_idwt(s->spatial_idwt_buffer, s->temp_idwt_buffer, w, h, w, s->spatial_decomposition_type, s->spatial_decomposition_count);
-            if(s->qlog == LOSSLESS_QLOG){
-                for(y=0; y<h; y++){
-                    for(x=0; x<w; x++){
-                        s->spatial_idwt_buffer[y*w + x]<<=FRAC_BITS;
-                    }
-                }
-            }
-            predict_plane(s, s->spatial_idwt_buffer, plane_index, 1);
-        }else{
+        if (s->memc_only) {
             //ME/MC only
             if(pic->pict_type == AV_PICTURE_TYPE_I){
                 for(y=0; y<h; y++){
@@ -1954,6 +2166,7 @@ AVCodec ff_snow_encoder = {
     .init           = encode_init,
     .encode2        = encode_frame,
     .close          = encode_end,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]){
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV410P, AV_PIX_FMT_YUV444P,
         AV_PIX_FMT_GRAY8,
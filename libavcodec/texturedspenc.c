@@ -171,14 +171,13 @@ static inline void rgb5652rgb(uint8_t *out, uint16_t v)
 }
 
 /* Color matching function */
-static unsigned int match_colors(const uint8_t *block, ptrdiff_t stride,
-                                 uint16_t c0, uint16_t c1)
+static unsigned int match_colors(const int rgb[3][16], uint16_t c0, uint16_t c1)
 {
     uint32_t mask = 0;
     int dirr, dirg, dirb;
     int dots[16];
     int stops[4];
-    int x, y, k = 0;
+    int x, y;
     int c0_point, half_point, c3_point;
     uint8_t color[16];
     static const int indexMap[8] = {
@@ -196,16 +195,13 @@ static unsigned int match_colors(const uint8_t *block, ptrdiff_t stride,
     dirg = color[0 * 4 + 1] - color[1 * 4 + 1];
     dirb = color[0 * 4 + 2] - color[1 * 4 + 2];
 
-    for (y = 0; y < 4; y++) {
-        for (x = 0; x < 4; x++)
-            dots[k++] = block[0 + x * 4 + y * stride] * dirr +
-                        block[1 + x * 4 + y * stride] * dirg +
-                        block[2 + x * 4 + y * stride] * dirb;
+    for (x = 0; x < 16; x++)
+        dots[x] = rgb[0][x] * dirr + rgb[1][x] * dirg + rgb[2][x] * dirb;
 
+    for (y = 0; y < 4; y++)
         stops[y] = color[0 + y * 4] * dirr +
                    color[1 + y * 4] * dirg +
                    color[2 + y * 4] * dirb;
-    }
 
     /* Think of the colors as arranged on a line; project point onto that line,
      * then choose next color out of available ones. we compute the crossover
@@ -234,34 +230,30 @@ static unsigned int match_colors(const uint8_t *block, ptrdiff_t stride,
 }
 
 /* Color optimization function */
-static void optimize_colors(const uint8_t *block, ptrdiff_t stride,
+static void optimize_colors(const int rgb[3][16],
                             uint16_t *pmax16, uint16_t *pmin16)
 {
-    const uint8_t *minp;
-    const uint8_t *maxp;
     const int iter_power = 4;
     double magn;
     int v_r, v_g, v_b;
     float covf[6], vfr, vfg, vfb;
-    int mind, maxd;
+    int mind, maxd, minp = 0, maxp = 0;
     int cov[6] = { 0 };
     int mu[3], min[3], max[3];
-    int ch, iter, x, y;
+    int dots[16];
+    int ch, iter, x;
 
     /* Determine color distribution */
     for (ch = 0; ch < 3; ch++) {
-        const uint8_t *bp = &block[ch];
         int muv, minv, maxv;
 
-        muv = minv = maxv = bp[0];
-        for (y = 0; y < 4; y++) {
-            for (x = 4; x < 4; x += 4) {
-                muv += bp[x * 4 + y * stride];
-                if (bp[x] < minv)
-                    minv = bp[x * 4 + y * stride];
-                else if (bp[x] > maxv)
-                    maxv = bp[x * 4 + y * stride];
-            }
+        muv = minv = maxv = rgb[ch][0];
+        for (x = 1; x < 16; x++) {
+            muv += rgb[ch][x];
+            if (rgb[ch][x] < minv)
+                minv = rgb[ch][x];
+            else if (rgb[ch][x] > maxv)
+                maxv = rgb[ch][x];
         }
 
         mu[ch]  = (muv + 8) >> 4;
@@ -270,19 +262,17 @@ static void optimize_colors(const uint8_t *block, ptrdiff_t stride,
     }
 
     /* Determine covariance matrix */
-    for (y = 0; y < 4; y++) {
-        for (x = 0; x < 4; x++) {
-            int r = block[x * 4 + stride * y + 0] - mu[0];
-            int g = block[x * 4 + stride * y + 1] - mu[1];
-            int b = block[x * 4 + stride * y + 2] - mu[2];
-
-            cov[0] += r * r;
-            cov[1] += r * g;
-            cov[2] += r * b;
-            cov[3] += g * g;
-            cov[4] += g * b;
-            cov[5] += b * b;
-        }
+    for (x = 0; x < 16; x++) {
+        int r = rgb[0][x] - mu[0];
+        int g = rgb[1][x] - mu[1];
+        int b = rgb[2][x] - mu[2];
+
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
     }
 
     /* Convert covariance matrix to float, find principal axis via power iter */
@@ -322,39 +312,35 @@ static void optimize_colors(const uint8_t *block, ptrdiff_t stride,
         v_b  = (int) (vfb * magn);
     }
 
+    for (x = 0; x < 16; x++)
+        dots[x] = rgb[0][x] * v_r + rgb[1][x] * v_g + rgb[2][x] * v_b;
+
     /* Pick colors at extreme points */
-    mind = maxd = block[0] * v_r + block[1] * v_g + block[2] * v_b;
-    minp = maxp = block;
-    for (y = 0; y < 4; y++) {
-        for (x = 0; x < 4; x++) {
-            int dot = block[x * 4 + y * stride + 0] * v_r +
-                      block[x * 4 + y * stride + 1] * v_g +
-                      block[x * 4 + y * stride + 2] * v_b;
-
-            if (dot < mind) {
-                mind = dot;
-                minp = block + x * 4 + y * stride;
-            } else if (dot > maxd) {
-                maxd = dot;
-                maxp = block + x * 4 + y * stride;
-            }
+    mind = maxd = dots[0];
+    for (x = 1; x < 16; x++) {
+        if (dots[x] < mind) {
+            mind = dots[x];
+            minp = x;
+        } else if (dots[x] > maxd) {
+            maxd = dots[x];
+            maxp = x;
         }
     }
 
-    *pmax16 = rgb2rgb565(maxp[0], maxp[1], maxp[2]);
-    *pmin16 = rgb2rgb565(minp[0], minp[1], minp[2]);
+    *pmax16 = rgb2rgb565(rgb[0][maxp], rgb[1][maxp], rgb[2][maxp]);
+    *pmin16 = rgb2rgb565(rgb[0][minp], rgb[1][minp], rgb[2][minp]);
 }
 
 /* Try to optimize colors to suit block contents better, by solving
  * a least squares system via normal equations + Cramer's rule. */
-static int refine_colors(const uint8_t *block, ptrdiff_t stride,
+static int refine_colors(const int rgb[3][16],
                          uint16_t *pmax16, uint16_t *pmin16, uint32_t mask)
 {
     uint32_t cm = mask;
     uint16_t oldMin = *pmin16;
     uint16_t oldMax = *pmax16;
     uint16_t min16, max16;
-    int x, y;
+    int x;
 
     /* Additional magic to save a lot of multiplies in the accumulating loop.
      * The tables contain precomputed products of weights for least squares
@@ -367,12 +353,10 @@ static int refine_colors(const uint8_t *block, ptrdiff_t stride,
         /* If so, linear system would be singular; solve using optimal
          * single-color match on average color. */
         int r = 8, g = 8, b = 8;
-        for (y = 0; y < 4; y++) {
-            for (x = 0; x < 4; x++) {
-                r += block[0 + x * 4 + y * stride];
-                g += block[1 + x * 4 + y * stride];
-                b += block[2 + x * 4 + y * stride];
-            }
+        for (x = 0; x < 16; x++) {
+            r += rgb[0][x];
+            g += rgb[1][x];
+            b += rgb[2][x];
         }
 
         r >>= 4;
@@ -388,24 +372,19 @@ static int refine_colors(const uint8_t *block, ptrdiff_t stride,
         int akku = 0;
         int xx, xy, yy;
 
-        for (y = 0; y < 4; y++) {
-            for (x = 0; x < 4; x++) {
-                int step = cm & 3;
-                int w1 = w1tab[step];
-                int r = block[0 + x * 4 + y * stride];
-                int g = block[1 + x * 4 + y * stride];
-                int b = block[2 + x * 4 + y * stride];
-
-                akku  += prods[step];
-                at1_r += w1 * r;
-                at1_g += w1 * g;
-                at1_b += w1 * b;
-                at2_r += r;
-                at2_g += g;
-                at2_b += b;
-
-                cm >>= 2;
-            }
+        for (x = 0; x < 16; x++) {
+            int step = cm & 3;
+            int w1 = w1tab[step];
+
+            akku  += prods[step];
+            at1_r += w1 * rgb[0][x];
+            at1_g += w1 * rgb[1][x];
+            at1_b += w1 * rgb[2][x];
+            at2_r += rgb[0][x];
+            at2_g += rgb[1][x];
+            at2_b += rgb[2][x];
+
+            cm >>= 2;
         }
 
         at2_r = 3 * at2_r - at1_r;
@@ -465,20 +444,31 @@ static void compress_color(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
         max16 = (match5[r][0] << 11) | (match6[g][0] << 5) | match5[b][0];
         min16 = (match5[r][1] << 11) | (match6[g][1] << 5) | match5[b][1];
     } else {
-        int refine;
+        int rgb[3][16];
+        int refine, x, y;
+
+        /* Deinterleave the block once, so that the searches below read
+         * each channel from a contiguous array instead of strided bytes */
+        for (y = 0; y < 4; y++) {
+            for (x = 0; x < 4; x++) {
+                rgb[0][x + y * 4] = block[0 + x * 4 + y * stride];
+                rgb[1][x + y * 4] = block[1 + x * 4 + y * stride];
+                rgb[2][x + y * 4] = block[2 + x * 4 + y * stride];
+            }
+        }
 
         /* Otherwise find pca and map along principal axis */
-        optimize_colors(block, stride, &max16, &min16);
+        optimize_colors(rgb, &max16, &min16);
         if (max16 != min16)
-            mask = match_colors(block, stride, max16, min16);
+            mask = match_colors(rgb, max16, min16);
         else
             mask = 0;
 
         /* One pass refinement */
-        refine  = refine_colors(block, stride, &max16, &min16, mask);
+        refine  = refine_colors(rgb, &max16, &min16, mask);
         if (refine) {
             if (max16 != min16)
-                mask = match_colors(block, stride, max16, min16);
+                mask = match_colors(rgb, max16, min16);
             else
                 mask = 0;
         }
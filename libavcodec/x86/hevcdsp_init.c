@@ -707,7 +707,7 @@ SAO_EDGE_FILTER_FUNCS(12, avx2)
 
 void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("hevcdsp");
 
     if (bit_depth == 8) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
@@ -0,0 +1,135 @@
+;******************************************************************************
+;* SIMD-optimized JPEG 2000 forward DWT lifting steps
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_2: times 8 dd 2
+
+SECTION .text
+
+; The rows hold 8 interleaved columns, i.e. 32 bytes, and every other row
+; is updated from the rows above and below it.
+
+;***********************************************************************
+; void ff_sd53_predict_cols_<opt>(int *p, int n)
+; void ff_sd53_update_cols_<opt>(int *p, int n)
+;***********************************************************************
+%macro SD53_COLS 0
+cglobal sd53_predict_cols, 2, 2, 2, p, n
+    test       nd, nd
+    jle .end
+.loop:
+%assign i 0
+%rep 32 / mmsize
+    mova       m0, [pq + i - 32]
+    paddd      m0, [pq + i + 32]
+    mova       m1, [pq + i]
+    psrad      m0, 1
+    psubd      m1, m0
+    mova [pq + i], m1
+%assign i i + mmsize
+%endrep
+    add        pq, 64
+    dec        nd
+    jg .loop
+.end:
+    RET
+
+cglobal sd53_update_cols, 2, 2, 3, p, n
+    test       nd, nd
+    jle .end
+    mova       m2, [pd_2]
+.loop:
+%assign i 0
+%rep 32 / mmsize
+    mova       m0, [pq + i - 32]
+    paddd      m0, [pq + i + 32]
+    paddd      m0, m2
+    psrad      m0, 2
+    paddd      m0, [pq + i]
+    mova [pq + i], m0
+%assign i i + mmsize
+%endrep
+    add        pq, 64
+    dec        nd
+    jg .loop
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse2
+SD53_COLS
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SD53_COLS
+%endif
+
+;***********************************************************************
+; void ff_sd97_int_cols_<opt>(int *p, int n, int coef, int rnd)
+;
+; The products need 64 bits: pmuldq multiplies the even and, after a
+; shift, the odd dwords, and bits 16 to 47 of the rounded products are
+; blended back into dwords.
+;***********************************************************************
+%macro SD97_INT_COLS 0
+cglobal sd97_int_cols, 4, 4, 6, p, n, coef, rnd
+    movd       xm4, coefd
+    movd       xm5, rndd
+%if cpuflag(avx2)
+    vpbroadcastd m4, xm4
+    vpbroadcastq m5, xm5
+%else
+    pshufd      m4, m4, 0
+    punpcklqdq  m5, m5
+%endif
+    test        nd, nd
+    jle .end
+.loop:
+%assign i 0
+%rep 32 / mmsize
+    mova        m0, [pq + i - 32]
+    paddd       m0, [pq + i + 32]
+    psrlq       m1, m0, 32
+    pmuldq      m0, m4
+    pmuldq      m1, m4
+    paddq       m0, m5
+    paddq       m1, m5
+    psrlq       m0, 16
+    psllq       m1, 16
+    pblendw     m0, m1, 0xcc
+    paddd       m0, [pq + i]
+    mova  [pq + i], m0
+%assign i i + mmsize
+%endrep
+    add         pq, 64
+    dec         nd
+    jg .loop
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse4
+SD97_INT_COLS
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SD97_INT_COLS
+%endif
@@ -0,0 +1,51 @@
+/*
+ * SIMD optimized JPEG 2000 forward DWT lifting steps
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/jpeg2000dwt.h"
+
+void ff_sd53_predict_cols_sse2(int *p, int n);
+void ff_sd53_predict_cols_avx2(int *p, int n);
+void ff_sd53_update_cols_sse2(int *p, int n);
+void ff_sd53_update_cols_avx2(int *p, int n);
+void ff_sd97_int_cols_sse4(int *p, int n, int coef, int rnd);
+void ff_sd97_int_cols_avx2(int *p, int n, int coef, int rnd);
+
+av_cold void ff_jpeg2000dwt_dsp_init_x86(Jpeg2000DWTDSPContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        c->sd53_predict_cols = ff_sd53_predict_cols_sse2;
+        c->sd53_update_cols  = ff_sd53_update_cols_sse2;
+    }
+
+    if (EXTERNAL_SSE4(cpu_flags)) {
+        c->sd97_int_cols = ff_sd97_int_cols_sse4;
+    }
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        c->sd53_predict_cols = ff_sd53_predict_cols_avx2;
+        c->sd53_update_cols  = ff_sd53_update_cols_avx2;
+        c->sd97_int_cols     = ff_sd97_int_cols_avx2;
+    }
+}
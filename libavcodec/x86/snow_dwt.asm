@@ -0,0 +1,78 @@
+;******************************************************************************
+;* SIMD-optimized snow DSP functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_8: times 16 dw 8
+
+SECTION .text
+
+; m%1 = obmc[%2] * block[%3][offset], with %4 as temporary
+%macro OBMC_MUL 4
+    mov          tmpq, [blockq + %3 * gprsize]
+    pmovzxbw       m%1, [obmcq + %2]
+    pmovzxbw       m%4, [tmpq + offsetq]
+    pmullw         m%1, m%4
+%endmacro
+
+; void ff_snow_inner_add_yblock_row(uint8_t *dst8, const IDWTELEM *dst,
+;                                   const uint8_t *obmc, int obmc_stride,
+;                                   uint8_t **block, ptrdiff_t offset)
+; The four weighted predictions are summed with unsigned saturation like in the
+; MMX version, the residual is added with signed saturation, so that the result
+; matches the C code for any coefficient.
+%macro INNER_ADD_YBLOCK_ROW 1 ; width
+cglobal snow_inner_add_yblock_row%1, 6, 8, 3, dst8, dst, obmc, obmc_stride, block, offset, half, tmp
+    movsxdifnidn obmc_strideq, obmc_strided
+    mov         halfq, obmc_strideq
+    shr         halfq, 1
+    OBMC_MUL        0, 0, 3, 1
+    OBMC_MUL        1, halfq, 2, 2
+    paddusw         m0, m1
+    imul obmc_strideq, halfq
+    add         obmcq, obmc_strideq
+    OBMC_MUL        1, 0, 1, 2
+    paddusw         m0, m1
+    OBMC_MUL        1, halfq, 0, 2
+    paddusw         m0, m1
+    psrlw           m0, 4            ; 8 - FRAC_BITS
+    movu            m1, [dstq]
+    paddsw          m0, m1
+    paddsw          m0, [pw_8]       ; 1 << (FRAC_BITS - 1)
+    psraw           m0, 4            ; FRAC_BITS
+%if mmsize == 32
+    vextracti128   xm1, m0, 1
+    packuswb       xm0, xm1
+    movu       [dst8q], xm0
+%else
+    packuswb        m0, m0
+    movh       [dst8q], m0
+%endif
+    RET
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_XMM avx2
+INNER_ADD_YBLOCK_ROW 8
+INIT_YMM avx2
+INNER_ADD_YBLOCK_ROW 16
+%endif
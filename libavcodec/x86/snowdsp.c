@@ -1,5 +1,5 @@
 /*
- * MMX and SSE2 optimized snow DSP utils
+ * MMX, SSE2 and AVX2 optimized snow DSP utils
  * Copyright (c) 2005-2006 Robert Edele <yartrebo@earthlink.net>
  *
  * This file is part of FFmpeg.
@@ -21,6 +21,7 @@
 
 #include "libavutil/cpu.h"
 #include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
 #include "libavcodec/avcodec.h"
 #include "libavcodec/snow.h"
 #include "libavcodec/snow_dwt.h"
@@ -877,11 +878,40 @@ static void ff_snow_inner_add_yblock_mmx(const uint8_t *obmc, const int obmc_str
 
 #endif /* HAVE_INLINE_ASM */
 
+void ff_snow_inner_add_yblock_row8_avx2(uint8_t *dst8, const IDWTELEM *dst,
+                                        const uint8_t *obmc, int obmc_stride,
+                                        uint8_t **block, ptrdiff_t offset);
+void ff_snow_inner_add_yblock_row16_avx2(uint8_t *dst8, const IDWTELEM *dst,
+                                         const uint8_t *obmc, int obmc_stride,
+                                         uint8_t **block, ptrdiff_t offset);
+
+#if HAVE_AVX2_EXTERNAL
+static void snow_inner_add_yblock_avx2(const uint8_t *obmc, const int obmc_stride, uint8_t * * block, int b_w, int b_h,
+                                       int src_x, int src_y, int src_stride, slice_buffer * sb, int add, uint8_t * dst8){
+    void (*add_row)(uint8_t *dst8, const IDWTELEM *dst, const uint8_t *obmc,
+                    int obmc_stride, uint8_t **block, ptrdiff_t offset);
+    int y;
+
+    if (b_w == 16)
+        add_row = ff_snow_inner_add_yblock_row16_avx2;
+    else if (b_w == 8)
+        add_row = ff_snow_inner_add_yblock_row8_avx2;
+    else {
+        ff_snow_inner_add_yblock(obmc, obmc_stride, block, b_w, b_h, src_x, src_y, src_stride, sb, add, dst8);
+        return;
+    }
+
+    for (y = 0; y < b_h; y++)
+        add_row(dst8 + y * src_stride, slice_buffer_get_line(sb, src_y + y) + src_x,
+                obmc + y * obmc_stride, obmc_stride, block, y * src_stride);
+}
+#endif /* HAVE_AVX2_EXTERNAL */
+
 av_cold void ff_dwt_init_x86(SnowDWTContext *c)
 {
-#if HAVE_INLINE_ASM
     int mm_flags = av_get_cpu_flags();
 
+#if HAVE_INLINE_ASM
     if (mm_flags & AV_CPU_FLAG_MMX) {
         if(mm_flags & AV_CPU_FLAG_SSE2 & 0){
             c->horizontal_compose97i = ff_snow_horizontal_compose97i_sse2;
@@ -905,4 +935,8 @@ av_cold void ff_dwt_init_x86(SnowDWTContext *c)
         }
     }
 #endif /* HAVE_INLINE_ASM */
+#if HAVE_AVX2_EXTERNAL
+    if (EXTERNAL_AVX2(mm_flags))
+        c->inner_add_yblock = snow_inner_add_yblock_avx2;
+#endif
 }
@@ -227,7 +227,7 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp, int bpp, int bitexact)
         return;
     }
 
-    cpu_flags = av_get_cpu_flags();
+    cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
 #define init_lpf(opt) do { \
     dsp->loop_filter_16[0] = ff_vp9_loop_filter_h_16_16_##opt; \
@@ -72,7 +72,7 @@ decl_ipred_dir_funcs(hd);
 av_cold void ff_vp9dsp_init_16bpp_x86(VP9DSPContext *dsp)
 {
 #if HAVE_X86ASM
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
     if (EXTERNAL_MMX(cpu_flags)) {
         init_fpel_func(4, 0,   8, put, , mmx);
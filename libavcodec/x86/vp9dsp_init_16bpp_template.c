@@ -142,7 +142,7 @@ decl_itxfm_func(idct,  idct, 32, BPC, sse2);
 av_cold void INIT_FUNC(VP9DSPContext *dsp, int bitexact)
 {
 #if HAVE_X86ASM
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("vp9dsp");
 
 #define init_lpf_8_func(idx1, idx2, dir, wd, bpp, opt) \
     dsp->loop_filter_8[idx1][idx2] = ff_vp9_loop_filter_##dir##_##wd##_##bpp##_##opt
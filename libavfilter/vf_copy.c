@@ -44,17 +44,49 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, formats);
 }
 
+typedef struct CopyJob {
+    av_image_job_func *func;
+    void *arg;
+} CopyJob;
+
+static int copy_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    CopyJob *job = arg;
+
+    job->func(job->arg, jobnr, nb_jobs);
+    return 0;
+}
+
+static void execute(void *opaque, av_image_job_func *func, void *arg,
+                    int nb_jobs)
+{
+    AVFilterContext *ctx = opaque;
+    CopyJob job = { func, arg };
+
+    ctx->internal->execute(ctx, copy_slice, &job, NULL, nb_jobs);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    AVFilterLink *outlink = inlink->dst->outputs[0];
+    AVFilterContext *ctx = inlink->dst;
+    AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out = ff_get_video_buffer(outlink, in->width, in->height);
+    ptrdiff_t dst_linesizes[4], src_linesizes[4];
+    int i;
 
     if (!out) {
         av_frame_free(&in);
         return AVERROR(ENOMEM);
     }
+    for (i = 0; i < 4; i++) {
+        dst_linesizes[i] = out->linesize[i];
+        src_linesizes[i] = in->linesize[i];
+    }
     av_frame_copy_props(out, in);
-    av_frame_copy(out, in);
+    av_image_copy_threaded(out->data, dst_linesizes,
+                           (const uint8_t **)in->data, src_linesizes,
+                           in->format, in->width, in->height,
+                           execute, ctx, ff_filter_get_nb_threads(ctx));
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
 }
@@ -82,4 +114,5 @@ AVFilter ff_vf_copy = {
     .inputs      = avfilter_vf_copy_inputs,
     .outputs     = avfilter_vf_copy_outputs,
     .query_formats = query_formats,
+    .flags       = AVFILTER_FLAG_SLICE_THREADS,
 };
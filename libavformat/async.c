@@ -1,5 +1,5 @@
 /*
- * Input async protocol.
+ * Async protocol.
  * Copyright (c) 2015 Zhang Rui <bbcallen@gmail.com>
  *
  * This file is part of FFmpeg.
@@ -44,6 +44,7 @@
 #define BUFFER_CAPACITY         (4 * 1024 * 1024)
 #define READ_BACK_CAPACITY      (4 * 1024 * 1024)
 #define SHORT_SEEK_THRESHOLD    (256 * 1024)
+#define WRITE_CHUNK_SIZE        (256 * 1024)
 
 typedef struct RingBuffer
 {
@@ -78,6 +79,11 @@ typedef struct Context {
 
     int             abort_request;
     AVIOInterruptCB interrupt_callback;
+
+    int             write_mode;
+    int             write_in_progress;
+    int64_t         bytes_written;
+    int             write_stalls;
 } Context;
 
 static int ring_init(RingBuffer *ring, unsigned int capacity, int read_back_capacity)
@@ -237,6 +243,67 @@ static void *async_buffer_task(void *arg)
     return NULL;
 }
 
+static void wrapped_url_write(void *dst, void *src, int size)
+{
+    URLContext *h   = dst;
+    Context    *c   = h->priv_data;
+    int         ret;
+
+    /* a failed chunk loses its data, so the ones behind it must not be
+     * written either; the error is sticky */
+    if (c->inner_io_error < 0)
+        return;
+
+    ret = ffurl_write(c->inner, src, size);
+    if (ret < 0)
+        c->inner_io_error = ret;
+}
+
+static void *async_write_task(void *arg)
+{
+    URLContext   *h    = arg;
+    Context      *c    = h->priv_data;
+    RingBuffer   *ring = &c->ring;
+
+    while (1) {
+        int fifo_size, to_copy;
+
+        pthread_mutex_lock(&c->mutex);
+        if (async_check_interrupt(h)) {
+            if (!c->io_error)
+                c->io_error = AVERROR_EXIT;
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_mutex_unlock(&c->mutex);
+            break;
+        }
+
+        fifo_size = ring_size(ring);
+        if (c->io_error || fifo_size <= 0) {
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_cond_wait(&c->cond_wakeup_background, &c->mutex);
+            pthread_mutex_unlock(&c->mutex);
+            continue;
+        }
+        c->write_in_progress = 1;
+        pthread_mutex_unlock(&c->mutex);
+
+        to_copy = FFMIN(WRITE_CHUNK_SIZE, fifo_size);
+        ring_generic_read(ring, (void *)h, to_copy, wrapped_url_write);
+
+        pthread_mutex_lock(&c->mutex);
+        c->write_in_progress = 0;
+        if (c->inner_io_error < 0)
+            c->io_error = c->inner_io_error;
+        else
+            c->bytes_written += to_copy;
+
+        pthread_cond_signal(&c->cond_wakeup_main);
+        pthread_mutex_unlock(&c->mutex);
+    }
+
+    return NULL;
+}
+
 static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **options)
 {
     Context         *c = h->priv_data;
@@ -245,7 +312,13 @@ static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **
 
     av_strstart(arg, "async:", &arg);
 
-    ret = ring_init(&c->ring, BUFFER_CAPACITY, READ_BACK_CAPACITY);
+    if ((flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE) {
+        av_log(h, AV_LOG_ERROR, "Simultaneous reading and writing is not supported\n");
+        return AVERROR(ENOSYS);
+    }
+    c->write_mode = !!(flags & AVIO_FLAG_WRITE);
+
+    ret = ring_init(&c->ring, BUFFER_CAPACITY, c->write_mode ? 0 : READ_BACK_CAPACITY);
     if (ret < 0)
         goto fifo_fail;
 
@@ -278,7 +351,8 @@ static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **
         goto cond_wakeup_background_fail;
     }
 
-    ret = pthread_create(&c->async_buffer_thread, NULL, async_buffer_task, h);
+    ret = pthread_create(&c->async_buffer_thread, NULL,
+                         c->write_mode ? async_write_task : async_buffer_task, h);
     if (ret) {
         av_log(h, AV_LOG_ERROR, "pthread_create failed : %s\n", av_err2str(ret));
         goto thread_fail;
@@ -300,12 +374,44 @@ fifo_fail:
     return ret;
 }
 
+/* wait until all the buffered data has been written out */
+static int async_write_flush(URLContext *h)
+{
+    Context      *c    = h->priv_data;
+    RingBuffer   *ring = &c->ring;
+    int           ret  = 0;
+
+    while (1) {
+        if (async_check_interrupt(h)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (c->io_error) {
+            ret = c->io_error;
+            break;
+        }
+        if (ring_size(ring) <= 0 && !c->write_in_progress)
+            break;
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+
+    return ret;
+}
+
 static int async_close(URLContext *h)
 {
     Context *c = h->priv_data;
     int      ret;
+    int      flush_ret = 0;
 
     pthread_mutex_lock(&c->mutex);
+    if (c->write_mode) {
+        flush_ret = async_write_flush(h);
+        av_log(h, AV_LOG_VERBOSE,
+               "%"PRId64" bytes written, %d writes stalled on a full buffer\n",
+               c->bytes_written, c->write_stalls);
+    }
     c->abort_request = 1;
     pthread_cond_signal(&c->cond_wakeup_background);
     pthread_mutex_unlock(&c->mutex);
@@ -320,7 +426,7 @@ static int async_close(URLContext *h)
     ffurl_close(c->inner);
     ring_destroy(&c->ring);
 
-    return 0;
+    return flush_ret;
 }
 
 static int async_read_internal(URLContext *h, void *dest, int size, int read_complete,
@@ -379,6 +485,69 @@ static void fifo_do_not_copy_func(void* dest, void* src, int size) {
     // do not copy
 }
 
+static int async_write(URLContext *h, const unsigned char *buf, int size)
+{
+    Context      *c        = h->priv_data;
+    RingBuffer   *ring     = &c->ring;
+    int           to_write = size;
+    int           ret      = size;
+
+    pthread_mutex_lock(&c->mutex);
+
+    while (to_write > 0) {
+        int fifo_space, to_copy;
+        if (async_check_interrupt(h)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (c->io_error) {
+            ret = c->io_error;
+            break;
+        }
+        fifo_space = ring_space(ring);
+        to_copy    = FFMIN(to_write, fifo_space);
+        if (to_copy > 0) {
+            ring_generic_write(ring, (void *)buf, to_copy, NULL);
+            buf            += to_copy;
+            c->logical_pos += to_copy;
+            to_write       -= to_copy;
+            pthread_cond_signal(&c->cond_wakeup_background);
+            continue;
+        }
+        c->write_stalls++;
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+
+    pthread_mutex_unlock(&c->mutex);
+
+    return ret;
+}
+
+static int64_t async_write_seek(URLContext *h, int64_t pos, int whence)
+{
+    Context      *c   = h->priv_data;
+    int64_t       ret;
+
+    if (whence == SEEK_CUR) {
+        pos   += c->logical_pos;
+        whence = SEEK_SET;
+    }
+
+    /* The seek is done in this thread once the buffer has been written
+     * out; the background thread is then idle and waits for the mutex. */
+    pthread_mutex_lock(&c->mutex);
+    ret = async_write_flush(h);
+    if (ret >= 0) {
+        ret = ffurl_seek(c->inner, pos, whence);
+        if (ret >= 0 && whence != AVSEEK_SIZE)
+            c->logical_pos = ret;
+    }
+    pthread_mutex_unlock(&c->mutex);
+
+    return ret;
+}
+
 static int64_t async_seek(URLContext *h, int64_t pos, int whence)
 {
     Context      *c    = h->priv_data;
@@ -388,6 +557,9 @@ static int64_t async_seek(URLContext *h, int64_t pos, int whence)
     int fifo_size;
     int fifo_size_of_read_back;
 
+    if (c->write_mode)
+        return async_write_seek(h, pos, whence);
+
     if (whence == AVSEEK_SIZE) {
         av_log(h, AV_LOG_TRACE, "async_seek: AVSEEK_SIZE: %"PRId64"\n", (int64_t)c->logical_size);
         return c->logical_size;
@@ -483,6 +655,7 @@ const URLProtocol ff_async_protocol = {
     .name                = "async",
     .url_open2           = async_open,
     .url_read            = async_read,
+    .url_write           = async_write,
     .url_seek            = async_seek,
     .url_close           = async_close,
     .priv_data_size      = sizeof(Context),
@@ -77,6 +77,7 @@ const AVClass ff_avio_class = {
 
 static void fill_buffer(AVIOContext *s);
 static int url_resetbuf(AVIOContext *s, int flags);
+static int io_write_packet(void *opaque, uint8_t *buf, int buf_size);
 
 int ffio_init_context(AVIOContext *s,
                   unsigned char *buffer,
@@ -222,6 +223,21 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
         writeout(s, buf, size);
         return;
     }
+    /* Payloads which would not even fit into an empty buffer (e.g. video
+     * packets written by muxers) are passed to the protocol as is, instead
+     * of being copied through the buffer piece by piece. This is only done
+     * for contexts opened with avio_open(), since user write callbacks may
+     * rely on never getting more than buffer_size bytes at once. It is not
+     * possible either for packetized protocols, which need every write to
+     * be at most max_packet_size bytes, or while a seek back into the
+     * buffer is pending. */
+    if (size >= s->buffer_size && s->write_packet == io_write_packet &&
+        !s->update_checksum && !s->max_packet_size &&
+        s->buf_ptr >= s->buf_ptr_max) {
+        flush_buffer(s);
+        writeout(s, buf, size);
+        return;
+    }
     while (size > 0) {
         int len = FFMIN(s->buf_end - s->buf_ptr, size);
         memcpy(s->buf_ptr, buf, len);
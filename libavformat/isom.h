@@ -144,6 +144,7 @@ typedef struct MOVFragmentIndexItem {
 typedef struct MOVFragmentIndex {
     int allocated_size;
     int complete;
+    int scanned;    ///< fragment times come from a scan of the moof atoms
     int current;
     int nb_items;
     MOVFragmentIndexItem * item;
@@ -273,6 +274,7 @@ typedef struct MOVContext {
     int bitrates_count;
     int moov_retry;
     int use_mfra_for;
+    int lazy_frag_index;
     int has_looked_for_mfra;
     MOVFragmentIndex frag_index;
     int atom_depth;
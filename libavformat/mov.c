@@ -1251,6 +1251,8 @@ static int64_t get_frag_time(MOVFragmentIndex *frag_index,
 
     if (track_id >= 0) {
         frag_stream_info = get_frag_stream_info(frag_index, index, track_id);
+        if (frag_stream_info->sidx_pts == AV_NOPTS_VALUE && frag_index->scanned)
+            return frag_stream_info->tfdt_dts;
         return frag_stream_info->sidx_pts;
     }
 
@@ -1272,9 +1274,10 @@ static int search_frag_timestamp(MOVFragmentIndex *frag_index,
 
     if (st) {
         // If the stream is referenced by any sidx, limit the search
-        // to fragments that referenced this stream in the sidx
+        // to fragments that referenced this stream in the sidx, and
+        // likewise to the fragments containing it when scanned
         MOVStreamContext *sc = st->priv_data;
-        if (sc->has_sidx)
+        if (sc->has_sidx || frag_index->scanned)
             id = st->id;
     }
 
@@ -1297,6 +1300,24 @@ static int search_frag_timestamp(MOVFragmentIndex *frag_index,
     return a;
 }
 
+/*
+ * The fragments can only be indexed without parsing them in order if they
+ * carry their decode time in a tfdt atom, which is checked on the first one.
+ */
+static int use_lazy_frag_index(MOVContext *c)
+{
+    MOVFragmentIndexItem *item;
+    int i;
+
+    if (!c->lazy_frag_index || !c->frag_index.nb_items)
+        return 0;
+    item = &c->frag_index.item[0];
+    for (i = 0; i < item->nb_stream_info; i++)
+        if (item->stream_info[i].tfdt_dts != AV_NOPTS_VALUE)
+            return 1;
+    return 0;
+}
+
 static int update_frag_index(MOVContext *c, int64_t offset)
 {
     int index, i;
@@ -6873,9 +6894,11 @@ static int mov_read_default(MOVContext *c, AVIOContext *pb, MOVAtom atom)
                 return err;
             }
             if (c->found_moov && c->found_mdat &&
-                ((!(pb->seekable & AVIO_SEEKABLE_NORMAL) || c->fc->flags & AVFMT_FLAG_IGNIDX || c->frag_index.complete) ||
+                ((!(pb->seekable & AVIO_SEEKABLE_NORMAL) || c->fc->flags & AVFMT_FLAG_IGNIDX || c->frag_index.complete ||
+                  use_lazy_frag_index(c)) ||
                  start_pos + a.size == avio_size(pb))) {
-                if (!(pb->seekable & AVIO_SEEKABLE_NORMAL) || c->fc->flags & AVFMT_FLAG_IGNIDX || c->frag_index.complete)
+                if (!(pb->seekable & AVIO_SEEKABLE_NORMAL) || c->fc->flags & AVFMT_FLAG_IGNIDX || c->frag_index.complete ||
+                    use_lazy_frag_index(c))
                     c->next_root_atom = start_pos + a.size;
                 c->atom_depth --;
                 return 0;
@@ -7816,14 +7839,125 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
     return 0;
 }
 
+/* Record the track ids and decode times of the traf atoms of a moof atom. */
+static int mov_scan_moof(MOVContext *c, AVIOContext *pb, int64_t moof_offset, int64_t end)
+{
+    int index = update_frag_index(c, moof_offset);
+    if (index < 0)
+        return index == -1 ? AVERROR(ENOMEM) : index;
+
+    while (avio_tell(pb) + 8 <= end) {
+        int64_t start = avio_tell(pb);
+        int64_t size  = avio_rb32(pb);
+        uint32_t type = avio_rl32(pb);
+
+        if (size < 8 || start + size > end)
+            break;
+        if (type == MKTAG('t','r','a','f')) {
+            int64_t traf_end = start + size, dts = AV_NOPTS_VALUE;
+            int track_id = -1;
+
+            while (avio_tell(pb) + 8 <= traf_end) {
+                int64_t box_start = avio_tell(pb);
+                int64_t box_size  = avio_rb32(pb);
+                uint32_t box_type = avio_rl32(pb);
+                int version;
+
+                if (box_size < 8 || box_start + box_size > traf_end)
+                    break;
+                if (box_type == MKTAG('t','f','h','d')) {
+                    avio_rb32(pb); /* version + flags */
+                    track_id = avio_rb32(pb);
+                } else if (box_type == MKTAG('t','f','d','t')) {
+                    version = avio_r8(pb);
+                    avio_rb24(pb); /* flags */
+                    dts = version ? avio_rb64(pb) : avio_rb32(pb);
+                }
+                avio_seek(pb, box_start + box_size, SEEK_SET);
+            }
+            if (track_id >= 0 && dts != AV_NOPTS_VALUE) {
+                MOVFragmentStreamInfo *frag_stream_info =
+                    get_frag_stream_info(&c->frag_index, index, track_id);
+                if (frag_stream_info)
+                    frag_stream_info->tfdt_dts = dts;
+            }
+        }
+        if (avio_seek(pb, start + size, SEEK_SET) < 0)
+            break;
+    }
+
+    return 0;
+}
+
+/*
+ * Build the fragment index of a file without sidx or mfra, from the
+ * top-level atom headers and the tfdt atoms of every moof atom. The
+ * samples of each fragment are only parsed once it is actually read,
+ * when seeking to it or reading sequentially.
+ */
+static int mov_scan_fragments(AVFormatContext *s)
+{
+    MOVContext *mov = s->priv_data;
+    AVIOContext *pb = s->pb;
+    int64_t pos = avio_tell(pb), offset = 0, current_moof = -1;
+    int ret = 0;
+
+    if (mov->frag_index.current >= 0 &&
+        mov->frag_index.current < mov->frag_index.nb_items)
+        current_moof = mov->frag_index.item[mov->frag_index.current].moof_offset;
+
+    av_log(s, AV_LOG_VERBOSE, "scanning fragments\n");
+    while (avio_seek(pb, offset, SEEK_SET) == offset) {
+        int64_t size  = avio_rb32(pb);
+        uint32_t type = avio_rl32(pb);
+
+        if (avio_feof(pb))
+            break;
+        if (ff_check_interrupt(&s->interrupt_callback)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (size == 1)
+            size = avio_rb64(pb);
+        if (size < 8)
+            break;
+        if (type == MKTAG('m','o','o','f') &&
+            (ret = mov_scan_moof(mov, pb, offset, offset + size)) < 0)
+            break;
+        offset += size;
+    }
+
+    if (current_moof >= 0)
+        mov->frag_index.current = search_frag_moof_offset(&mov->frag_index, current_moof);
+    if (ret >= 0) {
+        av_log(s, AV_LOG_VERBOSE, "found %d fragments\n", mov->frag_index.nb_items);
+        mov->frag_index.complete = 1;
+        mov->frag_index.scanned  = 1;
+    }
+    if (avio_seek(pb, pos, SEEK_SET) < 0 && ret >= 0)
+        ret = AVERROR(EIO);
+
+    return ret;
+}
+
 static int mov_seek_fragment(AVFormatContext *s, AVStream *st, int64_t timestamp)
 {
     MOVContext *mov = s->priv_data;
-    int index;
+    MOVStreamContext *sc = st->priv_data;
+    int index, ret;
 
+    if (!mov->frag_index.complete && use_lazy_frag_index(mov) &&
+        (s->pb->seekable & AVIO_SEEKABLE_NORMAL)) {
+        if ((ret = mov_scan_fragments(s)) < 0)
+            return ret;
+    }
     if (!mov->frag_index.complete)
         return 0;
 
+    // Scanned fragments are indexed by their raw tfdt, while the samples
+    // they contain are shifted by the stream time offset (see mov_read_trun)
+    if (mov->frag_index.scanned && !sc->has_sidx)
+        timestamp += sc->time_offset;
     index = search_frag_timestamp(&mov->frag_index, st, timestamp);
     if (index < 0)
         index = 0;
@@ -7982,6 +8116,8 @@ static const AVOption mov_options[] = {
     { "decryption_key", "The media decryption key (hex)", OFFSET(decryption_key), AV_OPT_TYPE_BINARY, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "enable_drefs", "Enable external track support.", OFFSET(enable_drefs), AV_OPT_TYPE_BOOL,
         {.i64 = 0}, 0, 1, FLAGS },
+    { "lazy_frag_index", "Only parse fragments when they are read, and build the fragment index on the first seek",
+        OFFSET(lazy_frag_index), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, FLAGS },
 
     { NULL },
 };
@@ -81,6 +81,7 @@ static const AVOption options[] = {
     { "use_metadata_tags", "Use mdta atom for metadata.", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_USE_MDTA}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "skip_trailer", "Skip writing the mfra/tfra/mfro trailer for fragmented files", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_SKIP_TRAILER}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "negative_cts_offsets", "Use negative CTS offsets (reducing the need for edit lists)", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_NEGATIVE_CTS_OFFSETS}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
+    { "reserve_moov", "Reserve space for the moov atom, estimated from the stream durations, to avoid the faststart second pass", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RESERVE_MOOV}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     FF_RTP_FLAG_OPTS(MOVMuxContext, rtp_flags),
     { "skip_iods", "Skip writing iods atom.", offsetof(MOVMuxContext, iods_skip), AV_OPT_TYPE_BOOL, {.i64 = 1}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
     { "iods_audio_profile", "iods audio profile atom.", offsetof(MOVMuxContext, iods_audio_profile), AV_OPT_TYPE_INT, {.i64 = -1}, -1, 255, AV_OPT_FLAG_ENCODING_PARAM},
@@ -6047,6 +6048,49 @@ static int mov_create_dvd_sub_decoder_specific_info(MOVTrack *track,
     return 0;
 }
 
+/*
+ * Estimate the size of the moov atom from the duration hints of the streams.
+ * The sample tables dominate it: count stsz, stco/co64 and stsc entries for
+ * every sample, since interleaving puts few samples in each chunk, plus ctts
+ * and stss entries for video. Returns 0 if the duration is unknown.
+ */
+static int64_t estimate_moov_size(AVFormatContext *s)
+{
+    double max_duration = s->duration > 0 ? s->duration / (double)AV_TIME_BASE : 0;
+    double size = 4096;
+    int i;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        AVCodecParameters *par = st->codecpar;
+        double duration = max_duration, rate, entry_size;
+
+        if (st->duration > 0) {
+            duration = st->duration * av_q2d(st->time_base);
+            if (max_duration > 0)
+                duration = FFMIN(duration, max_duration);
+        }
+        if (duration <= 0)
+            return 0;
+
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            rate       = st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0 ?
+                         av_q2d(st->avg_frame_rate) : 60;
+            entry_size = 28;
+        } else if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+            rate       = par->sample_rate / (double)FFMAX(par->frame_size, 1024);
+            entry_size = 16;
+        } else {
+            rate       = 1;
+            entry_size = 16;
+        }
+        size += 1024 + duration * rate * entry_size;
+    }
+
+    size *= 1.1;
+    return size < INT_MAX ? (int64_t)size : 0;
+}
+
 static int mov_init(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -6099,7 +6143,18 @@ static int mov_init(AVFormatContext *s)
     }
 
     if (mov->flags & FF_MOV_FLAG_FASTSTART) {
-        mov->reserved_moov_size = -1;
+        /* Outside of fragmented mode, a reserved moov size is used to try
+         * writing the moov atom in place, with the second pass only done
+         * if it does not fit. */
+        if (!(mov->flags & FF_MOV_FLAG_FRAGMENT) &&
+            !mov->reserved_moov_size && mov->flags & FF_MOV_FLAG_RESERVE_MOOV) {
+            mov->reserved_moov_size = estimate_moov_size(s);
+            if (mov->reserved_moov_size > 0)
+                av_log(s, AV_LOG_VERBOSE, "Reserving %d bytes for the moov atom\n",
+                       mov->reserved_moov_size);
+        }
+        if (mov->flags & FF_MOV_FLAG_FRAGMENT || mov->reserved_moov_size < 16)
+            mov->reserved_moov_size = -1;
     }
 
     if (mov->use_editlist < 0) {
@@ -6430,7 +6485,13 @@ static int mov_write_header(AVFormatContext *s)
 
     if (mov->reserved_moov_size){
         mov->reserved_header_pos = avio_tell(pb);
-        if (mov->reserved_moov_size > 0)
+        if (mov->reserved_moov_size > 0 && mov->flags & FF_MOV_FLAG_FASTSTART) {
+            /* keep the file valid if the moov atom ends up being moved
+             * in front of the reserved space */
+            avio_wb32(pb, mov->reserved_moov_size);
+            ffio_wfourcc(pb, "free");
+            ffio_fill(pb, 0, mov->reserved_moov_size - 8);
+        } else if (mov->reserved_moov_size > 0)
             avio_skip(pb, mov->reserved_moov_size);
     }
 
@@ -6442,7 +6503,7 @@ static int mov_write_header(AVFormatContext *s)
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -6598,10 +6659,16 @@ static int shift_data(AVFormatContext *s)
     read_buf[0] = buf;
     read_buf[1] = buf + moov_size;
 
+    /* mark the end of the shift to up to the last data we wrote, and get ready
+     * for writing; this is done first so that protocols buffering writes
+     * (e.g. async) have handed all the data over before it is read back */
+    avio_flush(s->pb);
+    pos_end = avio_tell(s->pb);
+    avio_seek(s->pb, mov->reserved_header_pos + moov_size, SEEK_SET);
+
     /* Shift the data: the AVIO context of the output can only be used for
      * writing, so we re-open the same output, but for reading. It also avoids
      * a read/seek/write/seek back and forth. */
-    avio_flush(s->pb);
     ret = s->io_open(s, &read_pb, s->url, AVIO_FLAG_READ, NULL);
     if (ret < 0) {
         av_log(s, AV_LOG_ERROR, "Unable to re-open %s output file for "
@@ -6609,11 +6676,6 @@ static int shift_data(AVFormatContext *s)
         goto end;
     }
 
-    /* mark the end of the shift to up to the last data we wrote, and get ready
-     * for writing */
-    pos_end = avio_tell(s->pb);
-    avio_seek(s->pb, mov->reserved_header_pos + moov_size, SEEK_SET);
-
     /* start reading at where the new moov will be placed */
     avio_seek(read_pb, mov->reserved_header_pos, SEEK_SET);
     pos = avio_tell(read_pb);
@@ -6703,9 +6765,21 @@ static int mov_write_trailer(AVFormatContext *s)
             ffio_wfourcc(pb, "mdat");
             avio_wb64(pb, mov->mdat_size + 16);
         }
+
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size > 0) {
+            int moov_size = get_moov_size(s);
+            if (moov_size < 0)
+                return moov_size;
+            /* the remaining reserved space must fit a free atom */
+            if (moov_size > mov->reserved_moov_size - 8) {
+                av_log(s, AV_LOG_INFO, "Reserved moov space is too small "
+                       "(%d bytes, needed %d)\n", mov->reserved_moov_size, moov_size + 8);
+                mov->reserved_moov_size = -1;
+            }
+        }
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res < 0)
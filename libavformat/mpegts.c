@@ -157,6 +157,13 @@ struct MpegTSContext {
     int resync_size;
     int merge_pmt_versions;
 
+    /** only parse the PMT and streams of this program, 0 for all */
+    int select_program;
+    /** '|' separated list of elementary stream PIDs to demux */
+    char *select_pids;
+    int nb_selected_pids;
+    uint32_t selected_pids[NB_PID_MAX / 32];
+
     /******************************************/
     /* private mpegts data */
     /* scan context */
@@ -189,6 +196,10 @@ static const AVOption options[] = {
      {.i64 = 0}, 0, 1, 0 },
     {"skip_clear", "skip clearing programs", offsetof(MpegTSContext, skip_clear), AV_OPT_TYPE_BOOL,
      {.i64 = 0}, 0, 1, 0 },
+    {"select_program", "only demux the given program number, 0 for all programs", offsetof(MpegTSContext, select_program), AV_OPT_TYPE_INT,
+     {.i64 = 0}, 0, 0xffff, AV_OPT_FLAG_DECODING_PARAM },
+    {"select_pids", "only demux the given '|' separated elementary stream PIDs", offsetof(MpegTSContext, select_pids), AV_OPT_TYPE_STRING,
+     {.str = NULL}, 0, 0, AV_OPT_FLAG_DECODING_PARAM },
     { NULL },
 };
 
@@ -366,6 +377,38 @@ static void update_av_program_info(AVFormatContext *s, unsigned int programid,
     }
 }
 
+static int is_program_selected(MpegTSContext *ts, unsigned int programid)
+{
+    return !ts->select_program || ts->select_program == programid;
+}
+
+static int is_pid_selected(MpegTSContext *ts, unsigned int pid)
+{
+    return !ts->nb_selected_pids ||
+           ts->selected_pids[pid >> 5] & (1U << (pid & 31));
+}
+
+static int parse_selected_pids(MpegTSContext *ts)
+{
+    const char *p = ts->select_pids;
+    char *end;
+
+    while (*p) {
+        long pid = strtol(p, &end, 0);
+        if (end == p || pid < 0 || pid >= NB_PID_MAX) {
+            av_log(ts->stream, AV_LOG_ERROR,
+                   "Invalid PID list '%s'\n", ts->select_pids);
+            return AVERROR(EINVAL);
+        }
+        ts->selected_pids[pid >> 5] |= 1U << (pid & 31);
+        ts->nb_selected_pids++;
+        p = end;
+        if (*p == '|' || *p == ',')
+            p++;
+    }
+    return 0;
+}
+
 /**
  * @brief discard_pid() decides if the pid is to be discarded according
  *                      to caller's programs selection
@@ -2228,6 +2271,8 @@ static void pmt_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
         return;
     if (h->tid != PMT_TID)
         return;
+    if (!is_program_selected(ts, h->id))
+        return;
     if (skip_identical(h, tssf))
         return;
 
@@ -2302,6 +2347,14 @@ static void pmt_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
         if (pid == ts->current_pid)
             goto out;
 
+        if (!is_pid_selected(ts, pid)) {
+            desc_list_len = get16(&p, p_end);
+            if (desc_list_len < 0)
+                goto out;
+            p += desc_list_len & 0xfff;
+            continue;
+        }
+
         if (ts->merge_pmt_versions)
             stream_identifier = parse_stream_identifier_desc(p, p_end);
 
@@ -2454,6 +2507,8 @@ static void pat_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
 
         if (sid == 0x0000) {
             /* NIT info */
+        } else if (!is_program_selected(ts, sid)) {
+            /* program not requested, do not parse its PMT */
         } else {
             MpegTSFilter *fil = ts->pids[pmt_pid];
             program = av_new_program(ts->stream, sid);
@@ -2551,7 +2606,7 @@ static void sdt_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
                 if (!provider_name)
                     break;
                 name = getstr8(&p, p_end);
-                if (name) {
+                if (name && is_program_selected(ts, sid)) {
                     AVProgram *program = av_new_program(ts->stream, sid);
                     if (program) {
                         av_dict_set(&program->metadata, "service_name", name, 0);
@@ -2574,6 +2629,11 @@ static void sdt_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
 static int parse_pcr(int64_t *ppcr_high, int *ppcr_low,
                      const uint8_t *packet);
 
+static int is_auto_guessed(MpegTSContext *ts, unsigned int pid)
+{
+    return ts->auto_guess && !ts->select_program && is_pid_selected(ts, pid);
+}
+
 /* handle one TS packet */
 static int handle_packet(MpegTSContext *ts, const uint8_t *packet)
 {
@@ -2586,7 +2646,7 @@ static int handle_packet(MpegTSContext *ts, const uint8_t *packet)
     pid = AV_RB16(packet + 1) & 0x1fff;
     is_start = packet[1] & 0x40;
     tss = ts->pids[pid];
-    if (ts->auto_guess && !tss && is_start) {
+    if (!tss && is_start && is_auto_guessed(ts, pid)) {
         add_pes_stream(ts, pid, -1);
         tss = ts->pids[pid];
     }
@@ -2815,6 +2875,35 @@ static void finished_reading_packet(AVFormatContext *s, int raw_packet_size)
         avio_skip(pb, skip);
 }
 
+/**
+ * Skip the packets at the current position which handle_packet() would
+ * ignore because no filter is opened for their PID. The check is done
+ * directly on the AVIOContext buffer, avoiding the per packet read and
+ * copy overhead, which dominates when only a few PIDs of a large
+ * multiplex are demuxed.
+ *
+ * @return number of skipped packets, at most max_packets
+ */
+static int64_t skip_unhandled_packets(MpegTSContext *ts, int64_t max_packets)
+{
+    AVIOContext *pb = ts->stream->pb;
+    const uint8_t *p = pb->buf_ptr;
+    int packet_size = ts->raw_packet_size;
+    int64_t nb_skipped = 0;
+
+    while (nb_skipped < max_packets && pb->buf_end - p >= packet_size) {
+        int pid = AV_RB16(p + 1) & 0x1fff;
+        if (p[0] != 0x47 || ts->pids[pid] ||
+            (p[1] & 0x40) && is_auto_guessed(ts, pid))
+            break;
+        p += packet_size;
+        nb_skipped++;
+    }
+    if (nb_skipped)
+        avio_skip(pb, p - pb->buf_ptr);
+    return nb_skipped;
+}
+
 static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
 {
     AVFormatContext *s = ts->stream;
@@ -2856,6 +2945,9 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         if (ts->stop_parse > 0)
             break;
 
+        packet_num += skip_unhandled_packets(ts, nb_packets ? nb_packets - packet_num - 1
+                                                            : INT64_MAX);
+
         ret = read_packet(s, packet, ts->raw_packet_size, &data);
         if (ret != 0)
             break;
@@ -2966,6 +3058,12 @@ static int mpegts_read_header(AVFormatContext *s)
     ts->stream     = s;
     ts->auto_guess = 0;
 
+    if (ts->select_pids) {
+        int ret = parse_selected_pids(ts);
+        if (ret < 0)
+            return ret;
+    }
+
     if (s->iformat == &ff_mpegts_demuxer) {
         /* normal demux */
 
@@ -53,7 +53,7 @@ float ff_scalarproduct_float_neon(const float *v1, const float *v2, int len);
 
 av_cold void ff_float_dsp_init_aarch64(AVFloatDSPContext *fdsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("float_dsp");
 
     if (have_neon(cpu_flags)) {
         fdsp->butterflies_float   = ff_butterflies_float_neon;
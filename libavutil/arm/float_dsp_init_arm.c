@@ -23,7 +23,7 @@
 
 av_cold void ff_float_dsp_init_arm(AVFloatDSPContext *fdsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("float_dsp");
 
     if (have_vfp(cpu_flags))
         ff_float_dsp_init_vfp(fdsp, cpu_flags);
@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdatomic.h>
+#include <string.h>
 
 #include "attributes.h"
 #include "cpu.h"
@@ -106,6 +107,58 @@ void av_set_cpu_flags_mask(int mask)
                           memory_order_relaxed);
 }
 
+/* Subsystems whose optimized functions honour av_cpu_set_subsystem_mask() */
+static const char * const subsystem_names[] = {
+    "float_dsp",
+    "fixed_dsp",
+    "h264dsp",
+    "hevcdsp",
+    "vp9dsp",
+    "swscale",
+    "swresample",
+};
+
+/* The flags that are cleared, so that the default of all zeros keeps every
+ * flag of av_get_cpu_flags(). */
+static atomic_int subsystem_disabled[FF_ARRAY_ELEMS(subsystem_names)];
+
+static int find_subsystem(const char *name)
+{
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(subsystem_names); i++)
+        if (!strcmp(name, subsystem_names[i]))
+            return i;
+    return -1;
+}
+
+int av_cpu_set_subsystem_mask(const char *name, int mask)
+{
+    int i = find_subsystem(name);
+
+    if (i < 0)
+        return AVERROR(EINVAL);
+    atomic_store_explicit(&subsystem_disabled[i], ~mask, memory_order_relaxed);
+    return 0;
+}
+
+int av_cpu_get_subsystem_flags(const char *name)
+{
+    int flags = av_get_cpu_flags();
+    int i     = find_subsystem(name);
+
+    if (i >= 0)
+        flags &= ~atomic_load_explicit(&subsystem_disabled[i], memory_order_relaxed);
+    return flags;
+}
+
+const char *av_cpu_subsystem_name(int index)
+{
+    if (index < 0 || index >= FF_ARRAY_ELEMS(subsystem_names))
+        return NULL;
+    return subsystem_names[index];
+}
+
 int av_parse_cpu_flags(const char *s)
 {
 #define CPUFLAG_MMXEXT   (AV_CPU_FLAG_MMX      | AV_CPU_FLAG_MMXEXT | AV_CPU_FLAG_CMOV)
@@ -111,6 +111,34 @@ int av_parse_cpu_flags(const char *s);
  */
 int av_parse_cpu_caps(unsigned *flags, const char *s);
 
+/**
+ * Restrict the CPU flags the optimized functions of one subsystem may use.
+ *
+ * The functions of the subsystem are then selected based on
+ * av_get_cpu_flags() & mask, e.g. to keep a single subsystem from using
+ * AVX-512 while everything else still does. Like av_force_cpu_flags(), this
+ * only affects the contexts initialized after the call.
+ *
+ * @param name name of the subsystem, see av_cpu_subsystem_name()
+ * @param mask CPU flags the subsystem may use, -1 for all of them
+ * @return 0 on success, AVERROR(EINVAL) if there is no such subsystem
+ */
+int av_cpu_set_subsystem_mask(const char *name, int mask);
+
+/**
+ * @return the flags of av_get_cpu_flags() that the optimized functions of the
+ *         given subsystem may use, all of them for unknown subsystems
+ */
+int av_cpu_get_subsystem_flags(const char *name);
+
+/**
+ * Iterate over the subsystems supported by av_cpu_set_subsystem_mask().
+ *
+ * @return the name of the subsystem with the given index, NULL if the index
+ *         is out of range
+ */
+const char *av_cpu_subsystem_name(int index);
+
 /**
  * @return the number of logical CPU cores present.
  */
@@ -305,6 +305,102 @@ int av_image_check_sar(unsigned int w, unsigned int h, AVRational sar)
     return AVERROR(EINVAL);
 }
 
+static void copy_plane_c(uint8_t       *dst, ptrdiff_t dst_linesize,
+                         const uint8_t *src, ptrdiff_t src_linesize,
+                         ptrdiff_t bytewidth, int height)
+{
+    for (;height > 0; height--) {
+        memcpy(dst, src, bytewidth);
+        dst += dst_linesize;
+        src += src_linesize;
+    }
+}
+
+static void shift_row16_c(uint16_t *dst, const uint16_t *src, int width,
+                          int shift)
+{
+    int i;
+
+    if (shift >= 0) {
+        for (i = 0; i < width; i++)
+            dst[i] = src[i] << shift;
+    } else {
+        for (i = 0; i < width; i++)
+            dst[i] = src[i] >> -shift;
+    }
+}
+
+static void interleave_row8_c(uint8_t *dst, const uint8_t *src0,
+                              const uint8_t *src1, int width)
+{
+    int i;
+
+    for (i = 0; i < width; i++) {
+        dst[2 * i    ] = src0[i];
+        dst[2 * i + 1] = src1[i];
+    }
+}
+
+static void interleave_row16_c(uint16_t *dst, const uint16_t *src0,
+                               const uint16_t *src1, int width, int shift)
+{
+    int i;
+
+    if (shift >= 0) {
+        for (i = 0; i < width; i++) {
+            dst[2 * i    ] = src0[i] << shift;
+            dst[2 * i + 1] = src1[i] << shift;
+        }
+    } else {
+        for (i = 0; i < width; i++) {
+            dst[2 * i    ] = src0[i] >> -shift;
+            dst[2 * i + 1] = src1[i] >> -shift;
+        }
+    }
+}
+
+static void deinterleave_row8_c(uint8_t *dst0, uint8_t *dst1,
+                                const uint8_t *src, int width)
+{
+    int i;
+
+    for (i = 0; i < width; i++) {
+        dst0[i] = src[2 * i    ];
+        dst1[i] = src[2 * i + 1];
+    }
+}
+
+static void deinterleave_row16_c(uint16_t *dst0, uint16_t *dst1,
+                                 const uint16_t *src, int width, int shift)
+{
+    int i;
+
+    if (shift >= 0) {
+        for (i = 0; i < width; i++) {
+            dst0[i] = src[2 * i    ] << shift;
+            dst1[i] = src[2 * i + 1] << shift;
+        }
+    } else {
+        for (i = 0; i < width; i++) {
+            dst0[i] = src[2 * i    ] >> -shift;
+            dst1[i] = src[2 * i + 1] >> -shift;
+        }
+    }
+}
+
+av_cold void ff_imgutils_dsp_init(FFImgUtilsDSPContext *c)
+{
+    c->copy_plane_large   = copy_plane_c;
+    c->shift_row16        = shift_row16_c;
+    c->interleave_row8    = interleave_row8_c;
+    c->interleave_row16   = interleave_row16_c;
+    c->deinterleave_row8  = deinterleave_row8_c;
+    c->deinterleave_row16 = deinterleave_row16_c;
+
+    if (ARCH_X86)
+        ff_imgutils_dsp_init_x86(c);
+}
+
 static void image_copy_plane(uint8_t       *dst, ptrdiff_t dst_linesize,
                              const uint8_t *src, ptrdiff_t src_linesize,
                              ptrdiff_t bytewidth, int height)
@@ -313,11 +409,15 @@ static void image_copy_plane(uint8_t       *dst, ptrdiff_t dst_linesize,
         return;
     av_assert0(FFABS(src_linesize) >= bytewidth);
     av_assert0(FFABS(dst_linesize) >= bytewidth);
-    for (;height > 0; height--) {
-        memcpy(dst, src, bytewidth);
-        dst += dst_linesize;
-        src += src_linesize;
+    if (bytewidth * height >= FF_IMAGE_COPY_LARGE_SIZE) {
+        FFImgUtilsDSPContext c;
+
+        ff_imgutils_dsp_init(&c);
+        c.copy_plane_large(dst, dst_linesize, src, src_linesize,
+                           bytewidth, height);
+        return;
     }
+    copy_plane_c(dst, dst_linesize, src, src_linesize, bytewidth, height);
 }
 
 static void image_copy_plane_uc_from(uint8_t       *dst, ptrdiff_t dst_linesize,
@@ -408,6 +508,165 @@ void av_image_copy_uc_from(uint8_t *dst_data[4], const ptrdiff_t dst_linesizes[4
                width, height, image_copy_plane_uc_from);
 }
 
+/* Images smaller than this are not worth splitting between threads. */
+#define THREADED_COPY_MIN_SIZE (1 << 20)
+
+typedef struct ImageCopyTask {
+    FFImgUtilsDSPContext dsp;
+    uint8_t       *dst[4];
+    const uint8_t *src[4];
+    ptrdiff_t dst_linesize[4];
+    ptrdiff_t src_linesize[4];
+    ptrdiff_t bytewidth[4];
+    int height[4];
+    int nb_planes;
+} ImageCopyTask;
+
+static void copy_job(void *arg, int jobnr, int nb_jobs)
+{
+    ImageCopyTask *t = arg;
+    int i;
+
+    for (i = 0; i < t->nb_planes; i++) {
+        int start = (int64_t)t->height[i] *  jobnr      / nb_jobs;
+        int end   = (int64_t)t->height[i] * (jobnr + 1) / nb_jobs;
+        uint8_t       *dst = t->dst[i] + start * t->dst_linesize[i];
+        const uint8_t *src = t->src[i] + start * t->src_linesize[i];
+
+        if (t->bytewidth[i] * t->height[i] >= FF_IMAGE_COPY_LARGE_SIZE)
+            t->dsp.copy_plane_large(dst, t->dst_linesize[i],
+                                    src, t->src_linesize[i],
+                                    t->bytewidth[i], end - start);
+        else
+            copy_plane_c(dst, t->dst_linesize[i], src, t->src_linesize[i],
+                         t->bytewidth[i], end - start);
+    }
+}
+
+void av_image_copy_threaded(uint8_t *dst_data[4], const ptrdiff_t dst_linesizes[4],
+                            const uint8_t *src_data[4], const ptrdiff_t src_linesizes[4],
+                            enum AVPixelFormat pix_fmt, int width, int height,
+                            av_image_execute_func *execute, void *opaque,
+                            int nb_jobs)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
+    ImageCopyTask t = { { 0 } };
+    int64_t size = 0;
+    int i;
+
+    nb_jobs = FFMIN(nb_jobs, height);
+    if (!desc || !execute || nb_jobs <= 1 ||
+        desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | FF_PSEUDOPAL))
+        goto single_job;
+
+    for (i = 0; i < desc->nb_components; i++)
+        t.nb_planes = FFMAX(t.nb_planes, desc->comp[i].plane + 1);
+    for (i = 0; i < t.nb_planes; i++) {
+        t.bytewidth[i] = av_image_get_linesize(pix_fmt, width, i);
+        t.height[i]    = i == 1 || i == 2 ?
+                         AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+        if (t.bytewidth[i] < 0 || !dst_data[i] || !src_data[i])
+            goto single_job;
+        av_assert0(FFABS(src_linesizes[i]) >= t.bytewidth[i]);
+        av_assert0(FFABS(dst_linesizes[i]) >= t.bytewidth[i]);
+        t.dst[i]          = dst_data[i];
+        t.src[i]          = src_data[i];
+        t.dst_linesize[i] = dst_linesizes[i];
+        t.src_linesize[i] = src_linesizes[i];
+        size += t.bytewidth[i] * t.height[i];
+    }
+    if (size < THREADED_COPY_MIN_SIZE)
+        goto single_job;
+
+    ff_imgutils_dsp_init(&t.dsp);
+    execute(opaque, copy_job, &t, nb_jobs);
+    return;
+
+single_job:
+    image_copy(dst_data, dst_linesizes, src_data, src_linesizes, pix_fmt,
+               width, height, image_copy_plane);
+}
+
+int av_image_copy_plane_shift(uint8_t       *dst, ptrdiff_t dst_linesize,
+                              const uint8_t *src, ptrdiff_t src_linesize,
+                              int width, int height, int shift)
+{
+    FFImgUtilsDSPContext c;
+
+    if (width < 0 || height < 0 || shift < -15 || shift > 15)
+        return AVERROR(EINVAL);
+    if (!shift) {
+        image_copy_plane(dst, dst_linesize, src, src_linesize, 2 * width, height);
+        return 0;
+    }
+
+    ff_imgutils_dsp_init(&c);
+    for (; height > 0; height--) {
+        c.shift_row16((uint16_t *)dst, (const uint16_t *)src, width, shift);
+        dst += dst_linesize;
+        src += src_linesize;
+    }
+    return 0;
+}
+
+static int check_sample_size(int sample_size, int shift)
+{
+    if (sample_size == 1 && !shift ||
+        sample_size == 2 && shift >= -15 && shift <= 15)
+        return 0;
+    return AVERROR(EINVAL);
+}
+
+int av_image_interleave_planes(uint8_t       *dst,  ptrdiff_t dst_linesize,
+                               const uint8_t *src0, ptrdiff_t src0_linesize,
+                               const uint8_t *src1, ptrdiff_t src1_linesize,
+                               int width, int height, int sample_size, int shift)
+{
+    FFImgUtilsDSPContext c;
+    int ret = check_sample_size(sample_size, shift);
+
+    if (ret < 0 || width < 0 || height < 0)
+        return AVERROR(EINVAL);
+
+    ff_imgutils_dsp_init(&c);
+    for (; height > 0; height--) {
+        if (sample_size == 1)
+            c.interleave_row8(dst, src0, src1, width);
+        else
+            c.interleave_row16((uint16_t *)dst, (const uint16_t *)src0,
+                               (const uint16_t *)src1, width, shift);
+        dst  += dst_linesize;
+        src0 += src0_linesize;
+        src1 += src1_linesize;
+    }
+    return 0;
+}
+
+int av_image_deinterleave_plane(uint8_t       *dst0, ptrdiff_t dst0_linesize,
+                                uint8_t       *dst1, ptrdiff_t dst1_linesize,
+                                const uint8_t *src,  ptrdiff_t src_linesize,
+                                int width, int height, int sample_size, int shift)
+{
+    FFImgUtilsDSPContext c;
+    int ret = check_sample_size(sample_size, shift);
+
+    if (ret < 0 || width < 0 || height < 0)
+        return AVERROR(EINVAL);
+
+    ff_imgutils_dsp_init(&c);
+    for (; height > 0; height--) {
+        if (sample_size == 1)
+            c.deinterleave_row8(dst0, dst1, src, width);
+        else
+            c.deinterleave_row16((uint16_t *)dst0, (uint16_t *)dst1,
+                                 (const uint16_t *)src, width, shift);
+        dst0 += dst0_linesize;
+        dst1 += dst1_linesize;
+        src  += src_linesize;
+    }
+    return 0;
+}
+
 int av_image_fill_arrays(uint8_t *dst_data[4], int dst_linesize[4],
                          const uint8_t *src, enum AVPixelFormat pix_fmt,
                          int width, int height, int align)
@@ -138,6 +138,84 @@ void av_image_copy_uc_from(uint8_t *dst_data[4],       const ptrdiff_t dst_lines
                            const uint8_t *src_data[4], const ptrdiff_t src_linesizes[4],
                            enum AVPixelFormat pix_fmt, int width, int height);
 
+/**
+ * A function called for every job of av_image_copy_threaded().
+ */
+typedef void (av_image_job_func)(void *arg, int jobnr, int nb_jobs);
+
+/**
+ * A function running the jobs of av_image_copy_threaded(), e.g. on the
+ * caller's thread pool. It must call func(arg, jobnr, nb_jobs) once for
+ * every jobnr from 0 to nb_jobs - 1, possibly in parallel, and return only
+ * after all the calls have returned.
+ *
+ * @param opaque the opaque pointer passed to av_image_copy_threaded()
+ */
+typedef void (av_image_execute_func)(void *opaque, av_image_job_func *func,
+                                     void *arg, int nb_jobs);
+
+/**
+ * Copy image in src_data to dst_data like av_image_copy(), splitting the
+ * copy of large images into nb_jobs horizontal slices that are run with
+ * execute. Small images and palettized images are copied in the calling
+ * thread without calling execute.
+ *
+ * @param execute function running the jobs, see av_image_execute_func
+ * @param opaque  opaque pointer passed to execute
+ * @param nb_jobs maximum number of jobs, usually the number of threads
+ * @note The linesize parameters have the type ptrdiff_t here, while they are
+ *       int for av_image_copy().
+ */
+void av_image_copy_threaded(uint8_t *dst_data[4],       const ptrdiff_t dst_linesizes[4],
+                            const uint8_t *src_data[4], const ptrdiff_t src_linesizes[4],
+                            enum AVPixelFormat pix_fmt, int width, int height,
+                            av_image_execute_func *execute, void *opaque,
+                            int nb_jobs);
+
+/**
+ * Copy a plane of 16 bit samples, shifting each sample, e.g. to convert
+ * between the MSB aligned samples of P010 and the LSB aligned samples of
+ * YUV420P10.
+ *
+ * @param width number of samples per line
+ * @param shift left shift of the samples if positive, right shift if
+ *              negative, in the range [-15, 15]
+ * @return 0 on success, AVERROR(EINVAL) for invalid parameters
+ */
+int av_image_copy_plane_shift(uint8_t       *dst, ptrdiff_t dst_linesize,
+                              const uint8_t *src, ptrdiff_t src_linesize,
+                              int width, int height, int shift);
+
+/**
+ * Interleave two planes into one, e.g. the U and V planes of YUV420P into
+ * the UV plane of NV12.
+ *
+ * @param width       number of samples per line of each source plane
+ * @param sample_size size of a sample in bytes, 1 or 2
+ * @param shift       left shift of the 16 bit samples if positive, right
+ *                    shift if negative, must be 0 for 8 bit samples
+ * @return 0 on success, AVERROR(EINVAL) for invalid parameters
+ */
+int av_image_interleave_planes(uint8_t       *dst,  ptrdiff_t dst_linesize,
+                               const uint8_t *src0, ptrdiff_t src0_linesize,
+                               const uint8_t *src1, ptrdiff_t src1_linesize,
+                               int width, int height, int sample_size, int shift);
+
+/**
+ * Split an interleaved plane into two, the inverse of
+ * av_image_interleave_planes().
+ *
+ * @param width       number of samples per line of each destination plane
+ * @param sample_size size of a sample in bytes, 1 or 2
+ * @param shift       left shift of the 16 bit samples if positive, right
+ *                    shift if negative, must be 0 for 8 bit samples
+ * @return 0 on success, AVERROR(EINVAL) for invalid parameters
+ */
+int av_image_deinterleave_plane(uint8_t       *dst0, ptrdiff_t dst0_linesize,
+                                uint8_t       *dst1, ptrdiff_t dst1_linesize,
+                                const uint8_t *src,  ptrdiff_t src_linesize,
+                                int width, int height, int sample_size, int shift);
+
 /**
  * Setup the data pointers and linesizes based on the specified image
  * parameters and the provided array.
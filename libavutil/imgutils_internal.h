@@ -26,5 +26,38 @@ int ff_image_copy_plane_uc_from_x86(uint8_t       *dst, ptrdiff_t dst_linesize,
                                     const uint8_t *src, ptrdiff_t src_linesize,
                                     ptrdiff_t bytewidth, int height);
 
+/**
+ * Planes of at least this many bytes are copied with copy_plane_large().
+ */
+#define FF_IMAGE_COPY_LARGE_SIZE (4 << 20)
+
+typedef struct FFImgUtilsDSPContext {
+    /**
+     * Copy a plane that is much larger than the caches. This may use
+     * non-temporal stores, so that the copy does not evict the caches.
+     */
+    void (*copy_plane_large)(uint8_t       *dst, ptrdiff_t dst_linesize,
+                             const uint8_t *src, ptrdiff_t src_linesize,
+                             ptrdiff_t bytewidth, int height);
+
+    /**
+     * The row functions below shift the 16 bit samples left by shift if it
+     * is positive and right by -shift if it is negative, shift is in the
+     * range [-15, 15]. width is the number of samples of each plane.
+     */
+    void (*shift_row16)(uint16_t *dst, const uint16_t *src, int width, int shift);
+    void (*interleave_row8)(uint8_t *dst, const uint8_t *src0,
+                            const uint8_t *src1, int width);
+    void (*interleave_row16)(uint16_t *dst, const uint16_t *src0,
+                             const uint16_t *src1, int width, int shift);
+    void (*deinterleave_row8)(uint8_t *dst0, uint8_t *dst1,
+                              const uint8_t *src, int width);
+    void (*deinterleave_row16)(uint16_t *dst0, uint16_t *dst1,
+                               const uint16_t *src, int width, int shift);
+} FFImgUtilsDSPContext;
+
+void ff_imgutils_dsp_init(FFImgUtilsDSPContext *c);
+void ff_imgutils_dsp_init_x86(FFImgUtilsDSPContext *c);
+
 
 #endif /* AVUTIL_IMGUTILS_INTERNAL_H */
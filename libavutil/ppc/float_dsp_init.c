@@ -28,7 +28,7 @@
 
 av_cold void ff_float_dsp_init_ppc(AVFloatDSPContext *fdsp, int bit_exact)
 {
-    if (PPC_ALTIVEC(av_get_cpu_flags())) {
+    if (PPC_ALTIVEC(av_cpu_get_subsystem_flags("float_dsp"))) {
         fdsp->vector_fmul = ff_vector_fmul_altivec;
         fdsp->vector_fmul_add = ff_vector_fmul_add_altivec;
         fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_altivec;
@@ -40,7 +40,7 @@ av_cold void ff_float_dsp_init_ppc(AVFloatDSPContext *fdsp, int bit_exact)
 
     // The disabled function below are near identical to altivec and have
     // been disabled to reduce code duplication
-    if (PPC_VSX(av_get_cpu_flags())) {
+    if (PPC_VSX(av_cpu_get_subsystem_flags("float_dsp"))) {
 //         fdsp->vector_fmul = ff_vector_fmul_vsx;
         fdsp->vector_fmul_add = ff_vector_fmul_add_vsx;
 //         fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_vsx;
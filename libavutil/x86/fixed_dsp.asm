@@ -22,6 +22,13 @@
 
 %include "x86util.asm"
 
+SECTION_RODATA 64
+; vpermd indices reversing a zmm register, the second half reverses a ymm one
+pd_reverse16: dd 15, 14, 13, 12, 11, 10, 9, 8
+pd_reverse:   dd  7,  6,  5,  4,  3,  2,  1, 0
+pq_round:     dq 0x40000000
+pq_lo:        dq 0xffffffff
+
 SECTION .text
 
 ;-----------------------------------------------------------------------------
@@ -46,3 +53,395 @@ align 16
     add       lenq, mmsize
     jl .loop
     RET
+
+;-----------------------------------------------------------------------------
+; AVX2 and AVX-512 versions, bitexact with the C code. The 32x32->64 bit
+; products of the even and the odd elements are done separately with pmuldq.
+; The rounded products are shifted so that the even results end up in the low
+; and the odd results in the high dwords, which are then blended together.
+; The arrays are indexed from their end with a negative offset, the AVX-512
+; functions use unaligned loads and stores, and lengths that only have to be
+; a multiple of 4 are finished with xmm registers.
+;
+; m15 holds the rounding constant in each qword. There is no vpblendd for
+; zmm, so with AVX-512 m13 selects the low dwords of each qword instead.
+;-----------------------------------------------------------------------------
+
+; %{1}%{2} = the even dwords of %{1}%{2} and the odd ones of %{1}%{3}
+%macro BLEND_ODD 3
+%if cpuflag(avx512)
+    vpternlogd %{1}%{2}, %{1}%{3}, %{1}13, 0xe4
+%else
+    vpblendd   %{1}%{2}, %{1}%{2}, %{1}%{3}, 0xaa
+%endif
+%endmacro
+
+; %{1}%{3} = the dwords of %4 in reverse order, %{1}14 holds the vpermd indices
+%macro REVERSE_DWORDS 4 ; register prefix, block size, dst, src
+%if %2 == 16
+    pshufd     %{1}%{3}, %4, q0123
+%else
+    vpermd     %{1}%{3}, %{1}14, %4
+%endif
+%endmacro
+
+%macro MUL_Q31_INIT 0
+    vpbroadcastq m15, [pq_round]
+%if cpuflag(avx512)
+    vpbroadcastq m13, [pq_lo]
+%endif
+%endmacro
+
+; m%3 = (m%1 * m%2 + (1 << 30)) >> 31, m%1 and m%2 are destroyed
+%macro MUL_Q31 3
+    pmuldq     m%3, m%1, m%2
+    psrlq      m%1, m%1, 32
+    psrlq      m%2, m%2, 32
+    pmuldq     m%1, m%1, m%2
+    paddq      m%3, m%3, m15
+    paddq      m%1, m%1, m15
+    psrlq      m%3, m%3, 31
+    psllq      m%1, m%1, 1
+    BLEND_ODD  m, %3, %1
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_fmul_fixed(int *dst, const int *src0, const int *src1, int len)
+; void vector_fmul_add_fixed(int *dst, const int *src0, const int *src1,
+;                            const int *src2, int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FMUL_FIXED 0
+cglobal vector_fmul_fixed, 4,4,16, dst, src0, src1, len
+    MUL_Q31_INIT
+    shl       lend, 2
+    add       dstq, lenq
+    add      src0q, lenq
+    add      src1q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [src0q + lenq]
+    movu        m1, [src1q + lenq]
+    MUL_Q31      0, 1, 2
+    movu        [dstq + lenq], m2
+    add       lenq, mmsize
+    jl .loop
+    RET
+
+cglobal vector_fmul_add_fixed, 5,5,16, dst, src0, src1, src2, len
+    MUL_Q31_INIT
+    shl       lend, 2
+    add       dstq, lenq
+    add      src0q, lenq
+    add      src1q, lenq
+    add      src2q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [src0q + lenq]
+    movu        m1, [src1q + lenq]
+    MUL_Q31      0, 1, 2
+    paddd       m2, m2, [src2q + lenq]
+    movu        [dstq + lenq], m2
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_fmul_reverse_fixed(int *dst, const int *src0, const int *src1,
+;                                int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FMUL_REVERSE_FIXED 0
+cglobal vector_fmul_reverse_fixed, 4,4,16, dst, src0, src1, len
+    MUL_Q31_INIT
+%if mmsize == 64
+    movu       m14, [pd_reverse16]
+%else
+    movu       m14, [pd_reverse]
+%endif
+    lea       lenq, [lend*4 - mmsize]
+.loop:
+    movu        m0, [src0q + lenq]
+    REVERSE_DWORDS m, mmsize, 1, [src1q]
+    MUL_Q31      0, 1, 2
+    movu        [dstq + lenq], m2
+    add      src1q, mmsize
+    sub       lenq, mmsize
+    jge .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_fmul_window_fixed(int32_t *dst, const int32_t *src0,
+;                               const int32_t *src1, const int32_t *win,
+;                               int len)
+; void vector_fmul_window_scaled_fixed(int16_t *dst, const int32_t *src0,
+;                                      const int32_t *src1, const int32_t *win,
+;                                      int len, uint8_t bits)
+;-----------------------------------------------------------------------------
+
+; The four 64 bit products of one block of %2 bytes, with %{1}0-%{1}15 as
+; registers, like FMUL_WINDOW_BLOCK in float_dsp.asm, but with lenq and len1q
+; counting elements instead of bytes. For the even elements
+; %{1}8 gets s0 * wj - s1 * wi and %{1}9 s0 * wi + s1 * wj, %{1}10 and %{1}11
+; get the same for the odd elements. %{1}15 is added to all of them.
+%macro WINDOW_PRODUCTS 2
+    mov       len1q, lenq
+    neg       len1q
+    REVERSE_DWORDS %1, %2, 1, [src1q + len1q*4]
+    REVERSE_DWORDS %1, %2, 2, [winq  + len1q*4]
+    movu       %{1}0, [src0q + lenq*4 - %2]
+    movu       %{1}3, [winq  + lenq*4 - %2]
+    psrlq      %{1}4, %{1}0, 32
+    psrlq      %{1}5, %{1}1, 32
+    psrlq      %{1}6, %{1}2, 32
+    psrlq      %{1}7, %{1}3, 32
+    pmuldq     %{1}8, %{1}0, %{1}2
+    pmuldq     %{1}9, %{1}1, %{1}3
+    psubq      %{1}8, %{1}8, %{1}9
+    pmuldq     %{1}9, %{1}0, %{1}3
+    pmuldq    %{1}10, %{1}1, %{1}2
+    paddq      %{1}9, %{1}9, %{1}10
+    pmuldq    %{1}10, %{1}4, %{1}6
+    pmuldq    %{1}11, %{1}5, %{1}7
+    psubq     %{1}10, %{1}10, %{1}11
+    pmuldq    %{1}11, %{1}4, %{1}7
+    pmuldq    %{1}12, %{1}5, %{1}6
+    paddq     %{1}11, %{1}11, %{1}12
+    paddq      %{1}8, %{1}8, %{1}15
+    paddq      %{1}9, %{1}9, %{1}15
+    paddq     %{1}10, %{1}10, %{1}15
+    paddq     %{1}11, %{1}11, %{1}15
+%endmacro
+
+%macro WINDOW_FIXED_BLOCK 2
+    WINDOW_PRODUCTS %1, %2
+    psrlq      %{1}8, %{1}8, 31
+    psrlq      %{1}9, %{1}9, 31
+    psllq     %{1}10, %{1}10, 1
+    psllq     %{1}11, %{1}11, 1
+    BLEND_ODD  %1, 8, 10
+    BLEND_ODD  %1, 9, 11
+    REVERSE_DWORDS %1, %2, 9, %{1}9
+    movu       [dstq + lenq*4 - %2], %{1}8
+    movu       [dstq + len1q*4], %{1}9
+%endmacro
+
+; %{1}%{2} >>= 31 + bits, an arithmetic shift of the qwords, with the shift
+; in xm4. AVX2 has no psraq, so the sign is shifted in separately there, with
+; 64 - 31 - bits in xm5, %{1}13 zero and %{1}%{3} as temporary.
+%macro SRA_SCALED 3
+%if cpuflag(avx512)
+    vpsraq  %{1}%{2}, %{1}%{2}, xm4
+%else
+    psrlq   %{1}%{3}, %{1}%{2}, xm4
+    pcmpgtq %{1}%{2}, %{1}13, %{1}%{2}
+    psllq   %{1}%{2}, %{1}%{2}, xm5
+    por     %{1}%{2}, %{1}%{2}, %{1}%{3}
+%endif
+%endmacro
+
+; Like WINDOW_FIXED_BLOCK, but with the results scaled down by bits more and
+; saturated to int16. The rounding for the extra shift is included in %{1}15.
+; Only the low dwords of the shifted qwords are kept, like the conversion to
+; int before av_clip_int16() in the C version.
+%macro WINDOW_SCALED_BLOCK 2
+    WINDOW_PRODUCTS %1, %2
+    movq       xm4, bitsq
+    movq       xm5, tmpq
+    SRA_SCALED %1, 8, 0
+    SRA_SCALED %1, 9, 1
+    SRA_SCALED %1, 10, 2
+    SRA_SCALED %1, 11, 3
+    psllq     %{1}10, %{1}10, 32
+    psllq     %{1}11, %{1}11, 32
+    BLEND_ODD  %1, 8, 10
+    BLEND_ODD  %1, 9, 11
+    REVERSE_DWORDS %1, %2, 9, %{1}9
+%if %2 == 16
+    packssdw   xm8, xm8, xm8
+    packssdw   xm9, xm9, xm9
+    movq       [dstq + lenq*2 - 8], xm8
+    movq       [dstq + len1q*2], xm9
+%elif mmsize == 64
+    vpmovsdw   [dstq + lenq*2 - mmsize/2], m8
+    vpmovsdw   [dstq + len1q*2], m9
+%else
+    vextracti128 xm0, m8, 1
+    vextracti128 xm1, m9, 1
+    packssdw   xm8, xm8, xm0
+    packssdw   xm9, xm9, xm1
+    movu       [dstq + lenq*2 - mmsize/2], xm8
+    movu       [dstq + len1q*2], xm9
+%endif
+%endmacro
+
+; the loop over the blocks %1 of the window functions, from both ends
+%macro WINDOW_LOOP 1
+    add       lenq, mmsize/4
+    jg .tail
+.loop:
+    %1 m, mmsize
+    add       lenq, mmsize/4
+    jle .loop
+.tail:
+    sub       lenq, mmsize/4 - 4
+    jg .end
+.loop4:
+    %1 xm, 16
+    add       lenq, 4
+    jle .loop4
+.end:
+    RET
+%endmacro
+
+%macro LOAD_REVERSE_IDX 0
+%if mmsize == 64
+    movu       m14, [pd_reverse16]
+%else
+    movu       m14, [pd_reverse]
+%endif
+%endmacro
+
+%macro VECTOR_FMUL_WINDOW_FIXED 0
+cglobal vector_fmul_window_fixed, 5,6,16, dst, src0, src1, win, len, len1
+    MUL_Q31_INIT
+    LOAD_REVERSE_IDX
+    movsxd    lenq, lend
+    lea       dstq, [dstq + lenq*4]
+    lea      src0q, [src0q + lenq*4]
+    lea       winq, [winq + lenq*4]
+    neg       lenq
+    WINDOW_LOOP WINDOW_FIXED_BLOCK
+
+cglobal vector_fmul_window_scaled_fixed, 6,8,16, dst, src0, src1, win, len, bits, len1, tmp
+%if cpuflag(avx512)
+    vpbroadcastq m13, [pq_lo]
+%else
+    pxor       m13, m13, m13
+%endif
+    LOAD_REVERSE_IDX
+    ; the rounding of the products and of the extra shift by bits
+    movzx    bitsd, bitsb
+    lea       tmpd, [bitsq + 30]
+    xor      len1d, len1d
+    bts      len1q, tmpq
+    bts      len1q, 30
+    movq      xm15, len1q
+    vpbroadcastq m15, xm15
+    add      bitsd, 31
+    mov       tmpd, 64
+    sub       tmpd, bitsd
+    movsxd    lenq, lend
+    lea       dstq, [dstq + lenq*2]
+    lea      src0q, [src0q + lenq*4]
+    lea       winq, [winq + lenq*4]
+    neg       lenq
+    WINDOW_LOOP WINDOW_SCALED_BLOCK
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void butterflies_fixed(int *av_restrict v1, int *av_restrict v2, int len)
+;-----------------------------------------------------------------------------
+%macro BUTTERFLIES_FIXED 0
+cglobal butterflies_fixed, 3,3,3, src0, src1, len
+    shl       lend, 2
+    add      src0q, lenq
+    add      src1q, lenq
+    neg       lenq
+    add       lenq, mmsize
+    jg .tail
+.loop:
+    movu        m0, [src0q + lenq - mmsize]
+    movu        m1, [src1q + lenq - mmsize]
+    psubd       m2, m0, m1
+    paddd       m0, m0, m1
+    movu        [src1q + lenq - mmsize], m2
+    movu        [src0q + lenq - mmsize], m0
+    add       lenq, mmsize
+    jle .loop
+.tail:
+    sub       lenq, mmsize
+    jge .end
+.loop4:
+    movu       xm0, [src0q + lenq]
+    movu       xm1, [src1q + lenq]
+    psubd      xm2, xm0, xm1
+    paddd      xm0, xm0, xm1
+    movu        [src1q + lenq], xm2
+    movu        [src0q + lenq], xm0
+    add       lenq, 16
+    jl .loop4
+.end:
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; int scalarproduct_fixed(const int *v1, const int *v2, int len)
+;-----------------------------------------------------------------------------
+
+; m0 += the 64 bit products of the dwords of %2 and %3, the sum wraps around
+; like in the C version
+%macro SCALARPRODUCT_FIXED_BLOCK 3 ; register prefix, v1, v2
+    movu       %{1}1, %2
+    movu       %{1}2, %3
+    psrlq      %{1}3, %{1}1, 32
+    psrlq      %{1}4, %{1}2, 32
+    pmuldq     %{1}1, %{1}1, %{1}2
+    pmuldq     %{1}3, %{1}3, %{1}4
+    paddq      %{1}0, %{1}0, %{1}1
+    paddq      %{1}0, %{1}0, %{1}3
+%endmacro
+
+%macro SCALARPRODUCT_FIXED 0
+cglobal scalarproduct_fixed, 3,3,5, v1, v2, offset
+    shl   offsetd, 2
+    add       v1q, offsetq
+    add       v2q, offsetq
+    neg   offsetq
+    pxor        m0, m0, m0
+    add   offsetq, mmsize
+    jg .tail
+.loop:
+    SCALARPRODUCT_FIXED_BLOCK m, [v1q + offsetq - mmsize], [v2q + offsetq - mmsize]
+    add   offsetq, mmsize
+    jle .loop
+.tail:
+%if mmsize == 64
+    vextracti64x4 ym1, m0, 1
+    paddq      ym0, ym0, ym1
+%endif
+    vextracti128 xm1, ym0, 1
+    paddq      xm0, xm0, xm1
+    sub   offsetq, mmsize
+    jge .end
+.loop4:
+    SCALARPRODUCT_FIXED_BLOCK xm, [v1q + offsetq], [v2q + offsetq]
+    add   offsetq, 16
+    jl .loop4
+.end:
+    pshufd     xm1, xm0, q1032
+    paddq      xm0, xm0, xm1
+    movq       rax, xm0
+    add        rax, 0x40000000
+    sar        rax, 31
+    RET
+%endmacro
+
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+VECTOR_FMUL_FIXED
+VECTOR_FMUL_REVERSE_FIXED
+VECTOR_FMUL_WINDOW_FIXED
+BUTTERFLIES_FIXED
+SCALARPRODUCT_FIXED
+%endif
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+VECTOR_FMUL_FIXED
+VECTOR_FMUL_REVERSE_FIXED
+VECTOR_FMUL_WINDOW_FIXED
+BUTTERFLIES_FIXED
+SCALARPRODUCT_FIXED
+%endif
+%endif
@@ -25,11 +25,62 @@
 
 void ff_butterflies_fixed_sse2(int *src0, int *src1, int len);
 
+void ff_vector_fmul_window_scaled_fixed_avx2(int16_t *dst, const int32_t *src0,
+                                             const int32_t *src1,
+                                             const int32_t *win, int len,
+                                             uint8_t bits);
+void ff_vector_fmul_window_fixed_avx2(int32_t *dst, const int32_t *src0,
+                                      const int32_t *src1, const int32_t *win,
+                                      int len);
+void ff_vector_fmul_fixed_avx2(int *dst, const int *src0, const int *src1,
+                               int len);
+void ff_vector_fmul_add_fixed_avx2(int *dst, const int *src0, const int *src1,
+                                   const int *src2, int len);
+void ff_vector_fmul_reverse_fixed_avx2(int *dst, const int *src0,
+                                       const int *src1, int len);
+int ff_scalarproduct_fixed_avx2(const int *v1, const int *v2, int len);
+void ff_butterflies_fixed_avx2(int *src0, int *src1, int len);
+
+void ff_vector_fmul_window_scaled_fixed_avx512(int16_t *dst,
+                                               const int32_t *src0,
+                                               const int32_t *src1,
+                                               const int32_t *win, int len,
+                                               uint8_t bits);
+void ff_vector_fmul_window_fixed_avx512(int32_t *dst, const int32_t *src0,
+                                        const int32_t *src1, const int32_t *win,
+                                        int len);
+void ff_vector_fmul_fixed_avx512(int *dst, const int *src0, const int *src1,
+                                 int len);
+void ff_vector_fmul_add_fixed_avx512(int *dst, const int *src0, const int *src1,
+                                     const int *src2, int len);
+void ff_vector_fmul_reverse_fixed_avx512(int *dst, const int *src0,
+                                         const int *src1, int len);
+int ff_scalarproduct_fixed_avx512(const int *v1, const int *v2, int len);
+void ff_butterflies_fixed_avx512(int *src0, int *src1, int len);
+
 av_cold void ff_fixed_dsp_init_x86(AVFixedDSPContext *fdsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("fixed_dsp");
 
     if (EXTERNAL_SSE2(cpu_flags)) {
         fdsp->butterflies_fixed = ff_butterflies_fixed_sse2;
     }
+    if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(cpu_flags)) {
+        fdsp->vector_fmul_window_scaled = ff_vector_fmul_window_scaled_fixed_avx2;
+        fdsp->vector_fmul_window  = ff_vector_fmul_window_fixed_avx2;
+        fdsp->vector_fmul         = ff_vector_fmul_fixed_avx2;
+        fdsp->vector_fmul_add     = ff_vector_fmul_add_fixed_avx2;
+        fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_fixed_avx2;
+        fdsp->scalarproduct_fixed = ff_scalarproduct_fixed_avx2;
+        fdsp->butterflies_fixed   = ff_butterflies_fixed_avx2;
+    }
+    if (ARCH_X86_64 && EXTERNAL_AVX512(cpu_flags)) {
+        fdsp->vector_fmul_window_scaled = ff_vector_fmul_window_scaled_fixed_avx512;
+        fdsp->vector_fmul_window  = ff_vector_fmul_window_fixed_avx512;
+        fdsp->vector_fmul         = ff_vector_fmul_fixed_avx512;
+        fdsp->vector_fmul_add     = ff_vector_fmul_add_fixed_avx512;
+        fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_fixed_avx512;
+        fdsp->scalarproduct_fixed = ff_scalarproduct_fixed_avx512;
+        fdsp->butterflies_fixed   = ff_butterflies_fixed_avx512;
+    }
 }
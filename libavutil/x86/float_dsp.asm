@@ -22,8 +22,10 @@
 
 %include "x86util.asm"
 
-SECTION_RODATA 32
-pd_reverse: dd 7, 6, 5, 4, 3, 2, 1, 0
+SECTION_RODATA 64
+; vpermps indices reversing a zmm register, the second half reverses a ymm one
+pd_reverse16: dd 15, 14, 13, 12, 11, 10, 9, 8
+pd_reverse:   dd  7,  6,  5,  4,  3,  2,  1, 0
 
 SECTION .text
 
@@ -482,3 +484,357 @@ cglobal butterflies_float, 3,3,3, src0, src1, len
     add       lenq, mmsize
     jl .loop
     REP_RET
+;-----------------------------------------------------------------------------
+; AVX2, FMA3 and AVX-512 versions of the functions that have no full width
+; version above. The AVX-512 functions use unaligned loads and stores, as the
+; arrays are only guaranteed to be 32 byte aligned, and the functions whose
+; length only has to be a multiple of 4 do the remaining elements with xmm
+; registers. The arrays are indexed from their end with a negative offset.
+;-----------------------------------------------------------------------------
+
+; broadcast the float or double argument, which is in xmm2 on WIN64
+%macro BROADCAST_MUL 2 ; dst, ss/sd
+%if WIN64
+    vbroadcast%2 %1, xmm2
+%else
+    vbroadcast%2 %1, xmm0
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_fmul(float *dst, const float *src0, const float *src1, int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FMUL_U 0
+cglobal vector_fmul, 4,4,1, dst, src0, src1, len
+    shl       lend, 2
+    add       dstq, lenq
+    add      src0q, lenq
+    add      src1q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [src0q + lenq]
+    mulps       m0, m0, [src1q + lenq]
+    movu        [dstq + lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_dmul(double *dst, const double *src0, const double *src1, int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_DMUL_U 0
+cglobal vector_dmul, 4,4,1, dst, src0, src1, len
+    shl       lend, 3
+    add       dstq, lenq
+    add      src0q, lenq
+    add      src1q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [src0q + lenq]
+    mulpd       m0, m0, [src1q + lenq]
+    movu        [dstq + lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_vector_fmac_scalar(float *dst, const float *src, float mul, int len)
+; void ff_vector_dmac_scalar(double *dst, const double *src, double mul,
+;                            int len)
+;------------------------------------------------------------------------------
+%macro VECTOR_MAC_SCALAR_U 1 ; f/d
+%if UNIX64
+cglobal vector_%1mac_scalar, 3,3,2, dst, src, len
+%else
+cglobal vector_%1mac_scalar, 4,4,2, dst, src, mul, len
+%endif
+%ifidn %1, f
+    BROADCAST_MUL m1, ss
+    shl       lend, 2
+%else
+    BROADCAST_MUL m1, sd
+    shl       lend, 3
+%endif
+    add       dstq, lenq
+    add       srcq, lenq
+    neg       lenq
+.loop:
+    movu        m0, [srcq + lenq]
+%ifidn %1, f
+    fmaddps     m0, m0, m1, [dstq + lenq]
+%else
+    fmaddpd     m0, m0, m1, [dstq + lenq]
+%endif
+    movu        [dstq + lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_vector_fmul_scalar(float *dst, const float *src, float mul, int len)
+;------------------------------------------------------------------------------
+%macro VECTOR_FMUL_SCALAR_U 0
+%if UNIX64
+cglobal vector_fmul_scalar, 3,3,2, dst, src, len
+%else
+cglobal vector_fmul_scalar, 4,4,2, dst, src, mul, len
+%endif
+    BROADCAST_MUL m1, ss
+    shl       lend, 2
+    add       dstq, lenq
+    add       srcq, lenq
+    neg       lenq
+    add       lenq, mmsize
+    jg .tail
+.loop:
+    mulps       m0, m1, [srcq + lenq - mmsize]
+    movu        [dstq + lenq - mmsize], m0
+    add       lenq, mmsize
+    jle .loop
+.tail:
+    sub       lenq, mmsize
+    jge .end
+.loop4:
+    mulps      xm0, xm1, [srcq + lenq]
+    movu        [dstq + lenq], xm0
+    add       lenq, 16
+    jl .loop4
+.end:
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_vector_dmul_scalar(double *dst, const double *src, double mul,
+;                            int len)
+;------------------------------------------------------------------------------
+%macro VECTOR_DMUL_SCALAR_U 0
+%if UNIX64
+cglobal vector_dmul_scalar, 3,3,2, dst, src, len
+%else
+cglobal vector_dmul_scalar, 4,4,2, dst, src, mul, len
+%endif
+    BROADCAST_MUL m1, sd
+    shl       lend, 3
+    add       dstq, lenq
+    add       srcq, lenq
+    neg       lenq
+.loop:
+    mulpd       m0, m1, [srcq + lenq]
+    movu        [dstq + lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; vector_fmul_window(float *dst, const float *src0,
+;                    const float *src1, const float *win, int len);
+;-----------------------------------------------------------------------------
+
+; One block of %1 bytes, with %{2}0-%{2}7 as registers. The src0 and win[i]
+; elements are read forwards, the src1 and win[j] elements backwards. lenq is
+; the offset past the block, len1q = -lenq the offset of the mirrored block.
+; %{2}7 holds the vpermps indices for full registers.
+%macro FMUL_WINDOW_BLOCK 2
+    mov       len1q, lenq
+    neg       len1q
+%if %1 == 16
+    pshufd     %{2}1, [src1q + len1q], q0123
+    pshufd     %{2}2, [winq  + len1q], q0123
+%else
+    vpermps    %{2}1, %{2}7, [src1q + len1q]
+    vpermps    %{2}2, %{2}7, [winq  + len1q]
+%endif
+    movu       %{2}0, [src0q + lenq - %1]
+    movu       %{2}3, [winq  + lenq - %1]
+    mulps      %{2}4, %{2}0, %{2}2
+    mulps      %{2}5, %{2}0, %{2}3
+    mulps      %{2}6, %{2}1, %{2}3
+    subps      %{2}4, %{2}4, %{2}6
+    mulps      %{2}6, %{2}1, %{2}2
+    addps      %{2}5, %{2}5, %{2}6
+%if %1 == 16
+    pshufd     %{2}5, %{2}5, q0123
+%else
+    vpermps    %{2}5, %{2}7, %{2}5
+%endif
+    movu       [dstq + lenq - %1], %{2}4
+    movu       [dstq + len1q], %{2}5
+%endmacro
+
+%macro VECTOR_FMUL_WINDOW_U 0
+cglobal vector_fmul_window, 5, 6, 8, dst, src0, src1, win, len, len1
+%if mmsize == 64
+    movu        m7, [pd_reverse16]
+%else
+    movu        m7, [pd_reverse]
+%endif
+    shl       lend, 2
+    add       dstq, lenq
+    add      src0q, lenq
+    add       winq, lenq
+    neg       lenq
+    add       lenq, mmsize
+    jg .tail
+.loop:
+    FMUL_WINDOW_BLOCK mmsize, m
+    add       lenq, mmsize
+    jle .loop
+.tail:
+    sub       lenq, mmsize - 16
+    jg .end
+.loop4:
+    FMUL_WINDOW_BLOCK 16, xm
+    add       lenq, 16
+    jle .loop4
+.end:
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; vector_fmul_add(float *dst, const float *src0, const float *src1,
+;                 const float *src2, int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FMUL_ADD_U 0
+cglobal vector_fmul_add, 5,5,2, dst, src0, src1, src2, len
+    shl       lend, 2
+    add       dstq, lenq
+    add      src0q, lenq
+    add      src1q, lenq
+    add      src2q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [src0q + lenq]
+    movu        m1, [src1q + lenq]
+    fmaddps     m0, m0, m1, [src2q + lenq]
+    movu        [dstq + lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vector_fmul_reverse(float *dst, const float *src0, const float *src1,
+;                          int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FMUL_REVERSE_U 0
+cglobal vector_fmul_reverse, 4,4,2, dst, src0, src1, len
+    movu        m1, [pd_reverse16]
+    lea       lenq, [lend*4 - mmsize]
+.loop:
+    vpermps     m0, m1, [src1q]
+    mulps       m0, m0, [src0q + lenq]
+    movu        [dstq + lenq], m0
+    add      src1q, mmsize
+    sub       lenq, mmsize
+    jge .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_butterflies_float(float *src0, float *src1, int len);
+;-----------------------------------------------------------------------------
+%macro BUTTERFLIES_FLOAT_U 0
+cglobal butterflies_float, 3,3,3, src0, src1, len
+    shl       lend, 2
+    add      src0q, lenq
+    add      src1q, lenq
+    neg       lenq
+    add       lenq, mmsize
+    jg .tail
+.loop:
+    movu        m0, [src0q + lenq - mmsize]
+    movu        m1, [src1q + lenq - mmsize]
+    subps       m2, m0, m1
+    addps       m0, m0, m1
+    movu        [src1q + lenq - mmsize], m2
+    movu        [src0q + lenq - mmsize], m0
+    add       lenq, mmsize
+    jle .loop
+.tail:
+    sub       lenq, mmsize
+    jge .end
+.loop4:
+    movu       xm0, [src0q + lenq]
+    movu       xm1, [src1q + lenq]
+    subps      xm2, xm0, xm1
+    addps      xm0, xm0, xm1
+    movu        [src1q + lenq], xm2
+    movu        [src0q + lenq], xm0
+    add       lenq, 16
+    jl .loop4
+.end:
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; float scalarproduct_float(const float *v1, const float *v2, int len)
+;-----------------------------------------------------------------------------
+%macro SCALARPRODUCT_FLOAT_U 0
+cglobal scalarproduct_float, 3,3,2, v1, v2, offset
+    shl   offsetd, 2
+    add       v1q, offsetq
+    add       v2q, offsetq
+    neg   offsetq
+    xorps      m0, m0, m0
+    add   offsetq, mmsize
+    jg .tail
+.loop:
+    movu        m1, [v1q + offsetq - mmsize]
+    fmaddps     m0, m1, [v2q + offsetq - mmsize], m0
+    add   offsetq, mmsize
+    jle .loop
+.tail:
+%if mmsize == 64
+    vextractf64x4 ym1, m0, 1
+    addps      ym0, ym0, ym1
+%endif
+    vextractf128 xm1, ym0, 1
+    addps      xm0, xm0, xm1
+    sub   offsetq, mmsize
+    jge .end
+.loop4:
+    movu       xm1, [v1q + offsetq]
+    fmaddps    xm0, xm1, [v2q + offsetq], xm0
+    add   offsetq, 16
+    jl .loop4
+.end:
+    movhlps    xm1, xm0
+    addps      xm0, xm0, xm1
+    movshdup   xm1, xm0
+    addss      xm0, xm0, xm1
+%if cpuflag(avx512)
+    movaps    xmm0, xm0
+%endif
+    RET
+%endmacro
+
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+VECTOR_FMUL_SCALAR_U
+VECTOR_FMUL_WINDOW_U
+BUTTERFLIES_FLOAT_U
+%endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+SCALARPRODUCT_FLOAT_U
+%endif
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+VECTOR_FMUL_U
+VECTOR_DMUL_U
+VECTOR_MAC_SCALAR_U f
+VECTOR_MAC_SCALAR_U d
+VECTOR_FMUL_SCALAR_U
+VECTOR_DMUL_SCALAR_U
+VECTOR_FMUL_WINDOW_U
+VECTOR_FMUL_ADD_U
+VECTOR_FMUL_REVERSE_U
+BUTTERFLIES_FLOAT_U
+SCALARPRODUCT_FLOAT_U
+%endif
+%endif
@@ -28,11 +28,15 @@ void ff_vector_fmul_sse(float *dst, const float *src0, const float *src1,
                         int len);
 void ff_vector_fmul_avx(float *dst, const float *src0, const float *src1,
                         int len);
+void ff_vector_fmul_avx512(float *dst, const float *src0, const float *src1,
+                           int len);
 
 void ff_vector_dmul_sse2(double *dst, const double *src0, const double *src1,
                          int len);
 void ff_vector_dmul_avx(double *dst, const double *src0, const double *src1,
                         int len);
+void ff_vector_dmul_avx512(double *dst, const double *src0, const double *src1,
+                           int len);
 
 void ff_vector_fmac_scalar_sse(float *dst, const float *src, float mul,
                                int len);
@@ -40,9 +44,15 @@ void ff_vector_fmac_scalar_avx(float *dst, const float *src, float mul,
                                int len);
 void ff_vector_fmac_scalar_fma3(float *dst, const float *src, float mul,
                                 int len);
+void ff_vector_fmac_scalar_avx512(float *dst, const float *src, float mul,
+                                  int len);
 
 void ff_vector_fmul_scalar_sse(float *dst, const float *src, float mul,
                                int len);
+void ff_vector_fmul_scalar_avx2(float *dst, const float *src, float mul,
+                                int len);
+void ff_vector_fmul_scalar_avx512(float *dst, const float *src, float mul,
+                                  int len);
 
 void ff_vector_dmac_scalar_sse2(double *dst, const double *src, double mul,
                                 int len);
@@ -50,16 +60,24 @@ void ff_vector_dmac_scalar_avx(double *dst, const double *src, double mul,
                                int len);
 void ff_vector_dmac_scalar_fma3(double *dst, const double *src, double mul,
                                 int len);
+void ff_vector_dmac_scalar_avx512(double *dst, const double *src, double mul,
+                                  int len);
 
 void ff_vector_dmul_scalar_sse2(double *dst, const double *src,
                                 double mul, int len);
 void ff_vector_dmul_scalar_avx(double *dst, const double *src,
                                double mul, int len);
+void ff_vector_dmul_scalar_avx512(double *dst, const double *src,
+                                  double mul, int len);
 
 void ff_vector_fmul_window_3dnowext(float *dst, const float *src0,
                                     const float *src1, const float *win, int len);
 void ff_vector_fmul_window_sse(float *dst, const float *src0,
                                const float *src1, const float *win, int len);
+void ff_vector_fmul_window_avx2(float *dst, const float *src0,
+                                const float *src1, const float *win, int len);
+void ff_vector_fmul_window_avx512(float *dst, const float *src0,
+                                  const float *src1, const float *win, int len);
 
 void ff_vector_fmul_add_sse(float *dst, const float *src0, const float *src1,
                             const float *src2, int len);
@@ -67,6 +85,8 @@ void ff_vector_fmul_add_avx(float *dst, const float *src0, const float *src1,
                             const float *src2, int len);
 void ff_vector_fmul_add_fma3(float *dst, const float *src0, const float *src1,
                              const float *src2, int len);
+void ff_vector_fmul_add_avx512(float *dst, const float *src0, const float *src1,
+                               const float *src2, int len);
 
 void ff_vector_fmul_reverse_sse(float *dst, const float *src0,
                                 const float *src1, int len);
@@ -74,14 +94,20 @@ void ff_vector_fmul_reverse_avx(float *dst, const float *src0,
                                 const float *src1, int len);
 void ff_vector_fmul_reverse_avx2(float *dst, const float *src0,
                                  const float *src1, int len);
+void ff_vector_fmul_reverse_avx512(float *dst, const float *src0,
+                                   const float *src1, int len);
 
 float ff_scalarproduct_float_sse(const float *v1, const float *v2, int order);
+float ff_scalarproduct_float_fma3(const float *v1, const float *v2, int order);
+float ff_scalarproduct_float_avx512(const float *v1, const float *v2, int order);
 
 void ff_butterflies_float_sse(float *av_restrict src0, float *av_restrict src1, int len);
+void ff_butterflies_float_avx2(float *av_restrict src0, float *av_restrict src1, int len);
+void ff_butterflies_float_avx512(float *av_restrict src0, float *av_restrict src1, int len);
 
 av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("float_dsp");
 
     if (EXTERNAL_AMD3DNOWEXT(cpu_flags)) {
         fdsp->vector_fmul_window = ff_vector_fmul_window_3dnowext;
@@ -118,4 +144,25 @@ av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp)
         fdsp->vector_fmul_add    = ff_vector_fmul_add_fma3;
         fdsp->vector_dmac_scalar = ff_vector_dmac_scalar_fma3;
     }
+    if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(cpu_flags)) {
+        fdsp->vector_fmul_scalar  = ff_vector_fmul_scalar_avx2;
+        fdsp->vector_fmul_window  = ff_vector_fmul_window_avx2;
+        fdsp->butterflies_float   = ff_butterflies_float_avx2;
+    }
+    if (ARCH_X86_64 && EXTERNAL_FMA3_FAST(cpu_flags)) {
+        fdsp->scalarproduct_float = ff_scalarproduct_float_fma3;
+    }
+    if (ARCH_X86_64 && EXTERNAL_AVX512(cpu_flags)) {
+        fdsp->vector_fmul         = ff_vector_fmul_avx512;
+        fdsp->vector_dmul         = ff_vector_dmul_avx512;
+        fdsp->vector_fmac_scalar  = ff_vector_fmac_scalar_avx512;
+        fdsp->vector_dmac_scalar  = ff_vector_dmac_scalar_avx512;
+        fdsp->vector_fmul_scalar  = ff_vector_fmul_scalar_avx512;
+        fdsp->vector_dmul_scalar  = ff_vector_dmul_scalar_avx512;
+        fdsp->vector_fmul_window  = ff_vector_fmul_window_avx512;
+        fdsp->vector_fmul_add     = ff_vector_fmul_add_avx512;
+        fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_avx512;
+        fdsp->butterflies_float   = ff_butterflies_float_avx512;
+        fdsp->scalarproduct_float = ff_scalarproduct_float_avx512;
+    }
 }
@@ -51,3 +51,204 @@ cglobal image_copy_plane_uc_from, 6, 7, 4, dst, dst_linesize, src, src_linesize,
     jnz .row_start
 
     RET
+
+;------------------------------------------------------------------------------
+; void ff_image_copy_plane_nt_sse2(uint8_t *dst, ptrdiff_t dst_linesize,
+;                                  const uint8_t *src, ptrdiff_t src_linesize,
+;                                  ptrdiff_t bytewidth, int height);
+;
+; bytewidth is at least 64. The 64 byte blocks of each line starting at the
+; first aligned destination byte are copied with non-temporal stores, the
+; unaligned start and the rest of the line with ordinary overlapping stores.
+;------------------------------------------------------------------------------
+INIT_XMM sse2
+%if ARCH_X86_64
+cglobal image_copy_plane_nt, 6, 8, 4, dst, dst_linesize, src, src_linesize, bw, height, i, end
+%else
+cglobal image_copy_plane_nt, 5, 7, 4, dst, dst_linesize, src, src_linesize, bw, i, end
+%define heightd r5mp
+%endif
+.row:
+    movu            m0, [srcq]
+    movu        [dstq], m0
+    mov             iq, dstq
+    neg             iq
+    and             iq, 15
+    mov           endq, bwq
+    sub           endq, iq
+    and           endq, -64
+    add           endq, iq
+    cmp             iq, endq
+    jge .tail
+.loop:
+    movu            m0, [srcq+iq   ]
+    movu            m1, [srcq+iq+16]
+    movu            m2, [srcq+iq+32]
+    movu            m3, [srcq+iq+48]
+    movntdq [dstq+iq   ], m0
+    movntdq [dstq+iq+16], m1
+    movntdq [dstq+iq+32], m2
+    movntdq [dstq+iq+48], m3
+    add             iq, 64
+    cmp             iq, endq
+    jl .loop
+.tail:
+    movu            m0, [srcq+bwq-64]
+    movu            m1, [srcq+bwq-48]
+    movu            m2, [srcq+bwq-32]
+    movu            m3, [srcq+bwq-16]
+    movu [dstq+bwq-64], m0
+    movu [dstq+bwq-48], m1
+    movu [dstq+bwq-32], m2
+    movu [dstq+bwq-16], m3
+    add           dstq, dst_linesizeq
+    add           srcq, src_linesizeq
+    dec        heightd
+    jg .row
+    ; order the non-temporal stores before any later store
+    sfence
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_shift_row16_avx2(uint16_t *dst, const uint16_t *src, int width,
+;                          int shift);
+; void ff_interleave_row8_avx2(uint8_t *dst, const uint8_t *src0,
+;                              const uint8_t *src1, int width);
+; void ff_interleave_row16_avx2(uint16_t *dst, const uint16_t *src0,
+;                               const uint16_t *src1, int width, int shift);
+; void ff_deinterleave_row8_avx2(uint8_t *dst0, uint8_t *dst1,
+;                                const uint8_t *src, int width);
+; void ff_deinterleave_row16_avx2(uint16_t *dst0, uint16_t *dst1,
+;                                 const uint16_t *src, int width, int shift);
+;
+; width is a multiple of 16 for the 16 bit and of 32 for the 8 bit functions.
+; The samples are shifted left by shift if it is positive and right by -shift
+; otherwise.
+;------------------------------------------------------------------------------
+
+; load the left shift count to xm4 and the right one to xm5, m%1 is zeroed
+%macro SHIFT_COUNTS 2 ; tmp, shift
+    movd           xm4, %2
+    pxor           m%1, m%1
+    psubd          xm5, xm%1, xm4
+    pmaxsd         xm4, xm%1
+    pmaxsd         xm5, xm%1
+%endmacro
+
+%macro SHIFT_ROW16 1-*
+%rep %0
+    psllw           %1, xm4
+    psrlw           %1, xm5
+%rotate 1
+%endrep
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal shift_row16, 4, 4, 6, dst, src, w, shift
+    SHIFT_COUNTS     0, shiftd
+    movsxdifnidn    wq, wd
+    lea           srcq, [srcq+wq*2]
+    lea           dstq, [dstq+wq*2]
+    neg             wq
+.loop:
+    movu            m0, [srcq+wq*2]
+    SHIFT_ROW16     m0
+    movu [dstq+wq*2], m0
+    add             wq, mmsize/2
+    jl .loop
+    RET
+
+cglobal interleave_row8, 4, 4, 3, dst, src0, src1, w
+    movsxdifnidn    wq, wd
+    add          src0q, wq
+    add          src1q, wq
+    lea           dstq, [dstq+wq*2]
+    neg             wq
+.loop:
+    movu            m0, [src0q+wq]
+    movu            m1, [src1q+wq]
+    punpckhbw       m2, m0, m1
+    punpcklbw       m0, m1
+    vperm2i128      m1, m0, m2, 0x31
+    vinserti128     m0, m0, xm2, 1
+    movu [dstq+wq*2       ], m0
+    movu [dstq+wq*2+mmsize], m1
+    add             wq, mmsize
+    jl .loop
+    RET
+
+cglobal interleave_row16, 5, 5, 6, dst, src0, src1, w, shift
+    SHIFT_COUNTS     3, shiftd
+    movsxdifnidn    wq, wd
+    lea          src0q, [src0q+wq*2]
+    lea          src1q, [src1q+wq*2]
+    lea           dstq, [dstq+wq*4]
+    neg             wq
+.loop:
+    movu            m0, [src0q+wq*2]
+    movu            m1, [src1q+wq*2]
+    SHIFT_ROW16     m0, m1
+    punpckhwd       m2, m0, m1
+    punpcklwd       m0, m1
+    vperm2i128      m1, m0, m2, 0x31
+    vinserti128     m0, m0, xm2, 1
+    movu [dstq+wq*4       ], m0
+    movu [dstq+wq*4+mmsize], m1
+    add             wq, mmsize/2
+    jl .loop
+    RET
+
+; The even samples are masked, the odd ones shifted down, and both are
+; packed. The packs work within the 128 bit lanes, so the qwords are
+; reordered afterwards.
+cglobal deinterleave_row8, 4, 4, 5, dst0, dst1, src, w
+    movsxdifnidn    wq, wd
+    add          dst0q, wq
+    add          dst1q, wq
+    lea           srcq, [srcq+wq*2]
+    neg             wq
+    pcmpeqw         m4, m4
+    psrlw           m4, 8
+.loop:
+    movu            m0, [srcq+wq*2       ]
+    movu            m1, [srcq+wq*2+mmsize]
+    psrlw           m2, m0, 8
+    psrlw           m3, m1, 8
+    pand            m0, m4
+    pand            m1, m4
+    packuswb        m0, m1
+    packuswb        m2, m3
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+    movu  [dst0q+wq], m0
+    movu  [dst1q+wq], m2
+    add             wq, mmsize
+    jl .loop
+    RET
+
+cglobal deinterleave_row16, 5, 5, 7, dst0, dst1, src, w, shift
+    SHIFT_COUNTS     6, shiftd
+    movsxdifnidn    wq, wd
+    lea          dst0q, [dst0q+wq*2]
+    lea          dst1q, [dst1q+wq*2]
+    lea           srcq, [srcq+wq*4]
+    neg             wq
+.loop:
+    movu            m0, [srcq+wq*4       ]
+    movu            m1, [srcq+wq*4+mmsize]
+    SHIFT_ROW16     m0, m1
+    psrld           m2, m0, 16
+    psrld           m3, m1, 16
+    pblendw         m0, m6, 0xaa
+    pblendw         m1, m6, 0xaa
+    packusdw        m0, m1
+    packusdw        m2, m3
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+    movu [dst0q+wq*2], m0
+    movu [dst1q+wq*2], m2
+    add             wq, mmsize/2
+    jl .loop
+    RET
+%endif
@@ -18,7 +18,12 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/error.h"
 #include "libavutil/imgutils.h"
@@ -47,3 +52,118 @@ int ff_image_copy_plane_uc_from_x86(uint8_t       *dst, ptrdiff_t dst_linesize,
 
     return 0;
 }
+
+void ff_image_copy_plane_nt_sse2(uint8_t *dst, ptrdiff_t dst_linesize,
+                                 const uint8_t *src, ptrdiff_t src_linesize,
+                                 ptrdiff_t bytewidth, int height);
+
+void ff_shift_row16_avx2(uint16_t *dst, const uint16_t *src, int width,
+                         int shift);
+void ff_interleave_row8_avx2(uint8_t *dst, const uint8_t *src0,
+                             const uint8_t *src1, int width);
+void ff_interleave_row16_avx2(uint16_t *dst, const uint16_t *src0,
+                              const uint16_t *src1, int width, int shift);
+void ff_deinterleave_row8_avx2(uint8_t *dst0, uint8_t *dst1,
+                               const uint8_t *src, int width);
+void ff_deinterleave_row16_avx2(uint16_t *dst0, uint16_t *dst1,
+                                const uint16_t *src, int width, int shift);
+
+static void copy_plane_large_sse2(uint8_t       *dst, ptrdiff_t dst_linesize,
+                                  const uint8_t *src, ptrdiff_t src_linesize,
+                                  ptrdiff_t bytewidth, int height)
+{
+    if (bytewidth >= 64) {
+        ff_image_copy_plane_nt_sse2(dst, dst_linesize, src, src_linesize,
+                                    bytewidth, height);
+        return;
+    }
+    for (; height > 0; height--) {
+        memcpy(dst, src, bytewidth);
+        dst += dst_linesize;
+        src += src_linesize;
+    }
+}
+
+/* The AVX2 row functions handle blocks of 16 or 32 samples and leave the
+ * rest of the line to C. */
+
+static void shift_row16_avx2(uint16_t *dst, const uint16_t *src, int width,
+                             int shift)
+{
+    int lsh = FFMAX(shift, 0), rsh = FFMAX(-shift, 0);
+    int i, n = width & ~15;
+
+    if (n)
+        ff_shift_row16_avx2(dst, src, n, shift);
+    for (i = n; i < width; i++)
+        dst[i] = (uint16_t)(src[i] << lsh) >> rsh;
+}
+
+static void interleave_row8_avx2(uint8_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, int width)
+{
+    int i, n = width & ~31;
+
+    if (n)
+        ff_interleave_row8_avx2(dst, src0, src1, n);
+    for (i = n; i < width; i++) {
+        dst[2 * i    ] = src0[i];
+        dst[2 * i + 1] = src1[i];
+    }
+}
+
+static void interleave_row16_avx2(uint16_t *dst, const uint16_t *src0,
+                                  const uint16_t *src1, int width, int shift)
+{
+    int lsh = FFMAX(shift, 0), rsh = FFMAX(-shift, 0);
+    int i, n = width & ~15;
+
+    if (n)
+        ff_interleave_row16_avx2(dst, src0, src1, n, shift);
+    for (i = n; i < width; i++) {
+        dst[2 * i    ] = (uint16_t)(src0[i] << lsh) >> rsh;
+        dst[2 * i + 1] = (uint16_t)(src1[i] << lsh) >> rsh;
+    }
+}
+
+static void deinterleave_row8_avx2(uint8_t *dst0, uint8_t *dst1,
+                                   const uint8_t *src, int width)
+{
+    int i, n = width & ~31;
+
+    if (n)
+        ff_deinterleave_row8_avx2(dst0, dst1, src, n);
+    for (i = n; i < width; i++) {
+        dst0[i] = src[2 * i    ];
+        dst1[i] = src[2 * i + 1];
+    }
+}
+
+static void deinterleave_row16_avx2(uint16_t *dst0, uint16_t *dst1,
+                                    const uint16_t *src, int width, int shift)
+{
+    int lsh = FFMAX(shift, 0), rsh = FFMAX(-shift, 0);
+    int i, n = width & ~15;
+
+    if (n)
+        ff_deinterleave_row16_avx2(dst0, dst1, src, n, shift);
+    for (i = n; i < width; i++) {
+        dst0[i] = (uint16_t)(src[2 * i    ] << lsh) >> rsh;
+        dst1[i] = (uint16_t)(src[2 * i + 1] << lsh) >> rsh;
+    }
+}
+
+av_cold void ff_imgutils_dsp_init_x86(FFImgUtilsDSPContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        c->copy_plane_large = copy_plane_large_sse2;
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        c->shift_row16        = shift_row16_avx2;
+        c->interleave_row8    = interleave_row8_avx2;
+        c->interleave_row16   = interleave_row16_avx2;
+        c->deinterleave_row8  = deinterleave_row8_avx2;
+        c->deinterleave_row16 = deinterleave_row16_avx2;
+    }
+}
@@ -50,7 +50,7 @@ av_cold void swri_audio_convert_init_aarch64(struct AudioConvert *ac,
                                        enum AVSampleFormat in_fmt,
                                        int channels)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swresample");
 
     ac->simd_f= NULL;
 
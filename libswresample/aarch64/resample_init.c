@@ -104,7 +104,7 @@ DECLARE_RESAMPLE_COMMON_TEMPLATE(s16, int16_t, int16_t, int32_t, OUT)
 
 av_cold void swri_resample_dsp_aarch64_init(ResampleContext *c)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swresample");
 
     if (!have_neon(cpu_flags))
         return;
@@ -41,6 +41,17 @@
 #include "rematrix_template.c"
 #undef TEMPLATE_REMATRIX_S32
 
+static void mix_n_1_s16(void *out, const void **in, const int32_t *coeffp, integer nb_in, integer len){
+    int i, j;
+
+    for(i=0; i<len; i++){
+        int v=0;
+        for(j=0; j<nb_in; j++)
+            v+= ((const int16_t*)in[j])[i] * coeffp[j];
+        ((int16_t*)out)[i]= (v + 16384)>>15;
+    }
+}
+
 #define FRONT_LEFT             0
 #define FRONT_RIGHT            1
 #define FRONT_CENTER           2
@@ -388,6 +399,8 @@ av_cold int swri_rematrix_init(SwrContext *s){
     int nb_out = s->out.ch_count;
 
     s->mix_any_f = NULL;
+    s->mix_n_1_f = NULL;
+    s->mix_n_1_simd = NULL;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -413,6 +426,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
             maxsum = FFMAX(maxsum, sum);
         }
         *((int*)s->native_one) = 32768;
+        s->mix_n_1_f = mix_n_1_s16;
         if (maxsum <= 32768) {
             s->mix_1_1_f = (mix_1_1_func_type*)copy_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_s16;
@@ -494,83 +508,117 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_simd_one);
 }
 
+typedef struct RematrixThreadArg {
+    SwrContext *s;
+    AudioData *out, *in;
+    int len, len1, off, mustcopy;
+} RematrixThreadArg;
+
+static void rematrix_channel(void *arg, int out_i)
+{
+    RematrixThreadArg *t = arg;
+    SwrContext *s = t->s;
+    AudioData *out = t->out, *in = t->in;
+    int len = t->len, len1 = t->len1, off = t->off;
+    int in_i, i, j;
+
+    switch(s->matrix_ch[out_i][0]){
+    case 0:
+        if(t->mustcopy)
+            memset(out->ch[out_i], 0, len * av_get_bytes_per_sample(s->int_sample_fmt));
+        break;
+    case 1:
+        in_i= s->matrix_ch[out_i][1];
+        if(s->matrix[out_i][in_i]!=1.0){
+            if(s->mix_1_1_simd && len1)
+                s->mix_1_1_simd(out->ch[out_i]    , in->ch[in_i]    , s->native_simd_matrix, in->ch_count*out_i + in_i, len1);
+            else
+                s->mix_1_1_f   (out->ch[out_i]    , in->ch[in_i]    , s->native_matrix, in->ch_count*out_i + in_i, len1);
+            if(len != len1)
+                s->mix_1_1_f   (out->ch[out_i]+off, in->ch[in_i]+off, s->native_matrix, in->ch_count*out_i + in_i, len-len1);
+        }else if(t->mustcopy){
+            memcpy(out->ch[out_i], in->ch[in_i], len*out->bps);
+        }else{
+            out->ch[out_i]= in->ch[in_i];
+        }
+        break;
+    case 2: {
+        int in_i1 = s->matrix_ch[out_i][1];
+        int in_i2 = s->matrix_ch[out_i][2];
+        if(s->mix_2_1_simd && len1)
+            s->mix_2_1_simd(out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_simd_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
+        else
+            s->mix_2_1_f   (out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
+        if(len != len1)
+            s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
+        break;}
+    default:
+        if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
+            for(i=0; i<len; i++){
+                float v=0;
+                for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                    in_i= s->matrix_ch[out_i][1+j];
+                    v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
+                }
+                ((float*)out->ch[out_i])[i]= v;
+            }
+        }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
+            for(i=0; i<len; i++){
+                double v=0;
+                for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                    in_i= s->matrix_ch[out_i][1+j];
+                    v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
+                }
+                ((double*)out->ch[out_i])[i]= v;
+            }
+        }else if(s->mix_n_1_f){
+            const void *ins[SWR_CH_MAX];
+            int32_t coeffs[SWR_CH_MAX];
+            int nb_in = s->matrix_ch[out_i][0];
+
+            for(j=0; j<nb_in; j++){
+                in_i= s->matrix_ch[out_i][1+j];
+                ins[j]   = in->ch[in_i];
+                coeffs[j]= s->matrix32[out_i][in_i];
+            }
+            if(s->mix_n_1_simd && len1)
+                s->mix_n_1_simd(out->ch[out_i], ins, coeffs, nb_in, len1);
+            else
+                s->mix_n_1_f   (out->ch[out_i], ins, coeffs, nb_in, len1);
+            if(len != len1){
+                for(j=0; j<nb_in; j++)
+                    ins[j] = (const uint8_t*)ins[j] + off;
+                s->mix_n_1_f(out->ch[out_i]+off, ins, coeffs, nb_in, len-len1);
+            }
+        }else{
+            for(i=0; i<len; i++){
+                int v=0;
+                for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                    in_i= s->matrix_ch[out_i][1+j];
+                    v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
+                }
+                ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
+            }
+        }
+    }
+}
+
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
+    RematrixThreadArg t = { s, out, in, len, 0, 0, mustcopy };
 
     if(s->mix_any_f) {
         s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
         return 0;
     }
 
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
+    if(s->mix_2_1_simd || s->mix_1_1_simd || s->mix_n_1_simd){
+        t.len1= len&~15;
+        t.off = t.len1 * out->bps;
     }
 
     av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
     av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
 
-    for(out_i=0; out_i<out->ch_count; out_i++){
-        switch(s->matrix_ch[out_i][0]){
-        case 0:
-            if(mustcopy)
-                memset(out->ch[out_i], 0, len * av_get_bytes_per_sample(s->int_sample_fmt));
-            break;
-        case 1:
-            in_i= s->matrix_ch[out_i][1];
-            if(s->matrix[out_i][in_i]!=1.0){
-                if(s->mix_1_1_simd && len1)
-                    s->mix_1_1_simd(out->ch[out_i]    , in->ch[in_i]    , s->native_simd_matrix, in->ch_count*out_i + in_i, len1);
-                if(len != len1)
-                    s->mix_1_1_f   (out->ch[out_i]+off, in->ch[in_i]+off, s->native_matrix, in->ch_count*out_i + in_i, len-len1);
-            }else if(mustcopy){
-                memcpy(out->ch[out_i], in->ch[in_i], len*out->bps);
-            }else{
-                out->ch[out_i]= in->ch[in_i];
-            }
-            break;
-        case 2: {
-            int in_i1 = s->matrix_ch[out_i][1];
-            int in_i2 = s->matrix_ch[out_i][2];
-            if(s->mix_2_1_simd && len1)
-                s->mix_2_1_simd(out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_simd_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
-            else
-                s->mix_2_1_f   (out->ch[out_i]    , in->ch[in_i1]    , in->ch[in_i2]    , s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len1);
-            if(len != len1)
-                s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
-            break;}
-        default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
-            }
-        }
-    }
+    swri_execute(s, rematrix_channel, &t, out->ch_count);
     return 0;
 }
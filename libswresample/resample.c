@@ -133,6 +133,206 @@ static double bessel(double x) {
     }
 }
 
+/**
+ * Apply the window of the filter type to one tap of the sinc.
+ * @param y sinc value at x
+ * @param x position of the tap in radians, scaled by factor
+ * @param d position of the tap in input samples
+ */
+static double window(double y, double x, double d, double factor, int tap_count,
+                     int filter_type, double kaiser_beta)
+{
+    double w, t;
+
+    switch(filter_type){
+    case SWR_FILTER_TYPE_CUBIC:{
+        const float dd= -0.5; //first order derivative = -0.5
+        x = fabs(d * factor);
+        if(x<1.0) y= 1 - 3*x*x + 2*x*x*x + dd*(            -x*x + x*x*x);
+        else      y=                       dd*(-4 + 8*x - 5*x*x + x*x*x);
+        break;}
+    case SWR_FILTER_TYPE_BLACKMAN_NUTTALL:
+        w = 2.0*x / (factor*tap_count);
+        t = -cos(w);
+        y *= 0.3635819 - 0.4891775 * t + 0.1365995 * (2*t*t-1) - 0.0106411 * (4*t*t*t - 3*t);
+        break;
+    case SWR_FILTER_TYPE_KAISER:
+        w = 2.0*x / (factor*tap_count*M_PI);
+        y *= bessel(kaiser_beta*sqrt(FFMAX(1-w*w, 0)));
+        break;
+    default:
+        av_assert0(0);
+    }
+    return y;
+}
+
+/**
+ * In place complex FFT of size n, a power of 2, inverse scaled by 1/n.
+ * cos_tab and sin_tab hold cos and sin of 2*pi*k/n for k < n/2.
+ */
+static void fft(double *re, double *im, const double *cos_tab, const double *sin_tab,
+                int n, int inverse)
+{
+    int i, j, k, len;
+
+    for (i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            FFSWAP(double, re[i], re[j]);
+            FFSWAP(double, im[i], im[j]);
+        }
+    }
+
+    for (len = 2; len <= n; len <<= 1) {
+        int half = len >> 1, step = n / len;
+        for (i = 0; i < n; i += len) {
+            for (k = 0; k < half; k++) {
+                double wr = cos_tab[k * step];
+                double wi = inverse ? sin_tab[k * step] : -sin_tab[k * step];
+                double tr = re[i + k + half] * wr - im[i + k + half] * wi;
+                double ti = re[i + k + half] * wi + im[i + k + half] * wr;
+                re[i + k + half] = re[i + k] - tr;
+                im[i + k + half] = im[i + k] - ti;
+                re[i + k] += tr;
+                im[i + k] += ti;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (i = 0; i < n; i++) {
+            re[i] /= n;
+            im[i] /= n;
+        }
+    }
+}
+
+/**
+ * builds a polyphase filterbank of minimum phase filters.
+ * The windowed sinc over all phases is turned into a minimum phase filter
+ * through its real cepstrum. The taps are stored reversed, so that most of
+ * the energy is on the newest input samples, which leaves a delay of a few
+ * samples instead of half the filter length. The phase_count + 1 phases are
+ * all built.
+ * The delay of the filter at DC is rounded down to whole input samples and
+ * stored in c->filter_delay if that is negative, the filter is delayed by the
+ * remaining phases so that its delay is exactly c->filter_delay.
+ */
+static int build_filter_min_phase(ResampleContext *c, void *filter, double factor, int tap_count, int alloc, int phase_count, int scale,
+                                  int filter_type, double kaiser_beta){
+    int len = tap_count * phase_count + 1;
+    int n, ph, i, m, shift;
+    double *re = NULL, *im = NULL, *cos_tab = NULL, *sin_tab = NULL;
+    double norm = 0, centroid = 0, peak = 0, floor, delay;
+    int ret = AVERROR(ENOMEM);
+
+    if (len > (1 << 20)) {
+        av_log(NULL, AV_LOG_ERROR, "Filter too long for minimum phase\n");
+        return AVERROR(EINVAL);
+    }
+    /* the cepstrum aliases, so leave plenty of room */
+    n = 1 << (av_log2(len) + 3);
+
+    re      = av_calloc(n, sizeof(*re));
+    im      = av_calloc(n, sizeof(*im));
+    cos_tab = av_malloc_array(n / 2, sizeof(*cos_tab));
+    sin_tab = av_malloc_array(n / 2, sizeof(*sin_tab));
+    if (!re || !im || !cos_tab || !sin_tab)
+        goto fail;
+
+    for (i = 0; i < n / 2; i++) {
+        cos_tab[i] = cos(2 * M_PI * i / n);
+        sin_tab[i] = sin(2 * M_PI * i / n);
+    }
+
+    /* if upsampling, only need to interpolate, no filter */
+    if (factor > 1.0)
+        factor = 1.0;
+
+    for (m = 0; m < len; m++) {
+        double d = (m - (len - 1) / 2.0) / phase_count;
+        double x = M_PI * d * factor;
+        double y = x == 0 ? 1.0 : sin(x) / x;
+        re[m] = window(y, x, d, factor, tap_count, filter_type, kaiser_beta);
+    }
+
+    /* log magnitude, floored far below the stopband */
+    fft(re, im, cos_tab, sin_tab, n, 0);
+    for (i = 0; i < n; i++) {
+        re[i] = hypot(re[i], im[i]);
+        peak  = FFMAX(peak, re[i]);
+    }
+    floor = peak * 1e-9;
+    for (i = 0; i < n; i++) {
+        re[i] = log(FFMAX(re[i], floor));
+        im[i] = 0;
+    }
+
+    /* fold the cepstrum onto the causal side and go back */
+    fft(re, im, cos_tab, sin_tab, n, 1);
+    for (i = 1; i < n / 2; i++)
+        re[i] *= 2;
+    for (i = n / 2 + 1; i < n; i++)
+        re[i] = 0;
+    for (i = 0; i < n; i++)
+        im[i] = 0;
+    fft(re, im, cos_tab, sin_tab, n, 0);
+    for (i = 0; i < n; i++) {
+        double e = exp(re[i]);
+        re[i] = e * cos(im[i]);
+        im[i] = e * sin(im[i]);
+    }
+    fft(re, im, cos_tab, sin_tab, n, 1);
+
+    for (m = 0; m < len; m++) {
+        norm     += re[m];
+        centroid += re[m] * m;
+    }
+    delay = FFMAX(tap_count - 1 - centroid / norm / phase_count, 0);
+    if (c->filter_delay < 0)
+        c->filter_delay = FFMIN((int)delay, tap_count - 1);
+    shift = av_clip(lrint((delay - c->filter_delay) * phase_count), 0, phase_count);
+
+    /* the last shift samples of the response are dropped */
+    norm = 0;
+    for (m = 0; m < len - shift; m++)
+        norm += re[m];
+    norm /= phase_count;
+
+    for (ph = 0; ph <= phase_count; ph++) {
+        for (i = 0; i < tap_count; i++) {
+            double v;
+            m = (tap_count - 1 - i) * phase_count + ph - shift;
+            v = m >= 0 ? re[m] * scale / norm : 0;
+            switch(c->format){
+            case AV_SAMPLE_FMT_S16P:
+                ((int16_t*)filter)[ph * alloc + i] = av_clip_int16(lrint(v));
+                break;
+            case AV_SAMPLE_FMT_S32P:
+                ((int32_t*)filter)[ph * alloc + i] = av_clipl_int32(llrint(v));
+                break;
+            case AV_SAMPLE_FMT_FLTP:
+                ((float*)filter)[ph * alloc + i] = v;
+                break;
+            case AV_SAMPLE_FMT_DBLP:
+                ((double*)filter)[ph * alloc + i] = v;
+                break;
+            }
+        }
+    }
+
+    ret = 0;
+fail:
+    av_free(re);
+    av_free(im);
+    av_free(cos_tab);
+    av_free(sin_tab);
+    return ret;
+}
+
 /**
  * builds a polyphase filterbank.
  * @param factor resampling factor
@@ -145,7 +345,7 @@ static int build_filter(ResampleContext *c, void *filter, double factor, int tap
                         int filter_type, double kaiser_beta){
     int ph, i;
     int ph_nb = phase_count % 2 ? phase_count : phase_count / 2 + 1;
-    double x, y, w, t, s;
+    double x, y, s;
     double *tab = av_malloc_array(tap_count+1,  sizeof(*tab));
     double *sin_lut = av_malloc_array(ph_nb, sizeof(*sin_lut));
     const int center= (tap_count-1)/2;
@@ -174,25 +374,8 @@ static int build_filter(ResampleContext *c, void *filter, double factor, int tap
                 y = s / x;
             else
                 y = sin(x) / x;
-            switch(filter_type){
-            case SWR_FILTER_TYPE_CUBIC:{
-                const float d= -0.5; //first order derivative = -0.5
-                x = fabs(((double)(i - center) - (double)ph / phase_count) * factor);
-                if(x<1.0) y= 1 - 3*x*x + 2*x*x*x + d*(            -x*x + x*x*x);
-                else      y=                       d*(-4 + 8*x - 5*x*x + x*x*x);
-                break;}
-            case SWR_FILTER_TYPE_BLACKMAN_NUTTALL:
-                w = 2.0*x / (factor*tap_count);
-                t = -cos(w);
-                y *= 0.3635819 - 0.4891775 * t + 0.1365995 * (2*t*t-1) - 0.0106411 * (4*t*t*t - 3*t);
-                break;
-            case SWR_FILTER_TYPE_KAISER:
-                w = 2.0*x / (factor*tap_count*M_PI);
-                y *= bessel(kaiser_beta*sqrt(FFMAX(1-w*w, 0)));
-                break;
-            default:
-                av_assert0(0);
-            }
+            y = window(y, x, (double)(i - center) - (double)ph / phase_count,
+                       factor, tap_count, filter_type, kaiser_beta);
 
             tab[i] = y;
             s = -s;
@@ -286,7 +469,7 @@ static void resample_free(ResampleContext **cc){
 
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int min_phase)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
@@ -309,7 +492,8 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     if (!c || c->phase_count != phase_count || c->linear!=linear || c->factor != factor
            || c->filter_length != filter_length || c->format != format
-           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta) {
+           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta
+           || c->min_phase != min_phase) {
         resample_free(&c);
         c = av_mallocz(sizeof(*c));
         if (!c)
@@ -344,17 +528,29 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->linear        = linear;
         c->factor        = factor;
         c->filter_length = filter_length;
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
+        /* the SIMD code reads up to 32 bytes of taps at a time, zero padded */
+        c->filter_alloc  = FFALIGN(c->filter_length, 16);
         c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
         if (!c->filter_bank)
             goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
-            goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+        c->min_phase     = min_phase;
+        if (min_phase) {
+            /* the delay is picked once in whole input samples, the start
+             * index, swr_get_delay() and the flush padding all use it, which
+             * keeps the output length exact */
+            c->filter_delay = -1;
+            if (build_filter_min_phase(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+                goto error;
+        } else {
+            if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+                goto error;
+            memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
+            memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+            c->filter_delay = (c->filter_length-1)/2;
+        }
     }
 
     c->compensation_distance= 0;
@@ -368,7 +564,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
     c->dst_incr_div   = c->dst_incr / c->src_incr;
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
 
-    c->index= -phase_count*((c->filter_length-1)/2);
+    c->index= -phase_count*c->filter_delay;
     c->frac= 0;
 
     swri_resample_dsp_init(c);
@@ -396,14 +592,20 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     if (!new_filter_bank)
         return AVERROR(ENOMEM);
 
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    if (c->min_phase)
+        ret = build_filter_min_phase(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
+                                     phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    else
+        ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
+                           phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
     if (ret < 0) {
         av_freep(&new_filter_bank);
         return ret;
     }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+    if (!c->min_phase) {
+        memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
+        memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+    }
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
@@ -449,9 +651,48 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
     return 0;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
-    int i;
-    int av_unused mm_flags = av_get_cpu_flags();
+typedef struct ResampleThreadArg {
+    ResampleContext *c;
+    AudioData *dst, *src;
+    int dst_size;
+    int64_t index2, incr;
+    int (*resample_func)(struct ResampleContext *c, void *dst,
+                         const void *src, int n, int update_ctx);
+    int need_emms;
+    int consumed, index, frac;
+} ResampleThreadArg;
+
+static void resample_one_channel(void *arg, int ch)
+{
+    ResampleThreadArg *t = arg;
+
+    t->c->dsp.resample_one(t->dst->ch[ch], t->src->ch[ch], t->dst_size, t->index2, t->incr);
+    if (t->need_emms)
+        emms_c();
+}
+
+static void resample_channel(void *arg, int ch)
+{
+    ResampleThreadArg *t = arg;
+
+    if (ch + 1 == t->dst->ch_count) {
+        /* the other channels may still be reading the position from the
+         * shared context, so advance a copy */
+        ResampleContext c = *t->c;
+        t->consumed = t->resample_func(&c, t->dst->ch[ch], t->src->ch[ch], t->dst_size, 1);
+        t->index    = c.index;
+        t->frac     = c.frac;
+    } else {
+        t->resample_func(t->c, t->dst->ch[ch], t->src->ch[ch], t->dst_size, 0);
+    }
+    if (t->need_emms)
+        emms_c();
+}
+
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleContext *c = s->resample;
+    ResampleThreadArg t = { c, dst, src };
+    int av_unused mm_flags = av_cpu_get_subsystem_flags("swresample");
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
                     (mm_flags & (AV_CPU_FLAG_MMX2 | AV_CPU_FLAG_SSE2)) == AV_CPU_FLAG_MMX2;
     int64_t max_src_size = (INT64_MAX/2 / c->phase_count) / c->src_incr;
@@ -460,7 +701,8 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         dst_size = FFMIN(dst_size, c->compensation_distance);
     src_size = FFMIN(src_size, max_src_size);
 
-    *consumed = 0;
+    *consumed   = 0;
+    t.need_emms = need_emms;
 
     if (c->filter_length == 1 && c->phase_count == 1) {
         int64_t index2= (1LL<<32)*c->frac/c->src_incr + (1LL<<32)*c->index;
@@ -469,33 +711,35 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
         dst_size = FFMAX(FFMIN(dst_size, new_size), 0);
         if (dst_size > 0) {
-            for (i = 0; i < dst->ch_count; i++) {
-                c->dsp.resample_one(dst->ch[i], src->ch[i], dst_size, index2, incr);
-                if (i+1 == dst->ch_count) {
-                    c->index += dst_size * c->dst_incr_div;
-                    c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
-                    av_assert2(c->index >= 0);
-                    *consumed = c->index;
-                    c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
-                    c->index = 0;
-                }
-            }
+            t.dst_size = dst_size;
+            t.index2   = index2;
+            t.incr     = incr;
+            swri_execute(s, resample_one_channel, &t, dst->ch_count);
+
+            c->index += dst_size * c->dst_incr_div;
+            c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
+            av_assert2(c->index >= 0);
+            *consumed = c->index;
+            c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
+            c->index = 0;
         }
     } else {
         int64_t end_index = (1LL + src_size - c->filter_length) * c->phase_count;
         int64_t delta_frac = (end_index - c->index) * c->src_incr - c->frac;
         int delta_n = (delta_frac + c->dst_incr - 1) / c->dst_incr;
-        int (*resample_func)(struct ResampleContext *c, void *dst,
-                             const void *src, int n, int update_ctx);
 
         dst_size = FFMAX(FFMIN(dst_size, delta_n), 0);
         if (dst_size > 0) {
             /* resample_linear and resample_common should have same behavior
              * when frac and dst_incr_mod are zero */
-            resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
-                            c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            t.resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
+                              c->dsp.resample_linear : c->dsp.resample_common;
+            t.dst_size      = dst_size;
+            swri_execute(s, resample_channel, &t, dst->ch_count);
+
+            *consumed = t.consumed;
+            c->index  = t.index;
+            c->frac   = t.frac;
         }
     }
 
@@ -516,7 +760,7 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
 static int64_t get_delay(struct SwrContext *s, int64_t base){
     ResampleContext *c = s->resample;
-    int64_t num = s->in_buffer_count - (c->filter_length-1)/2;
+    int64_t num = s->in_buffer_count - c->filter_delay;
     num *= c->phase_count;
     num -= c->index;
     num *= c->src_incr;
@@ -549,6 +793,10 @@ static int resample_flush(struct SwrContext *s) {
     int i, j, ret;
     int reflection = (FFMIN(s->in_buffer_count, c->filter_length) + 1) / 2;
 
+    /* minimum phase filters look further past the output position */
+    if (c->min_phase)
+        reflection = FFMIN(s->in_buffer_count, c->filter_length - 1 - c->filter_delay);
+
     if((ret = swri_realloc_audio(a, s->in_buffer_index + s->in_buffer_count + reflection)) < 0)
         return ret;
     av_assert0(a->planar);
@@ -49,6 +49,9 @@ typedef struct ResampleContext {
     int felem_size;
     int filter_shift;
     int phase_count_compensation;      /* desired phase_count when compensation is enabled */
+    int min_phase;                     /* if 1 then the filters are minimum phase */
+    int filter_delay;                  /* delay of the filters in whole input samples from the first tap */
+    int filter_overread;               /* number of input samples past the filter the dsp functions may read */
 
     struct {
         void (*resample_one)(void *dst, const void *src,
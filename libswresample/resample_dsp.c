@@ -45,6 +45,8 @@
 
 void swri_resample_dsp_init(ResampleContext *c)
 {
+    c->filter_overread = 0;
+
     switch(c->format){
     case AV_SAMPLE_FMT_S16P:
         c->dsp.resample_one = resample_one_int16;
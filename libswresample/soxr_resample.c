@@ -30,7 +30,7 @@
 #include <soxr.h>
 
 static struct ResampleContext *create(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
-        double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational){
+        double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational, int min_phase){
     soxr_error_t error;
 
     soxr_datatype_t type =
@@ -45,7 +45,14 @@ static struct ResampleContext *create(struct ResampleContext *c, int out_rate, i
 
     soxr_io_spec_t io_spec = soxr_io_spec(type, type);
 
-    soxr_quality_spec_t q_spec = soxr_quality_spec((int)((precision-2)/4), (SOXR_HI_PREC_CLOCK|SOXR_ROLLOFF_NONE)*!!cheby);
+    int recipe = (int)((precision-2)/4);
+    soxr_quality_spec_t q_spec;
+
+#ifdef SOXR_MINIMUM_PHASE
+    if (min_phase)
+        recipe |= SOXR_MINIMUM_PHASE;
+#endif
+    q_spec = soxr_quality_spec(recipe, (SOXR_HI_PREC_CLOCK|SOXR_ROLLOFF_NONE)*!!cheby);
     q_spec.precision = precision;
 #if !defined SOXR_VERSION /* Deprecated @ March 2013: */
     q_spec.bw_pc = cutoff? FFMAX(FFMIN(cutoff,.995),.8)*100 : q_spec.bw_pc;
@@ -82,8 +89,9 @@ static int flush(struct SwrContext *s){
 }
 
 static int process(
-        struct ResampleContext * c, AudioData *dst, int dst_size,
+        struct SwrContext *s, AudioData *dst, int dst_size,
         AudioData *src, int src_size, int *consumed){
+    struct ResampleContext *c = s->resample;
     size_t idone, odone;
     soxr_error_t error = soxr_set_error((soxr_t)c, soxr_set_num_channels((soxr_t)c, src->ch_count));
     if (!error)
@@ -20,6 +20,7 @@
 
 #include "libavutil/opt.h"
 #include "swresample_internal.h"
+#include "resample.h"
 #include "audioconvert.h"
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
@@ -129,6 +130,7 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    avpriv_slicethread_free(&s->slicethread);
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
@@ -149,6 +151,27 @@ av_cold void swr_close(SwrContext *s){
     clear_context(s);
 }
 
+static void thread_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    SwrContext *s = priv;
+
+    s->thread_func(s->thread_arg, jobnr);
+}
+
+void swri_execute(SwrContext *s, void (*func)(void *arg, int jobnr), void *arg, int nb_jobs)
+{
+    int i;
+
+    if (s->slicethread && nb_jobs > 1) {
+        s->thread_func = func;
+        s->thread_arg  = arg;
+        avpriv_slicethread_execute(s->slicethread, nb_jobs, 0);
+    } else {
+        for (i = 0; i < nb_jobs; i++)
+            func(arg, i);
+    }
+}
+
 av_cold int swr_init(struct SwrContext *s){
     int ret;
     char l1[1024], l2[1024];
@@ -264,7 +287,16 @@ av_cold int swr_init(struct SwrContext *s){
     }
 
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        int filter_size = s->filter_size;
+        int linear_interp = s->linear_interp;
+        if (s->low_delay) {
+            filter_size = FFMIN(filter_size, 16);
+            /* with equal rates only the timestamp drift is compensated, the
+             * nearest of the 1 << phase_shift phases is close enough */
+            if (s->out_sample_rate == s->in_sample_rate)
+                linear_interp = 0;
+        }
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, filter_size, s->phase_shift, linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational, s->low_delay);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -333,6 +365,18 @@ av_assert0(s->out.ch_count);
         return 0;
     }
 
+    if (s->thread_count != 1) {
+        ret = avpriv_slicethread_create(&s->slicethread, s, thread_worker, NULL,
+                                        s->thread_count);
+        if (ret == AVERROR(ENOSYS)) {
+            av_log(s, AV_LOG_WARNING, "Threads are not supported, processing the channels serially\n");
+        } else if (ret < 0) {
+            goto fail;
+        } else if (ret <= 1) {
+            avpriv_slicethread_free(&s->slicethread);
+        }
+    }
+
     s->in_convert = swri_audio_convert_alloc(s->int_sample_fmt,
                                              s-> in_sample_fmt, s->used_ch_count, s->channel_map, 0);
     s->out_convert= swri_audio_convert_alloc(s->out_sample_fmt,
@@ -481,7 +525,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     AudioData in, out, tmp;
     int ret_sum=0;
     int border=0;
-    int padless = ARCH_X86 && s->engine == SWR_ENGINE_SWR ? 7 : 0;
+    int padless = s->engine == SWR_ENGINE_SWR ? s->resample->filter_overread : 0;
 
     av_assert1(s->in_buffer.ch_count == in_param->ch_count);
     av_assert1(s->in_buffer.planar   == in_param->planar);
@@ -506,7 +550,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -526,7 +570,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
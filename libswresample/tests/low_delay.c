@@ -0,0 +1,111 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Resample one second of audio with low_delay set, in uneven chunks, and
+ * check that swr_get_delay() accounts for every sample that has not been
+ * output yet and that the flushed output has exactly the expected length.
+ * With equal rates, COMP_DELTA samples are added through
+ * swr_set_compensation() at the start.
+ */
+
+#include <stdio.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/swresample.h"
+
+#define IN_RATE  48000
+#define CHUNK    1000
+#define OUT_SIZE 8192
+#define COMP_DELTA    48
+#define COMP_DISTANCE 4800
+
+static int test(enum AVSampleFormat internal_fmt, int out_rate)
+{
+    static float in[2 * CHUNK], out[2 * OUT_SIZE];
+    const uint8_t *in_data[1] = { (const uint8_t *)in };
+    uint8_t *out_data[1] = { (uint8_t *)out };
+    int64_t expected, delay;
+    int fed = 0, total = 0, mismatches = 0, i, n;
+    SwrContext *s;
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_FLT, out_rate,
+                           AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_FLT, IN_RATE, 0, NULL);
+    if (!s)
+        return 1;
+    av_opt_set_int(s, "low_delay", 1, 0);
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", internal_fmt, 0);
+    if (out_rate == IN_RATE)
+        av_opt_set_int(s, "flags", SWR_FLAG_RESAMPLE, 0);
+    if (swr_init(s) < 0 ||
+        (out_rate == IN_RATE && swr_set_compensation(s, COMP_DELTA, COMP_DISTANCE) < 0)) {
+        swr_free(&s);
+        return 1;
+    }
+
+    for (i = 0; fed < IN_RATE; i++) {
+        int len = FFMIN(CHUNK - (i % 7) * 97, IN_RATE - fed);
+        for (n = 0; n < 2 * len; n++)
+            in[n] = ((fed + n / 2) % 101 - 50) / 64.0;
+        n = swr_convert(s, out_data, OUT_SIZE, in_data, len);
+        if (n < 0)
+            break;
+        fed   += len;
+        total += n;
+
+        /* everything fed in but not output yet is the delay */
+        expected = av_rescale(fed, out_rate, IN_RATE);
+        delay    = swr_get_delay(s, out_rate);
+        if (out_rate == IN_RATE) {
+            if (total < COMP_DISTANCE)
+                continue;
+            expected += COMP_DELTA;
+        }
+        if (total + delay != expected)
+            mismatches++;
+    }
+    while ((n = swr_convert(s, out_data, OUT_SIZE, NULL, 0)) > 0)
+        total += n;
+
+    expected = out_rate + (out_rate == IN_RATE ? COMP_DELTA : 0);
+    printf("%-4s %d -> %6d: %6d samples, expected %6"PRId64", %d delay mismatches\n",
+           av_get_sample_fmt_name(internal_fmt), IN_RATE, out_rate,
+           total, expected, mismatches);
+
+    swr_free(&s);
+    return 0;
+}
+
+int main(void)
+{
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    static const int rates[] = { 8000, 22050, 44100, 48000, 96000, 192000 };
+    int i, j, ret = 0;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        for (j = 0; j < FF_ARRAY_ELEMS(rates); j++)
+            ret |= test(fmts[i], rates[j]);
+    }
+    return ret;
+}
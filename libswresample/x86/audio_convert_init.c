@@ -37,7 +37,7 @@ av_cold void swri_audio_convert_init_x86(struct AudioConvert *ac,
                                  enum AVSampleFormat out_fmt,
                                  enum AVSampleFormat in_fmt,
                                  int channels){
-    int mm_flags = av_get_cpu_flags();
+    int mm_flags = av_cpu_get_subsystem_flags("swresample");
 
     ac->simd_f= NULL;
 
@@ -24,6 +24,8 @@
 SECTION_RODATA 32
 dw1: times 8  dd 1
 w1 : times 16 dw 1
+pd_16384: dd 16384
+pq_16384: dq 16384
 
 SECTION .text
 
@@ -222,6 +224,84 @@ mix_2_1_int16_u_int %+ SUFFIX:
 %endif
 %endmacro
 
+; mix nb_in input channels into one output channel, len must be a multiple of
+; 16 (int16) or 8 (int32); the int16 sums are kept in 32 bits like in the C
+; code and either clipped or wrapped to 16 bits, the int32 products are summed
+; in 64 bits and truncated to 32 bits
+%macro MIXN_INT16 1 ; clip
+cglobal mix_n_1_%1_int16, 5, 8, 7, out, in, coeffp, nb_in, len, x, j, p
+    vpbroadcastd m6, [pd_16384]
+    add lenq    , lenq
+    xor xd      , xd
+.next:
+    pxor         m0, m0
+    pxor         m1, m1
+    mov          jq, nb_inq
+.inner:
+    mov          pq, [inq + 8*jq - 8]
+    vpbroadcastd m2, [coeffpq + 4*jq - 4]
+    pmovsxwd     m3, [pq + xq     ]
+    pmovsxwd     m4, [pq + xq + 16]
+    pmulld       m3, m2
+    pmulld       m4, m2
+    paddd        m0, m3
+    paddd        m1, m4
+    dec          jq
+        jnz .inner
+    paddd        m0, m6
+    paddd        m1, m6
+    psrad        m0, 15
+    psrad        m1, 15
+%ifidn %1, wrap
+    pslld        m0, 16
+    pslld        m1, 16
+    psrad        m0, 16
+    psrad        m1, 16
+%endif
+    packssdw     m0, m1
+    vpermq       m0, m0, q3120
+    movu  [outq + xq], m0
+    add          xq, mmsize
+    cmp          xq, lenq
+        jl .next
+    RET
+%endmacro
+
+%macro MIXN_INT32 0
+cglobal mix_n_1_int32, 5, 8, 6, out, in, coeffp, nb_in, len, x, j, p
+    vpbroadcastq m5, [pq_16384]
+    shl lenq    , 2
+    xor xd      , xd
+.next:
+    pxor         m0, m0
+    pxor         m1, m1
+    mov          jq, nb_inq
+.inner:
+    mov          pq, [inq + 8*jq - 8]
+    vpbroadcastd m2, [coeffpq + 4*jq - 4]
+    pmovsxdq     m3, [pq + xq     ]
+    pmovsxdq     m4, [pq + xq + 16]
+    pmuldq       m3, m2
+    pmuldq       m4, m2
+    paddq        m0, m3
+    paddq        m1, m4
+    dec          jq
+        jnz .inner
+    paddq        m0, m5
+    paddq        m1, m5
+    psrlq        m0, 15
+    psrlq        m1, 15
+    pshufd       m0, m0, q0020
+    pshufd       m1, m1, q0020
+    punpcklqdq   m0, m1
+    vpermq       m0, m0, q3120
+    movu  [outq + xq], m0
+    add          xq, mmsize
+    cmp          xq, lenq
+        jl .next
+    RET
+%endmacro
+
 
 INIT_MMX mmx
 MIX1_INT16 u
@@ -248,3 +328,10 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIXN_INT16 wrap
+MIXN_INT16 clip
+MIXN_INT32
+%endif
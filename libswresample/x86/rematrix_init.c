@@ -30,9 +30,99 @@ D(float, avx)
 D(int16, mmx)
 D(int16, sse2)
 
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+void ff_mix_n_1_wrap_int16_avx2(void *out, const void **in, const int32_t *coeffp,
+                                integer nb_in, integer len);
+void ff_mix_n_1_clip_int16_avx2(void *out, const void **in, const int32_t *coeffp,
+                                integer nb_in, integer len);
+void ff_mix_n_1_int32_avx2(void *out, const void **in, const int32_t *coeffp,
+                           integer nb_in, integer len);
+
+/* The 5.1 and 7.1 to stereo downmixes of rematrix_template.c, each output
+ * channel mixes the inputs with a nonzero coefficient, the last samples are
+ * done in C. */
+static av_always_inline void mix_to2_s16_avx2(uint8_t **out, const uint8_t **in1,
+                                              void *coeffp, integer len,
+                                              int nb_in, int clip)
+{
+    const int *coeff = coeffp;
+    integer len16 = len & ~15;
+    int ch, i, j;
+
+    for (ch = 0; ch < 2; ch++) {
+        static const uint8_t map[2][5] = { { 0, 2, 3, 4, 6 }, { 1, 2, 3, 5, 7 } };
+        int nb = nb_in == 8 ? 5 : 4;
+        const int16_t *in[5];
+        int16_t *dst = (int16_t *)out[ch];
+        int32_t c[5];
+
+        for (j = 0; j < nb; j++) {
+            in[j] = (const int16_t *)in1[map[ch][j]];
+            /* like the C code, the center and LFE coefficients of the
+             * first output are used for both */
+            c[j]  = coeff[(j == 1 || j == 2 ? 0 : ch) * nb_in + map[ch][j]];
+        }
+        if (len16 && clip)
+            ff_mix_n_1_clip_int16_avx2(dst, (const void **)in, c, nb, len16);
+        else if (len16)
+            ff_mix_n_1_wrap_int16_avx2(dst, (const void **)in, c, nb, len16);
+        for (i = len16; i < len; i++) {
+            int v = 0;
+            for (j = 0; j < nb; j++)
+                v += in[j][i] * c[j];
+            dst[i] = clip ? av_clip_int16((v + 16384) >> 15) : (v + 16384) >> 15;
+        }
+    }
+}
+
+static av_always_inline void mix_to2_s32_avx2(uint8_t **out, const uint8_t **in1,
+                                              void *coeffp, integer len, int nb_in)
+{
+    const int *coeff = coeffp;
+    integer len8 = len & ~7;
+    int ch, i, j;
+
+    for (ch = 0; ch < 2; ch++) {
+        static const uint8_t map[2][5] = { { 0, 2, 3, 4, 6 }, { 1, 2, 3, 5, 7 } };
+        int nb = nb_in == 8 ? 5 : 4;
+        const int32_t *in[5];
+        int32_t *dst = (int32_t *)out[ch];
+        int32_t c[5];
+
+        for (j = 0; j < nb; j++) {
+            in[j] = (const int32_t *)in1[map[ch][j]];
+            /* like the C code, the center and LFE coefficients of the
+             * first output are used for both */
+            c[j]  = coeff[(j == 1 || j == 2 ? 0 : ch) * nb_in + map[ch][j]];
+        }
+        if (len8)
+            ff_mix_n_1_int32_avx2(dst, (const void **)in, c, nb, len8);
+        for (i = len8; i < len; i++) {
+            int64_t v = 0;
+            for (j = 0; j < nb; j++)
+                v += in[j][i] * (int64_t)c[j];
+            dst[i] = (v + 16384) >> 15;
+        }
+    }
+}
+
+#define MIX_TO2(name, type, ...) \
+static void name(uint8_t **out, const uint8_t **in, void *coeffp, integer len) \
+{ \
+    mix_to2_##type##_avx2(out, in, coeffp, len, __VA_ARGS__); \
+}
+
+MIX_TO2(mix6to2_s16_avx2,      s16, 6, 0)
+MIX_TO2(mix6to2_clip_s16_avx2, s16, 6, 1)
+MIX_TO2(mix8to2_s16_avx2,      s16, 8, 0)
+MIX_TO2(mix8to2_clip_s16_avx2, s16, 8, 1)
+MIX_TO2(mix6to2_s32_avx2,      s32, 6)
+MIX_TO2(mix8to2_s32_avx2,      s32, 8)
+#endif /* HAVE_AVX2_EXTERNAL && ARCH_X86_64 */
+
 av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 #if HAVE_X86ASM
-    int mm_flags = av_get_cpu_flags();
+    int mm_flags = av_cpu_get_subsystem_flags("swresample");
     int nb_in  = s->used_ch_count;
     int nb_out = s->out.ch_count;
     int num    = nb_in * nb_out;
@@ -84,6 +174,31 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
         memcpy(s->native_simd_matrix, s->native_matrix, num * sizeof(float));
         memcpy(s->native_simd_one, s->native_one, sizeof(float));
     }
+
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+    if (EXTERNAL_AVX2_FAST(mm_flags)) {
+        if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P) {
+            /* the same test rematrix.c uses to pick the clipping functions */
+            int maxsum = 0;
+            for (i = 0; i < nb_out; i++) {
+                int sum = 0;
+                for (j = 0; j < nb_in; j++)
+                    sum += FFABS(((int*)s->native_matrix)[i * nb_in + j]);
+                maxsum = FFMAX(maxsum, sum);
+            }
+            if (s->mix_any_f && nb_in == 6)
+                s->mix_any_f = maxsum <= 32768 ? mix6to2_s16_avx2 : mix6to2_clip_s16_avx2;
+            if (s->mix_any_f && nb_in == 8)
+                s->mix_any_f = maxsum <= 32768 ? mix8to2_s16_avx2 : mix8to2_clip_s16_avx2;
+            s->mix_n_1_simd = ff_mix_n_1_wrap_int16_avx2;
+        } else if (s->midbuf.fmt == AV_SAMPLE_FMT_S32P) {
+            if (s->mix_any_f && nb_in == 6)
+                s->mix_any_f = mix6to2_s32_avx2;
+            if (s->mix_any_f && nb_in == 8)
+                s->mix_any_f = mix8to2_s32_avx2;
+        }
+    }
+#endif
 #endif
 
     return 0;
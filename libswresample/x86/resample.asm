@@ -51,15 +51,24 @@ SECTION_RODATA
 pf_1:      dd 1.0
 pdbl_1:    dq 1.0
 pd_0x4000: dd 0x4000
+pq_0x20000000: dq 0x20000000
 
 SECTION .text
 
 ; FIXME remove unneeded variables (index_incr, phase_mask)
-%macro RESAMPLE_FNS 3-5 ; format [float or int16], bps, log2_bps, float op suffix [s or d], 1.0 constant
+; int32 sums its products in 64 bits and is only built for x86-64 avx2
+%macro RESAMPLE_FNS 3-5 ; format [float, double, int16 or int32], bps, log2_bps, float op suffix [s or d], 1.0 constant
+%ifidn %1, int32
+%define common_xmm_regs 4
+%define linear_xmm_regs 7
+%else
+%define common_xmm_regs 2
+%define linear_xmm_regs 5
+%endif
 ; int resample_common_$format(ResampleContext *ctx, $format *dst,
 ;                             const $format *src, int size, int update_ctx)
 %if ARCH_X86_64 ; unix64 and win64
-cglobal resample_common_%1, 0, 15, 2, ctx, dst, src, phase_count, index, frac, \
+cglobal resample_common_%1, 0, 15, common_xmm_regs, ctx, dst, src, phase_count, index, frac, \
                                       dst_incr_mod, size, min_filter_count_x4, \
                                       min_filter_len_x4, dst_incr_div, src_incr, \
                                       phase_mask, dst_end, filter_bank
@@ -111,7 +120,7 @@ cglobal resample_common_%1, 0, 15, 2, ctx, dst, src, phase_count, index, frac, \
     sub                         srcq, min_filter_len_x4q
     mov                   src_stackq, srcq
 %else ; x86-32
-cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
+cglobal resample_common_%1, 1, 7, common_xmm_regs, ctx, phase_count, dst, frac, \
                                      index, min_filter_length_x4, filter_bank
 
     ; push temp variables to stack
@@ -166,7 +175,9 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     mov         min_filter_count_x4q, min_filter_length_x4q
 %endif
 %ifidn %1, int16
-    movd                          m0, [pd_0x4000]
+    movd                         xm0, [pd_0x4000]
+%elifidn %1, int32
+    movq                         xm0, [pq_0x20000000]
 %else ; float/double
     xorps                         m0, m0, m0
 %endif
@@ -181,6 +192,15 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     pmaddwd                       m1, [filterq+min_filter_count_x4q*1]
     paddd                         m0, m1
 %endif
+%elifidn %1, int32
+    ; pmuldq only multiplies the even dwords, shift the odd ones down
+    psrlq                         m2, m1, 32
+    movu                          m3, [filterq+min_filter_count_x4q*1]
+    pmuldq                        m1, m3
+    psrlq                         m3, 32
+    pmuldq                        m2, m3
+    paddq                         m0, m1
+    paddq                         m0, m2
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
     fmaddp%4                      m0, m1, [filterq+min_filter_count_x4q*1], m0
@@ -193,12 +213,33 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     js .inner_loop
 
 %ifidn %1, int16
-    HADDD                         m0, m1
-    psrad                         m0, 15
+%if mmsize == 32
+    vextracti128                 xm1, m0, 1
+    paddd                        xm0, xm1
+%endif
+    HADDD                        xm0, xm1
+    psrad                        xm0, 15
+    add                        fracd, dst_incr_modd
+    packssdw                     xm0, xm0
+    add                       indexd, dst_incr_divd
+    movd                      [dstq], xm0
+%elifidn %1, int32
+    vextracti128                 xm1, m0, 1
+    paddq                        xm0, xm1
+    pshufd                       xm1, xm0, q0032
+    paddq                        xm0, xm1
+    movq                     filterq, xm0
     add                        fracd, dst_incr_modd
-    packssdw                      m0, m0
+    sar                      filterq, 30
     add                       indexd, dst_incr_divd
-    movd                      [dstq], m0
+    ; clip to int32
+    movsxd      min_filter_count_x4q, filterd
+    cmp         min_filter_count_x4q, filterq
+    je .store
+    sar                      filterq, 63
+    xor                      filterd, 0x7fffffff
+.store:
+    mov                       [dstq], filterd
 %else ; float/double
     ; horizontal sum & store
 %if mmsize == 32
@@ -273,14 +314,14 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
 ;                             const float *src, int size, int update_ctx)
 %if ARCH_X86_64 ; unix64 and win64
 %if UNIX64
-cglobal resample_linear_%1, 0, 15, 5, ctx, dst, phase_mask, phase_count, index, frac, \
+cglobal resample_linear_%1, 0, 15, linear_xmm_regs, ctx, dst, phase_mask, phase_count, index, frac, \
                                       size, dst_incr_mod, min_filter_count_x4, \
                                       min_filter_len_x4, dst_incr_div, src_incr, \
                                       src, dst_end, filter_bank
 
     mov                         srcq, r2mp
 %else ; win64
-cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index, frac, \
+cglobal resample_linear_%1, 0, 15, linear_xmm_regs, ctx, phase_mask, src, phase_count, index, frac, \
                                       size, dst_incr_mod, min_filter_count_x4, \
                                       min_filter_len_x4, dst_incr_div, src_incr, \
                                       dst, dst_end, filter_bank
@@ -312,7 +353,9 @@ cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index,
     mov                   ctx_stackq, ctxq
     mov           min_filter_len_x4d, [ctxq+ResampleContext.filter_length]
 %ifidn %1, int16
-    movd                          m4, [pd_0x4000]
+    movd                         xm4, [pd_0x4000]
+%elifidn %1, int32
+    movq                         xm4, [pq_0x20000000]
 %else ; float/double
     cvtsi2s%4                    xm0, src_incrd
     movs%4                       xm4, [%5]
@@ -343,7 +386,7 @@ cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index,
     sub                         srcq, min_filter_len_x4q
     mov                   src_stackq, srcq
 %else ; x86-32
-cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
+cglobal resample_linear_%1, 1, 7, linear_xmm_regs, ctx, min_filter_length_x4, filter2, \
                                      frac, index, dst, filter_bank
 
     ; push temp variables to stack
@@ -365,7 +408,9 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     PUSH                              dword [ctxq+ResampleContext.phase_count]  ; unneeded replacement of phase_mask
     PUSH                              r3d
 %ifidn %1, int16
-    movd                          m4, [pd_0x4000]
+    movd                         xm4, [pd_0x4000]
+%elifidn %1, int32
+    movq                         xm4, [pq_0x20000000]
 %else ; float/double
     cvtsi2s%4                    xm0, r3d
     movs%4                       xm4, [%5]
@@ -416,6 +461,9 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %ifidn %1, int16
     mova                          m0, m4
     mova                          m2, m4
+%elifidn %1, int32
+    mova                          m0, m4
+    mova                          m2, m4
 %else ; float/double
     xorps                         m0, m0, m0
     xorps                         m2, m2, m2
@@ -434,6 +482,20 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     paddd                         m2, m3
     paddd                         m0, m1
 %endif ; cpuflag
+%elifidn %1, int32
+    psrlq                         m3, m1, 32
+    movu                          m5, [filter2q+min_filter_count_x4q*1]
+    psrlq                         m6, m5, 32
+    pmuldq                        m5, m1
+    pmuldq                        m6, m3
+    paddq                         m2, m5
+    paddq                         m2, m6
+    movu                          m5, [filter1q+min_filter_count_x4q*1]
+    psrlq                         m6, m5, 32
+    pmuldq                        m5, m1
+    pmuldq                        m6, m3
+    paddq                         m0, m5
+    paddq                         m0, m6
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
     fmaddp%4                      m2, m1, [filter2q+min_filter_count_x4q*1], m2
@@ -449,41 +511,75 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     js .inner_loop
 
 %ifidn %1, int16
-%if mmsize == 16
+%if mmsize == 32
+    vextracti128                 xm3, m2, 1
+    vextracti128                 xm1, m0, 1
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
+%endif
+%if mmsize >= 16
 %if cpuflag(xop)
-    vphadddq                      m2, m2
-    vphadddq                      m0, m0
+    vphadddq                     xm2, xm2
+    vphadddq                     xm0, xm0
 %endif
-    pshufd                        m3, m2, q0032
-    pshufd                        m1, m0, q0032
-    paddd                         m2, m3
-    paddd                         m0, m1
+    pshufd                       xm3, xm2, q0032
+    pshufd                       xm1, xm0, q0032
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
 %endif
 %if notcpuflag(xop)
-    PSHUFLW                       m3, m2, q0032
-    PSHUFLW                       m1, m0, q0032
-    paddd                         m2, m3
-    paddd                         m0, m1
+    PSHUFLW                      xm3, xm2, q0032
+    PSHUFLW                      xm1, xm0, q0032
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
 %endif
-    psubd                         m2, m0
+    psubd                        xm2, xm0
     ; This is probably a really bad idea on atom and other machines with a
     ; long transfer latency between GPRs and XMMs (atom). However, it does
     ; make the clip a lot simpler...
-    movd                         eax, m2
+    movd                         eax, xm2
     add                       indexd, dst_incr_divd
     imul                              fracd
     idiv                              src_incrd
-    movd                          m1, eax
+    movd                         xm1, eax
     add                        fracd, dst_incr_modd
-    paddd                         m0, m1
-    psrad                         m0, 15
-    packssdw                      m0, m0
-    movd                      [dstq], m0
+    paddd                        xm0, xm1
+    psrad                        xm0, 15
+    packssdw                     xm0, xm0
+    movd                      [dstq], xm0
 
     ; note that for imul/idiv, I need to move filter to edx/eax for each:
     ; - 32bit: eax=r0[filter1], edx=r2[filter2]
     ; - win64: eax=r6[filter1], edx=r1[todo]
     ; - unix64: eax=r6[filter1], edx=r2[todo]
+%elifidn %1, int32
+    ; val += (v2 - val) / c->src_incr * frac, all in 64 bits
+    vextracti128                 xm3, m2, 1
+    vextracti128                 xm1, m0, 1
+    paddq                        xm2, xm3
+    paddq                        xm0, xm1
+    pshufd                       xm3, xm2, q0032
+    pshufd                       xm1, xm0, q0032
+    paddq                        xm2, xm3
+    paddq                        xm0, xm1
+    psubq                        xm2, xm0
+    movq                         rax, xm2
+    add                       indexd, dst_incr_divd
+    cqo
+    idiv                              src_incrq
+    imul                         rax, fracq
+    movq                         rdx, xm0
+    add                        fracd, dst_incr_modd
+    add                          rax, rdx
+    sar                          rax, 30
+    ; clip to int32
+    movsxd                       rdx, eax
+    cmp                          rdx, rax
+    je .store
+    sar                          rax, 63
+    xor                          eax, 0x7fffffff
+.store:
+    mov                       [dstq], eax
 %else ; float/double
     ; val += (v2 - val) * (FELEML) frac / c->src_incr;
 %if mmsize == 32
@@ -605,6 +701,13 @@ RESAMPLE_FNS int16, 2, 1
 INIT_XMM xop
 RESAMPLE_FNS int16, 2, 1
 %endif
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RESAMPLE_FNS int16, 2, 1
+%if ARCH_X86_64
+RESAMPLE_FNS int32, 4, 2
+%endif
+%endif
 
 INIT_XMM sse2
 RESAMPLE_FNS double, 8, 3, d, pdbl_1
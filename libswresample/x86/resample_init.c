@@ -37,6 +37,8 @@ int ff_resample_linear_##type##_##opt(ResampleContext *c, void *dst, \
 RESAMPLE_FUNCS(int16,  mmxext);
 RESAMPLE_FUNCS(int16,  sse2);
 RESAMPLE_FUNCS(int16,  xop);
+RESAMPLE_FUNCS(int16,  avx2);
+RESAMPLE_FUNCS(int32,  avx2);
 RESAMPLE_FUNCS(float,  sse);
 RESAMPLE_FUNCS(float,  avx);
 RESAMPLE_FUNCS(float,  fma3);
@@ -47,7 +49,11 @@ RESAMPLE_FUNCS(double, fma3);
 
 av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
 {
-    int av_unused mm_flags = av_get_cpu_flags();
+    int av_unused mm_flags = av_cpu_get_subsystem_flags("swresample");
+
+    /* The SIMD functions load whole registers of input samples, at most 8
+     * except for the AVX2 int16 ones, the input is padded accordingly. */
+    c->filter_overread = 7;
 
     switch(c->format){
     case AV_SAMPLE_FMT_S16P:
@@ -63,6 +69,17 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample_linear = ff_resample_linear_int16_xop;
             c->dsp.resample_common = ff_resample_common_int16_xop;
         }
+        if (EXTERNAL_AVX2_FAST(mm_flags) && c->filter_length >= 16) {
+            c->dsp.resample_linear = ff_resample_linear_int16_avx2;
+            c->dsp.resample_common = ff_resample_common_int16_avx2;
+            c->filter_overread     = 15;
+        }
+        break;
+    case AV_SAMPLE_FMT_S32P:
+        if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(mm_flags) && c->filter_length >= 8) {
+            c->dsp.resample_linear = ff_resample_linear_int32_avx2;
+            c->dsp.resample_common = ff_resample_common_int32_avx2;
+        }
         break;
     case AV_SAMPLE_FMT_FLTP:
         if (EXTERNAL_SSE(mm_flags)) {
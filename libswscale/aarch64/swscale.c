@@ -31,7 +31,7 @@ void ff_yuv2planeX_8_neon(const int16_t *filter, int filterSize,
 
 av_cold void ff_sws_init_swscale_aarch64(SwsContext *c)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swscale");
 
     if (have_neon(cpu_flags)) {
         if (c->srcBpc == 8 && c->dstBpc <= 14) {
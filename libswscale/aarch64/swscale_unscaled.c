@@ -126,7 +126,7 @@ static void get_unscaled_swscale_neon(SwsContext *c) {
 
 void ff_get_unscaled_swscale_aarch64(SwsContext *c)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swscale");
     if (have_neon(cpu_flags))
         get_unscaled_swscale_neon(c);
 }
@@ -240,7 +240,7 @@ av_cold void ff_sws_init_swscale_ppc(SwsContext *c)
 #if HAVE_ALTIVEC
     enum AVPixelFormat dstFormat = c->dstFormat;
 
-    if (!(av_get_cpu_flags() & AV_CPU_FLAG_ALTIVEC))
+    if (!(av_cpu_get_subsystem_flags("swscale") & AV_CPU_FLAG_ALTIVEC))
         return;
 
 #if HAVE_BIGENDIAN
@@ -430,7 +430,7 @@ av_cold void ff_sws_init_swscale_vsx(SwsContext *c)
 {
 #if HAVE_VSX
     enum AVPixelFormat dstFormat = c->dstFormat;
-    const int cpu_flags = av_get_cpu_flags();
+    const int cpu_flags = av_cpu_get_subsystem_flags("swscale");
 
     if (!(cpu_flags & AV_CPU_FLAG_VSX))
         return;
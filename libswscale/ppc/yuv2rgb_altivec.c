@@ -540,7 +540,7 @@ static int altivec_uyvy_rgb32(SwsContext *c, const unsigned char **in,
 av_cold SwsFunc ff_yuv2rgb_init_ppc(SwsContext *c)
 {
 #if HAVE_ALTIVEC
-    if (!(av_get_cpu_flags() & AV_CPU_FLAG_ALTIVEC))
+    if (!(av_cpu_get_subsystem_flags("swscale") & AV_CPU_FLAG_ALTIVEC))
         return NULL;
 
     /*
@@ -612,7 +612,7 @@ av_cold void ff_yuv2rgb_init_tables_ppc(SwsContext *c,
         vector signed short vec;
     } buf;
 
-    if (!(av_get_cpu_flags() & AV_CPU_FLAG_ALTIVEC))
+    if (!(av_cpu_get_subsystem_flags("swscale") & AV_CPU_FLAG_ALTIVEC))
         return;
 
     buf.tmp[0] = ((0xffffLL) * contrast >> 8) >> 9;                               // cy
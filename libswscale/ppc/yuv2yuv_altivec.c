@@ -187,7 +187,7 @@ static int yv12touyvy_unscaled_altivec(SwsContext *c, const uint8_t *src[],
 av_cold void ff_get_unscaled_swscale_ppc(SwsContext *c)
 {
 #if HAVE_ALTIVEC
-    if (!(av_get_cpu_flags() & AV_CPU_FLAG_ALTIVEC))
+    if (!(av_cpu_get_subsystem_flags("swscale") & AV_CPU_FLAG_ALTIVEC))
         return;
 
     if (!(c->srcW & 15) && !(c->flags & SWS_BITEXACT) &&
@@ -330,7 +330,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         || srcStride[0]&15 || srcStride[1]&15 || srcStride[2]&15 || srcStride[3]&15
     ) {
         static int warnedAlready=0;
-        int cpu_flags = av_get_cpu_flags();
+        int cpu_flags = av_cpu_get_subsystem_flags("swscale");
         if (HAVE_MMXEXT && (cpu_flags & AV_CPU_FLAG_SSE2) && !warnedAlready){
             av_log(c, AV_LOG_WARNING, "Warning: data is not aligned! This can lead to a speed loss\n");
             warnedAlready=1;
@@ -522,7 +522,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     }
 
 #if HAVE_MMXEXT_INLINE
-    if (av_get_cpu_flags() & AV_CPU_FLAG_MMXEXT)
+    if (av_cpu_get_subsystem_flags("swscale") & AV_CPU_FLAG_MMXEXT)
         __asm__ volatile ("sfence" ::: "memory");
 #endif
     emms_c();
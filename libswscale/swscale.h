@@ -279,6 +279,19 @@ SwsFilter *sws_getDefaultFilter(float lumaGBlur, float chromaGBlur,
                                 int verbose);
 void sws_freeFilter(SwsFilter *filter);
 
+/**
+ * Get the statistics of the filter cache.
+ *
+ * The scaler filters computed by sws_init_context() are kept in a cache that
+ * is shared by all contexts in the process, so that creating another context
+ * for the same sizes, flags and chroma positions does not have to compute the
+ * filters again. Filters built from an SwsFilter are not cached.
+ *
+ * @param hits   if not NULL, set to the number of filters taken from the cache
+ * @param misses if not NULL, set to the number of filters that were computed
+ */
+void sws_get_filter_cache_stats(int64_t *hits, int64_t *misses);
+
 /**
  * Check if context can be reused, otherwise reallocate a new one.
  *
@@ -32,6 +32,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/bswap.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avconfig.h"
 
@@ -180,53 +181,58 @@ static int nv12ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+/* Net shift of the sample values between two native endian 16-bit formats,
+ * negative for a right shift. */
+static int get_p01x_shift(SwsContext *c, int plane)
+{
+    const AVPixFmtDescriptor *src_format = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
+
+    return dst_format->comp[plane].depth + dst_format->comp[plane].shift -
+           src_format->comp[plane].depth - src_format->comp[plane].shift;
+}
+
 static int planarToP01xWrapper(SwsContext *c, const uint8_t *src8[],
                                int srcStride[], int srcSliceY,
                                int srcSliceH, uint8_t *dstParam8[],
                                int dstStride[])
 {
-    const AVPixFmtDescriptor *src_format = av_pix_fmt_desc_get(c->srcFormat);
-    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
-    const uint16_t **src = (const uint16_t**)src8;
-    uint16_t *dstY = (uint16_t*)(dstParam8[0] + dstStride[0] * srcSliceY);
-    uint16_t *dstUV = (uint16_t*)(dstParam8[1] + dstStride[1] * srcSliceY / 2);
-    int x, y;
-
-    /* Calculate net shift required for values. */
-    const int shift[3] = {
-        dst_format->comp[0].depth + dst_format->comp[0].shift -
-        src_format->comp[0].depth - src_format->comp[0].shift,
-        dst_format->comp[1].depth + dst_format->comp[1].shift -
-        src_format->comp[1].depth - src_format->comp[1].shift,
-        dst_format->comp[2].depth + dst_format->comp[2].shift -
-        src_format->comp[2].depth - src_format->comp[2].shift,
-    };
+    const int shiftY  = get_p01x_shift(c, 0);
+    const int shiftUV = get_p01x_shift(c, 1);
+    uint8_t *dstUV = dstParam8[1] + dstStride[1] * srcSliceY / 2;
 
     av_assert0(!(srcStride[0] % 2 || srcStride[1] % 2 || srcStride[2] % 2 ||
                  dstStride[0] % 2 || dstStride[1] % 2));
 
-    for (y = 0; y < srcSliceH; y++) {
-        uint16_t *tdstY = dstY;
-        const uint16_t *tsrc0 = src[0];
-        for (x = c->srcW; x > 0; x--) {
-            *tdstY++ = *tsrc0++ << shift[0];
-        }
-        src[0] += srcStride[0] / 2;
-        dstY += dstStride[0] / 2;
+    av_image_copy_plane_shift(dstParam8[0] + dstStride[0] * srcSliceY, dstStride[0],
+                              src8[0], srcStride[0], c->srcW, srcSliceH, shiftY);
 
-        if (!(y & 1)) {
-            uint16_t *tdstUV = dstUV;
-            const uint16_t *tsrc1 = src[1];
-            const uint16_t *tsrc2 = src[2];
-            for (x = c->srcW / 2; x > 0; x--) {
-                *tdstUV++ = *tsrc1++ << shift[1];
-                *tdstUV++ = *tsrc2++ << shift[2];
-            }
-            src[1] += srcStride[1] / 2;
-            src[2] += srcStride[2] / 2;
-            dstUV += dstStride[1] / 2;
-        }
-    }
+    av_image_interleave_planes(dstUV, dstStride[1], src8[1], srcStride[1],
+                               src8[2], srcStride[2], AV_CEIL_RSHIFT(c->srcW, 1),
+                               AV_CEIL_RSHIFT(srcSliceH, 1), 2, shiftUV);
+
+    return srcSliceH;
+}
+
+static int p01xToPlanarWrapper(SwsContext *c, const uint8_t *src8[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam8[],
+                               int dstStride[])
+{
+    const int shiftY  = get_p01x_shift(c, 0);
+    const int shiftUV = get_p01x_shift(c, 1);
+    uint8_t *dstU = dstParam8[1] + dstStride[1] * srcSliceY / 2;
+    uint8_t *dstV = dstParam8[2] + dstStride[2] * srcSliceY / 2;
+
+    av_assert0(!(srcStride[0] % 2 || srcStride[1] % 2 ||
+                 dstStride[0] % 2 || dstStride[1] % 2 || dstStride[2] % 2));
+
+    av_image_copy_plane_shift(dstParam8[0] + dstStride[0] * srcSliceY, dstStride[0],
+                              src8[0], srcStride[0], c->srcW, srcSliceH, shiftY);
+
+    av_image_deinterleave_plane(dstU, dstStride[1], dstV, dstStride[2],
+                                src8[1], srcStride[1], AV_CEIL_RSHIFT(c->srcW, 1),
+                                AV_CEIL_RSHIFT(srcSliceH, 1), 2, shiftUV);
 
     return srcSliceH;
 }
@@ -1891,6 +1897,11 @@ void ff_get_unscaled_swscale(SwsContext *c)
         (dstFormat == AV_PIX_FMT_P010 || dstFormat == AV_PIX_FMT_P016)) {
         c->swscale = planarToP01xWrapper;
     }
+    /* p01x_to_yuv420p1x, only where no bits are lost */
+    if ((srcFormat == AV_PIX_FMT_P010 && dstFormat == AV_PIX_FMT_YUV420P10) ||
+        (srcFormat == AV_PIX_FMT_P016 && dstFormat == AV_PIX_FMT_YUV420P16)) {
+        c->swscale = p01xToPlanarWrapper;
+    }
     /* yuv420p_to_p01xle */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUVA420P) &&
         (dstFormat == AV_PIX_FMT_P010LE || dstFormat == AV_PIX_FMT_P016LE)) {
@@ -49,6 +49,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
 #include "libavutil/aarch64/cpu.h"
 #include "libavutil/ppc/cpu.h"
 #include "libavutil/x86/asm.h"
@@ -326,12 +327,12 @@ static const ScaleAlgorithm scale_algorithms[] = {
     { SWS_X,             "experimental",                    8 },
 };
 
-static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
-                              int *outFilterSize, int xInc, int srcW,
-                              int dstW, int filterAlign, int one,
-                              int flags, int cpu_flags,
-                              SwsVector *srcFilter, SwsVector *dstFilter,
-                              double param[2], int srcPos, int dstPos)
+static av_cold int buildFilter(int16_t **outFilter, int32_t **filterPos,
+                               int *outFilterSize, int xInc, int srcW,
+                               int dstW, int filterAlign, int one,
+                               int flags, int cpu_flags,
+                               SwsVector *srcFilter, SwsVector *dstFilter,
+                               double param[2], int srcPos, int dstPos)
 {
     int i;
     int filterSize;
@@ -723,6 +724,113 @@ fail:
     return ret;
 }
 
+/* Filters are kept in a process wide cache, so that contexts created again
+ * and again for the same sizes don't have to evaluate the filter functions
+ * each time. Entries are replaced in FIFO order once the cache is full. */
+#define FILTER_CACHE_SIZE 64
+
+typedef struct FilterCacheEntry {
+    int xInc, srcW, dstW, filterAlign, one, flags, cpu_flags;
+    double param[2];
+    int srcPos, dstPos;
+
+    int filterSize;
+    int16_t *filter;
+    int32_t *filterPos;
+} FilterCacheEntry;
+
+static AVMutex filter_cache_mutex = AV_MUTEX_INITIALIZER;
+static FilterCacheEntry filter_cache[FILTER_CACHE_SIZE];
+static int filter_cache_next;
+static int64_t filter_cache_hits, filter_cache_misses;
+
+static int filter_cache_match(const FilterCacheEntry *e, const FilterCacheEntry *key)
+{
+    return e->filter &&
+           e->xInc        == key->xInc        && e->srcW     == key->srcW     &&
+           e->dstW        == key->dstW        && e->one      == key->one      &&
+           e->filterAlign == key->filterAlign && e->flags    == key->flags    &&
+           e->cpu_flags   == key->cpu_flags   &&
+           e->param[0]    == key->param[0]    && e->param[1] == key->param[1] &&
+           e->srcPos      == key->srcPos      && e->dstPos   == key->dstPos;
+}
+
+static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
+                              int *outFilterSize, int xInc, int srcW,
+                              int dstW, int filterAlign, int one,
+                              int flags, int cpu_flags,
+                              SwsVector *srcFilter, SwsVector *dstFilter,
+                              double param[2], int srcPos, int dstPos)
+{
+    FilterCacheEntry key = { xInc, srcW, dstW, filterAlign, one, flags, cpu_flags,
+                             { param[0], param[1] }, srcPos, dstPos };
+    FilterCacheEntry *e;
+    int i, ret;
+
+    /* filters built from user supplied vectors are not cached */
+    if (srcFilter || dstFilter)
+        return buildFilter(outFilter, filterPos, outFilterSize, xInc, srcW, dstW,
+                           filterAlign, one, flags, cpu_flags, srcFilter,
+                           dstFilter, param, srcPos, dstPos);
+
+    ff_mutex_lock(&filter_cache_mutex);
+    for (i = 0; i < FILTER_CACHE_SIZE; i++) {
+        e = &filter_cache[i];
+        if (filter_cache_match(e, &key)) {
+            *outFilter = av_memdup(e->filter, (dstW + 3) * e->filterSize * sizeof(**outFilter));
+            *filterPos = av_memdup(e->filterPos, (dstW + 3) * sizeof(**filterPos));
+            if (!*outFilter || !*filterPos) {
+                av_freep(outFilter);
+                av_freep(filterPos);
+                ff_mutex_unlock(&filter_cache_mutex);
+                return AVERROR(ENOMEM);
+            }
+            *outFilterSize = e->filterSize;
+            filter_cache_hits++;
+            ff_mutex_unlock(&filter_cache_mutex);
+            return 0;
+        }
+    }
+    filter_cache_misses++;
+    ff_mutex_unlock(&filter_cache_mutex);
+
+    ret = buildFilter(outFilter, filterPos, outFilterSize, xInc, srcW, dstW,
+                      filterAlign, one, flags, cpu_flags, NULL, NULL,
+                      param, srcPos, dstPos);
+    if (ret < 0)
+        return ret;
+
+    key.filterSize = *outFilterSize;
+    key.filter     = av_memdup(*outFilter, (dstW + 3) * key.filterSize * sizeof(**outFilter));
+    key.filterPos  = av_memdup(*filterPos, (dstW + 3) * sizeof(**filterPos));
+    if (!key.filter || !key.filterPos) {
+        /* the cache is only an optimization */
+        av_free(key.filter);
+        av_free(key.filterPos);
+        return 0;
+    }
+
+    ff_mutex_lock(&filter_cache_mutex);
+    e = &filter_cache[filter_cache_next];
+    av_free(e->filter);
+    av_free(e->filterPos);
+    *e = key;
+    filter_cache_next = (filter_cache_next + 1) % FILTER_CACHE_SIZE;
+    ff_mutex_unlock(&filter_cache_mutex);
+
+    return 0;
+}
+
+void sws_get_filter_cache_stats(int64_t *hits, int64_t *misses)
+{
+    ff_mutex_lock(&filter_cache_mutex);
+    if (hits)
+        *hits = filter_cache_hits;
+    if (misses)
+        *misses = filter_cache_misses;
+    ff_mutex_unlock(&filter_cache_mutex);
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1181,7 +1289,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     enum AVPixelFormat tmpFmt;
     static const float float_mult = 1.0f / 255.0f;
 
-    cpu_flags = av_get_cpu_flags();
+    cpu_flags = av_cpu_get_subsystem_flags("swscale");
     flags     = c->flags;
     emms_c();
     if (!rgb15to16)
@@ -423,3 +423,169 @@ yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
 yuv2plane1_fn 16, 5, 3
 %endif
+
+;-----------------------------------------------------------------------------
+; void yuv2planeX_<output_size>_avx2(const int16_t *filter, int filterSize,
+;                                    const int16_t **src, uint8_t *dst, int w,
+;                                    const int32_t *init)
+; void yuv2plane1_<output_size>_avx2(const int16_t *src, uint8_t *dst, int w,
+;                                    const int16_t *dither)
+;
+; Same as above for a multiple of 16 (32 for yuv2plane1_8) output pixels, the
+; caller does the rest. Two source lines are interleaved and multiplied with
+; the coefficient pair by pmaddwd. $init holds the start values of the sums
+; in the order of the accumulators, outputs 0-3|8-11 and 4-7|12-15. $dither
+; holds 16 words. yuv2planeX_16 and yuv2plane1_{9-16} don't take $init and
+; $dither.
+;-----------------------------------------------------------------------------
+%macro yuv2planeX_avx2_fn 1
+%if %1 == 16
+cglobal yuv2planeX_%1, 5, 10, 5, filter, fltsize, src, dst, w, off, srcp, fltp, cnt, line
+%else
+cglobal yuv2planeX_%1, 6, 12, 7, filter, fltsize, src, dst, w, init, off, srcp, fltp, cnt, \
+                                 line0, line1
+%endif
+    xor           offq, offq
+%if %1 != 8 && %1 != 16
+    pcmpeqw         m6, m6
+    psrlw           m6, 16 - %1
+%endif
+.loop:
+    mov          srcpq, srcq
+    mov          fltpq, filterq
+    mov           cntd, fltsized
+%if %1 == 16
+    vpbroadcastd    m0, [yuv2yuvX_16_start]
+    mova            m1, m0
+.lines:
+    mov          lineq, [srcpq]
+    vpbroadcastw   xm4, [fltpq]
+    pmovsxwd        m4, xm4
+    pmulld          m2, m4, [lineq+offq]
+    pmulld          m3, m4, [lineq+offq+mmsize]
+    paddd           m0, m2
+    paddd           m1, m3
+    add          srcpq, gprsize
+    add          fltpq, 2
+    dec           cntd
+    jnz .lines
+
+    psrad           m0, 15
+    psrad           m1, 15
+    packssdw        m0, m1
+    vpermq          m0, m0, q3120
+    pcmpeqw         m1, m1
+    psllw           m1, 15
+    pxor            m0, m1
+    movu        [dstq], m0
+    add           dstq, mmsize
+    add           offq, mmsize * 2
+%else ; %1 != 16
+    mova            m0, [initq]
+    mova            m1, [initq+mmsize]
+    shr           cntd, 1
+.lines:
+    mov         line0q, [srcpq]
+    mov         line1q, [srcpq+gprsize]
+    movu            m2, [line0q+offq]
+    movu            m3, [line1q+offq]
+    vpbroadcastd    m4, [fltpq]
+    punpckhwd       m5, m2, m3
+    punpcklwd       m2, m3
+    pmaddwd         m2, m4
+    pmaddwd         m5, m4
+    paddd           m0, m2
+    paddd           m1, m5
+    add          srcpq, gprsize * 2
+    add          fltpq, 4
+    dec           cntd
+    jnz .lines
+%if %1 == 8
+    psrad           m0, 19
+    psrad           m1, 19
+    packssdw        m0, m1
+    packuswb        m0, m0
+    vpermq          m0, m0, q0020
+    movu        [dstq], xm0
+    add           dstq, mmsize / 2
+%else ; %1 == 9-14
+    psrad           m0, 27 - %1
+    psrad           m1, 27 - %1
+    packusdw        m0, m1
+    pminuw          m0, m6
+    movu        [dstq], m0
+    add           dstq, mmsize
+%endif ; %1 == 8/9-14
+    add           offq, mmsize
+%endif ; %1 ==/!= 16
+    sub             wd, 16
+    jg .loop
+    RET
+%endmacro
+
+%macro yuv2plane1_avx2_fn 1
+%if %1 == 8
+cglobal yuv2plane1_%1, 4, 4, 3, src, dst, w, dither
+    mova            m2, [ditherq]
+.loop:
+    paddsw          m0, m2, [srcq]
+    paddsw          m1, m2, [srcq+mmsize]
+    psraw           m0, 7
+    psraw           m1, 7
+    packuswb        m0, m1
+    vpermq          m0, m0, q3120
+    movu        [dstq], m0
+    add           srcq, mmsize * 2
+    add           dstq, mmsize
+    sub             wd, 32
+%elif %1 == 16
+cglobal yuv2plane1_%1, 3, 3, 3, src, dst, w
+    vpbroadcastd    m2, [pd_4]
+.loop:
+    paddd           m0, m2, [srcq]
+    paddd           m1, m2, [srcq+mmsize]
+    psrad           m0, 3
+    psrad           m1, 3
+    packusdw        m0, m1
+    vpermq          m0, m0, q3120
+    movu        [dstq], m0
+    add           srcq, mmsize * 2
+    add           dstq, mmsize
+    sub             wd, 16
+%else ; %1 == 9-14
+cglobal yuv2plane1_%1, 3, 3, 5, src, dst, w
+    pcmpeqw         m1, m1
+    psrlw           m1, 15
+    psllw           m1, 14 - %1
+    pcmpeqw         m2, m2
+    psrlw           m2, 16 - %1
+    pxor            m4, m4
+.loop:
+    paddsw          m0, m1, [srcq]
+    psraw           m0, 15 - %1
+    pmaxsw          m0, m4
+    pminsw          m0, m2
+    movu        [dstq], m0
+    add           srcq, mmsize
+    add           dstq, mmsize
+    sub             wd, 16
+%endif ; %1 == 8/16/9-14
+    jg .loop
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2planeX_avx2_fn  8
+yuv2planeX_avx2_fn  9
+yuv2planeX_avx2_fn 10
+yuv2planeX_avx2_fn 12
+yuv2planeX_avx2_fn 14
+yuv2planeX_avx2_fn 16
+yuv2plane1_avx2_fn  8
+yuv2plane1_avx2_fn  9
+yuv2plane1_avx2_fn 10
+yuv2plane1_avx2_fn 12
+yuv2plane1_avx2_fn 14
+yuv2plane1_avx2_fn 16
+%endif
@@ -162,7 +162,7 @@ void ff_uyvytoyuv422_avx(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
 
 av_cold void rgb2rgb_init_x86(void)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swscale");
 
 #if HAVE_INLINE_ASM
     if (INLINE_MMX(cpu_flags))
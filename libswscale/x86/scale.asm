@@ -24,6 +24,7 @@
 SECTION_RODATA
 
 max_19bit_int: times 4 dd 0x7ffff
+max_15bit_int: times 4 dd 0x7fff
 max_19bit_flt: times 4 dd 524287.0
 minshort:      times 8 dw 0x8000
 unicoeff:      times 4 dd 0x20000000
@@ -421,3 +422,196 @@ INIT_XMM ssse3
 SCALE_FUNCS2 6, 6, 8
 INIT_XMM sse4
 SCALE_FUNCS2 6, 6, 8
+
+;-----------------------------------------------------------------------------
+; void hscale<source>to<intermediate_nbits>_<filterSize>_avx2
+;                               (int{16,32}_t *dst, int w, const uint{8,16}_t *src,
+;                                const int16_t *filter, const int32_t *filterPos,
+;                                int filterSize, int shift);
+;
+; Same as above for a multiple of 8 output pixels, the sums are shifted down
+; by $shift and clipped like in the C code. $source is 8, 16 or 16u, the last
+; one flips the sign of the samples and adds the bias back after the multiply,
+; so that full range 16-bit samples don't overflow pmaddwd. The generic
+; version keeps one accumulator per output and steps through the taps 16, 8
+; and 4 at a time, the 4-tap version gathers the taps of eight outputs at once.
+;-----------------------------------------------------------------------------
+
+; HSCALE_MADD source, reg, addr
+%macro HSCALE_MADD 3
+%ifidn %1, 16u
+%if sizeof%2 == 32
+    pxor             %2, %2, m13
+    pmaddwd          %2, %2, %3
+    pmaddwd         m14, m13, %3
+    psubd            %2, %2, m14
+%else
+    pxor             %2, %2, xm13
+    pmaddwd          %2, %2, %3
+    pmaddwd        xm14, xm13, %3
+    psubd            %2, %2, xm14
+%endif
+%else
+    pmaddwd          %2, %2, %3
+%endif
+%endmacro
+
+; HSCALE_TAPS source, ntaps
+%macro HSCALE_TAPS 2
+%assign %%k 0
+%rep 8
+    movsxd         tmpq, dword [fltposq+%%k*4]
+%ifidn %1, 8
+%if %2 == 16
+    pmovzxbw       m15, [srcpq+tmpq]
+%elif %2 == 8
+    pmovzxbw      xm15, [srcpq+tmpq]
+%else
+    movd          xm15, [srcpq+tmpq]
+    pmovzxbw      xm15, xm15
+%endif
+%else
+%if %2 == 16
+    movu           m15, [srcpq+tmpq*2]
+%elif %2 == 8
+    movu          xm15, [srcpq+tmpq*2]
+%else
+    movq          xm15, [srcpq+tmpq*2]
+%endif
+%endif
+%if %2 == 16
+    HSCALE_MADD     %1, m15, [fltpq]
+%elif %2 == 8
+    HSCALE_MADD     %1, xm15, [fltpq]
+%else
+    movq          xm12, [fltpq]
+    HSCALE_MADD     %1, xm15, xm12
+%endif
+    add           fltpq, fs2q
+    paddd         m %+ %%k, m15
+%assign %%k %%k+1
+%endrep
+%endmacro
+
+; HSCALE_FUNC source, intermediate_nbits, filtersize
+%macro HSCALE_FUNC 3
+%ifidn %3, 4
+cglobal hscale%1to%2_%3, 7, 9, 16, dst, w, src, filter, fltpos, fltsize, shift, fs2, fs16
+%else
+cglobal hscale%1to%2_%3, 7, 13, 16, dst, w, src, filter, fltpos, fltsize, shift, \
+                                    fs2, fs16, srcp, fltp, cnt, tmp
+%endif
+%ifidn %1, 8
+%define srcmul 1
+%else
+%define srcmul 2
+%endif
+    movd           xm8, shiftd
+    vpbroadcastd    m9, [max_%2bit_int]
+    vbroadcasti128 m13, [minshort]
+    movsxdifnidn fltsizeq, fltsized
+    lea            fs2q, [fltsizeq*2]
+    lea           fs16q, [fltsizeq*8]
+    add           fs16q, fs16q
+
+.loop:
+%ifidn %3, 4
+%ifidn %1, 8
+    movu            m1, [fltposq]
+    pcmpeqd         m2, m2
+    vpgatherdd      m0, [srcq+m1], m2
+    vextracti128   xm2, m0, 1
+    pmovzxbw        m1, xm0
+    pmovzxbw        m2, xm2
+%else
+    movu           xm3, [fltposq]
+    movu           xm4, [fltposq+16]
+    pcmpeqd         m5, m5
+    vpgatherdq      m1, [srcq+xm3*2], m5
+    pcmpeqd         m5, m5
+    vpgatherdq      m2, [srcq+xm4*2], m5
+%endif
+    HSCALE_MADD     %1, m1, [filterq]
+    HSCALE_MADD     %1, m2, [filterq+32]
+    phaddd          m0, m1, m2
+    vpermq          m0, m0, q3120
+%else ; X4
+    pxor           xm0, xm0
+    pxor           xm1, xm1
+    pxor           xm2, xm2
+    pxor           xm3, xm3
+    pxor           xm4, xm4
+    pxor           xm5, xm5
+    pxor           xm6, xm6
+    pxor           xm7, xm7
+    mov           srcpq, srcq
+    mov           fltpq, filterq
+    mov            cntq, fltsizeq
+    shr            cntq, 4
+    jz .taps8
+.taps16:
+    HSCALE_TAPS     %1, 16
+    sub           fltpq, fs16q
+    add           fltpq, 32
+    add           srcpq, 16 * srcmul
+    dec            cntq
+    jnz .taps16
+.taps8:
+    test       fltsized, 8
+    jz .taps4
+    HSCALE_TAPS     %1, 8
+    sub           fltpq, fs16q
+    add           fltpq, 16
+    add           srcpq, 8 * srcmul
+.taps4:
+    test       fltsized, 4
+    jz .sum
+    HSCALE_TAPS     %1, 4
+.sum:
+    phaddd          m0, m1
+    phaddd          m2, m3
+    phaddd          m4, m5
+    phaddd          m6, m7
+    phaddd          m0, m2
+    phaddd          m4, m6
+    vperm2i128      m1, m0, m4, 0x20
+    vperm2i128      m2, m0, m4, 0x31
+    paddd           m0, m1, m2
+%endif ; 4/X4
+
+    psrad           m0, xm8
+    pminsd          m0, m9
+%if %2 == 15
+    ; keep the low 16 bits of each sum, like the int16_t store in C
+    pxor           xm1, xm1
+    pblendw         m0, m1, 0xAA
+    vextracti128   xm1, m0, 1
+    packusdw       xm0, xm1
+    movu        [dstq], xm0
+    add            dstq, 16
+%else
+    movu        [dstq], m0
+    add            dstq, 32
+%endif
+    add         fltposq, 32
+    add         filterq, fs16q
+    sub              wd, 8
+    jg .loop
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+HSCALE_FUNC   8, 15, 4
+HSCALE_FUNC   8, 15, X4
+HSCALE_FUNC   8, 19, 4
+HSCALE_FUNC   8, 19, X4
+HSCALE_FUNC  16, 15, 4
+HSCALE_FUNC  16, 15, X4
+HSCALE_FUNC  16, 19, 4
+HSCALE_FUNC  16, 19, X4
+HSCALE_FUNC 16u, 15, 4
+HSCALE_FUNC 16u, 15, X4
+HSCALE_FUNC 16u, 19, 4
+HSCALE_FUNC 16u, 19, X4
+%endif
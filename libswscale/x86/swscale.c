@@ -349,6 +349,258 @@ VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
 
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+#define HSCALE_AVX2_FUNC(filter_n, from, nbits) \
+void ff_hscale ## from ## to ## nbits ## _ ## filter_n ## _avx2(int16_t *dst, int w, \
+                                                         const uint8_t *src, \
+                                                         const int16_t *filter, \
+                                                         const int32_t *filterPos, \
+                                                         int filterSize, int shift)
+#define HSCALE_AVX2_FUNCS(from, nbits) \
+    HSCALE_AVX2_FUNC(4,  from, nbits); \
+    HSCALE_AVX2_FUNC(X4, from, nbits)
+
+HSCALE_AVX2_FUNCS(8,   15);
+HSCALE_AVX2_FUNCS(8,   19);
+HSCALE_AVX2_FUNCS(16,  15);
+HSCALE_AVX2_FUNCS(16,  19);
+HSCALE_AVX2_FUNCS(16u, 15);
+HSCALE_AVX2_FUNCS(16u, 19);
+
+typedef void (*hscale_avx2_fn)(int16_t *dst, int w, const uint8_t *src,
+                               const int16_t *filter, const int32_t *filterPos,
+                               int filterSize, int shift);
+
+/* The asm does multiples of 8 outputs, the filter size is always a multiple
+ * of 4 on x86. */
+static av_always_inline void hscale_avx2(int16_t *dst, int dstW, const uint8_t *src,
+                                         const int16_t *filter, const int32_t *filterPos,
+                                         int filterSize, hscale_avx2_fn fn4,
+                                         hscale_avx2_fn fnX, int src16, int sh, int to19)
+{
+    const int max = to19 ? (1 << 19) - 1 : (1 << 15) - 1;
+    int i = dstW & ~7;
+
+    if (i)
+        (filterSize == 4 ? fn4 : fnX)(dst, i, src, filter, filterPos, filterSize, sh);
+
+    for (; i < dstW; i++) {
+        int srcPos = filterPos[i];
+        int val    = 0;
+        int j;
+
+        for (j = 0; j < filterSize; j++)
+            val += (src16 ? ((const uint16_t *)src)[srcPos + j] : src[srcPos + j]) *
+                   filter[filterSize * i + j];
+        if (to19)
+            ((int32_t *)dst)[i] = FFMIN(val >> sh, max);
+        else
+            dst[i] = FFMIN(val >> sh, max);
+    }
+}
+
+/* Same shifts as hScale16To15_c() and hScale16To19_c() */
+static int hscale16_shift(SwsContext *c, int to19)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int rgb = isAnyRGB(c->srcFormat) || c->srcFormat == AV_PIX_FMT_PAL8;
+
+    if (to19) {
+        if (rgb && desc->comp[0].depth < 16)
+            return 9;
+        if (desc->flags & AV_PIX_FMT_FLAG_FLOAT)
+            return 16 - 1 - 4;
+        return desc->comp[0].depth - 1 - 4;
+    }
+    if (desc->comp[0].depth - 1 < 15)
+        return rgb ? 13 : desc->comp[0].depth - 1;
+    if (desc->flags & AV_PIX_FMT_FLAG_FLOAT)
+        return 16 - 1;
+    return desc->comp[0].depth - 1;
+}
+
+#define HSCALE_FUNC(from, nbits, src16, sh) \
+static void hscale ## from ## to ## nbits ## _avx2(SwsContext *c, int16_t *dst, int dstW, \
+                                                   const uint8_t *src, const int16_t *filter, \
+                                                   const int32_t *filterPos, int filterSize) \
+{ \
+    hscale_avx2(dst, dstW, src, filter, filterPos, filterSize, \
+                ff_hscale ## from ## to ## nbits ## _4_avx2, \
+                ff_hscale ## from ## to ## nbits ## _X4_avx2, src16, sh, nbits == 19); \
+}
+
+HSCALE_FUNC(8,   15, 0, 7)
+HSCALE_FUNC(8,   19, 0, 3)
+HSCALE_FUNC(16,  15, 1, hscale16_shift(c, 0))
+HSCALE_FUNC(16,  19, 1, hscale16_shift(c, 1))
+HSCALE_FUNC(16u, 15, 1, hscale16_shift(c, 0))
+HSCALE_FUNC(16u, 19, 1, hscale16_shift(c, 1))
+
+#define VSCALEX_AVX2_FUNC(size) \
+void ff_yuv2planeX_ ## size ## _avx2(const int16_t *filter, int filterSize, \
+                                     const int16_t **src, uint8_t *dest, int w, \
+                                     const int32_t *init)
+#define VSCALE_AVX2_FUNC(size) \
+void ff_yuv2plane1_ ## size ## _avx2(const int16_t *src, uint8_t *dest, int w, \
+                                     const int16_t *dither)
+
+VSCALEX_AVX2_FUNC(8);
+VSCALEX_AVX2_FUNC(9);
+VSCALEX_AVX2_FUNC(10);
+VSCALEX_AVX2_FUNC(12);
+VSCALEX_AVX2_FUNC(14);
+void ff_yuv2planeX_16_avx2(const int16_t *filter, int filterSize,
+                           const int16_t **src, uint8_t *dest, int w);
+VSCALE_AVX2_FUNC(8);
+void ff_yuv2plane1_9_avx2(const int16_t *src, uint8_t *dest, int w);
+void ff_yuv2plane1_10_avx2(const int16_t *src, uint8_t *dest, int w);
+void ff_yuv2plane1_12_avx2(const int16_t *src, uint8_t *dest, int w);
+void ff_yuv2plane1_14_avx2(const int16_t *src, uint8_t *dest, int w);
+void ff_yuv2plane1_16_avx2(const int16_t *src, uint8_t *dest, int w);
+
+static void yuv2planeX_8_avx2(const int16_t *filter, int filterSize,
+                              const int16_t **src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset)
+{
+    DECLARE_ALIGNED(32, int32_t, init)[16];
+    int i, j;
+
+    /* accumulators hold outputs 0-3|8-11 and 4-7|12-15 */
+    for (i = 0; i < 4; i++) {
+        init[i]      = init[i + 4]  = dither[(i     + offset) & 7] << 12;
+        init[i + 8]  = init[i + 12] = dither[(i + 4 + offset) & 7] << 12;
+    }
+
+    i = dstW & ~15;
+    if (i)
+        ff_yuv2planeX_8_avx2(filter, filterSize, src, dest, i, init);
+
+    for (; i < dstW; i++) {
+        int val = dither[(i + offset) & 7] << 12;
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+        dest[i] = av_clip_uint8(val >> 19);
+    }
+}
+
+static av_always_inline void yuv2planeX_N_avx2(const int16_t *filter, int filterSize,
+                                               const int16_t **src, uint16_t *dest,
+                                               int dstW, int output_bits)
+{
+    DECLARE_ALIGNED(32, int32_t, init)[16];
+    const int shift = 11 + 16 - output_bits;
+    int i, j;
+
+    for (i = 0; i < 16; i++)
+        init[i] = 1 << (shift - 1);
+
+    i = dstW & ~15;
+    if (i) {
+        switch (output_bits) {
+        case  9: ff_yuv2planeX_9_avx2 (filter, filterSize, src, (uint8_t *)dest, i, init); break;
+        case 10: ff_yuv2planeX_10_avx2(filter, filterSize, src, (uint8_t *)dest, i, init); break;
+        case 12: ff_yuv2planeX_12_avx2(filter, filterSize, src, (uint8_t *)dest, i, init); break;
+        case 14: ff_yuv2planeX_14_avx2(filter, filterSize, src, (uint8_t *)dest, i, init); break;
+        }
+    }
+
+    for (; i < dstW; i++) {
+        int val = 1 << (shift - 1);
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+        AV_WL16(&dest[i], av_clip_uintp2(val >> shift, output_bits));
+    }
+}
+
+static void yuv2planeX_16_avx2(const int16_t *filter, int filterSize,
+                               const int16_t **_src, uint8_t *_dest, int dstW,
+                               const uint8_t *dither, int offset)
+{
+    const int32_t **src = (const int32_t **)_src;
+    uint16_t *dest      = (uint16_t *)_dest;
+    int i = dstW & ~15, j;
+
+    if (i)
+        ff_yuv2planeX_16_avx2(filter, filterSize, _src, _dest, i);
+
+    for (; i < dstW; i++) {
+        int val = (1 << 14) - 0x40000000;
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * (unsigned)filter[j];
+        AV_WL16(&dest[i], 0x8000 + av_clip_int16(val >> 15));
+    }
+}
+
+static void yuv2plane1_8_avx2(const int16_t *src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset)
+{
+    DECLARE_ALIGNED(32, int16_t, dith)[16];
+    int i;
+
+    for (i = 0; i < 16; i++)
+        dith[i] = dither[(i + offset) & 7];
+
+    /* src + dither may exceed int16 only where the result clips to 255 */
+    i = dstW & ~31;
+    if (i)
+        ff_yuv2plane1_8_avx2(src, dest, i, dith);
+
+    for (; i < dstW; i++)
+        dest[i] = av_clip_uint8((src[i] + dither[(i + offset) & 7]) >> 7);
+}
+
+static av_always_inline void yuv2plane1_N_avx2(const int16_t *src, uint16_t *dest,
+                                               int dstW, int output_bits)
+{
+    const int shift = 15 - output_bits;
+    int i = dstW & ~15;
+
+    if (i) {
+        switch (output_bits) {
+        case  9: ff_yuv2plane1_9_avx2 (src, (uint8_t *)dest, i); break;
+        case 10: ff_yuv2plane1_10_avx2(src, (uint8_t *)dest, i); break;
+        case 12: ff_yuv2plane1_12_avx2(src, (uint8_t *)dest, i); break;
+        case 14: ff_yuv2plane1_14_avx2(src, (uint8_t *)dest, i); break;
+        }
+    }
+
+    for (; i < dstW; i++)
+        AV_WL16(&dest[i], av_clip_uintp2((src[i] + (1 << (shift - 1))) >> shift, output_bits));
+}
+
+static void yuv2plane1_16_avx2(const int16_t *_src, uint8_t *_dest, int dstW,
+                               const uint8_t *dither, int offset)
+{
+    const int32_t *src = (const int32_t *)_src;
+    uint16_t *dest     = (uint16_t *)_dest;
+    int i = dstW & ~15;
+
+    if (i)
+        ff_yuv2plane1_16_avx2(_src, _dest, i);
+
+    for (; i < dstW; i++)
+        AV_WL16(&dest[i], av_clip_uint16((src[i] + 4) >> 3));
+}
+
+#define YUV2PLANE_N_FUNCS(bits) \
+static void yuv2planeX_ ## bits ## _avx2(const int16_t *filter, int filterSize, \
+                                         const int16_t **src, uint8_t *dest, int dstW, \
+                                         const uint8_t *dither, int offset) \
+{ \
+    yuv2planeX_N_avx2(filter, filterSize, src, (uint16_t *)dest, dstW, bits); \
+} \
+static void yuv2plane1_ ## bits ## _avx2(const int16_t *src, uint8_t *dest, int dstW, \
+                                         const uint8_t *dither, int offset) \
+{ \
+    yuv2plane1_N_avx2(src, (uint16_t *)dest, dstW, bits); \
+}
+
+YUV2PLANE_N_FUNCS(9)
+YUV2PLANE_N_FUNCS(10)
+YUV2PLANE_N_FUNCS(12)
+YUV2PLANE_N_FUNCS(14)
+#endif /* HAVE_AVX2_EXTERNAL && ARCH_X86_64 */
+
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
                                 const uint8_t *unused1, const uint8_t *unused2, \
@@ -383,7 +635,7 @@ INPUT_FUNCS(avx);
 
 av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 {
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swscale");
 
 #if HAVE_MMX_INLINE
     if (INLINE_MMX(cpu_flags))
@@ -581,4 +833,58 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        if (c->srcBpc == 8) {
+            c->hyScale = c->hcScale = c->dstBpc <= 14 ? hscale8to15_avx2
+                                                      : hscale8to19_avx2;
+        } else {
+            /* only full range 16-bit samples need the biased multiply */
+            int bias = (c->srcFormat == AV_PIX_FMT_PAL8 || isAnyRGB(c->srcFormat)) ?
+                       av_pix_fmt_desc_get(c->srcFormat)->comp[0].depth >= 16 :
+                       c->srcBpc == 16;
+            if (c->dstBpc <= 14)
+                c->hyScale = c->hcScale = bias ? hscale16uto15_avx2 : hscale16to15_avx2;
+            else
+                c->hyScale = c->hcScale = bias ? hscale16uto19_avx2 : hscale16to19_avx2;
+        }
+
+        /* mirrors the choice of the C functions in ff_sws_init_output_funcs() */
+        if (c->dstFormat == AV_PIX_FMT_P010LE || c->dstFormat == AV_PIX_FMT_P010BE ||
+            c->dstFormat == AV_PIX_FMT_GRAYF32LE || c->dstFormat == AV_PIX_FMT_GRAYF32BE) {
+            /* these have output functions of their own */
+        } else if (is16BPS(c->dstFormat)) {
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_16_avx2;
+                c->yuv2plane1 = yuv2plane1_16_avx2;
+            }
+        } else if (isNBPS(c->dstFormat)) {
+            if (!isBE(c->dstFormat)) {
+                switch (av_pix_fmt_desc_get(c->dstFormat)->comp[0].depth) {
+                case 9:
+                    c->yuv2planeX = yuv2planeX_9_avx2;
+                    c->yuv2plane1 = yuv2plane1_9_avx2;
+                    break;
+                case 10:
+                    c->yuv2planeX = yuv2planeX_10_avx2;
+                    c->yuv2plane1 = yuv2plane1_10_avx2;
+                    break;
+                case 12:
+                    c->yuv2planeX = yuv2planeX_12_avx2;
+                    c->yuv2plane1 = yuv2plane1_12_avx2;
+                    break;
+                case 14:
+                    c->yuv2planeX = yuv2planeX_14_avx2;
+                    c->yuv2plane1 = yuv2plane1_14_avx2;
+                    break;
+                }
+            }
+        } else {
+            if (!c->use_mmx_vfilter)
+                c->yuv2planeX = yuv2planeX_8_avx2;
+            c->yuv2plane1 = yuv2plane1_8_avx2;
+        }
+    }
+#endif
 }
@@ -72,7 +72,7 @@ DECLARE_ASM_CONST(8, uint64_t, pb_07) = 0x0707070707070707ULL;
 av_cold SwsFunc ff_yuv2rgb_init_x86(SwsContext *c)
 {
 #if HAVE_MMX_INLINE && HAVE_6REGS
-    int cpu_flags = av_get_cpu_flags();
+    int cpu_flags = av_cpu_get_subsystem_flags("swscale");
 
 #if HAVE_MMXEXT_INLINE
     if (INLINE_MMXEXT(cpu_flags)) {
@@ -124,6 +124,9 @@ static const struct {
     #if CONFIG_JPEG2000_DECODER
         { "jpeg2000dsp", checkasm_check_jpeg2000dsp },
     #endif
+    #if CONFIG_JPEG2000_ENCODER
+        { "jpeg2000dwt", checkasm_check_jpeg2000dwt },
+    #endif
     #if CONFIG_HUFFYUVDSP
         { "llviddsp", checkasm_check_llviddsp },
     #endif
@@ -133,6 +136,9 @@ static const struct {
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
     #endif
+    #if CONFIG_SNOW_DECODER
+        { "snowdsp", checkasm_check_snowdsp },
+    #endif
     #if CONFIG_UTVIDEO_DECODER
         { "utvideodsp", checkasm_check_utvideodsp },
     #endif
@@ -169,12 +175,17 @@ static const struct {
         { "vf_threshold", checkasm_check_vf_threshold },
     #endif
 #endif
+#if CONFIG_SWRESAMPLE
+    { "sw_resample", checkasm_check_sw_resample },
+#endif
 #if CONFIG_SWSCALE
     { "sw_rgb", checkasm_check_sw_rgb },
+    { "sw_scale", checkasm_check_sw_scale },
 #endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
         { "float_dsp", checkasm_check_float_dsp },
+        { "imgutils", checkasm_check_imgutils },
 #endif
     { NULL }
 };
@@ -234,6 +245,8 @@ typedef struct CheckasmFuncVersion {
 typedef struct CheckasmFunc {
     struct CheckasmFunc *child[2];
     CheckasmFuncVersion versions;
+    CheckasmFuncVersion *selected; /* version for the last cpu flags tested */
+    const char *test_name;
     uint8_t color; /* 0 = red, 1 = black */
     char name[1];
 } CheckasmFunc;
@@ -246,6 +259,7 @@ static struct {
     const char *current_test_name;
     const char *bench_pattern;
     int bench_pattern_len;
+    int print_dispatch;
     int num_checked;
     int num_failed;
 
@@ -488,6 +502,17 @@ static void print_benchs(CheckasmFunc *f)
     }
 }
 
+/* Print the implementation each function resolved to with all cpu flags */
+static void print_dispatch(CheckasmFunc *f)
+{
+    if (f) {
+        print_dispatch(f->child[0]);
+        if (f->selected)
+            printf("%-16s %-40s %s\n", f->test_name, f->name, cpu_suffix(f->selected->cpu));
+        print_dispatch(f->child[1]);
+    }
+}
+
 /* ASCIIbetical sort except preserving natural order for numbers */
 static int cmp_func_names(const char *a, const char *b)
 {
@@ -674,6 +699,24 @@ int main(int argc, char *argv[])
                 state.bench_pattern = "";
         } else if (!strncmp(argv[1], "--test=", 7)) {
             state.test_name = argv[1] + 7;
+        } else if (!strcmp(argv[1], "--dispatch")) {
+            state.print_dispatch = 1;
+        } else if (!strncmp(argv[1], "--cpuflags-subsystem=", 21)) {
+            char name[32];
+            const char *arg = argv[1] + 21, *flags_str = strchr(arg, '=');
+            unsigned flags = av_get_cpu_flags();
+
+            if (!flags_str || flags_str - arg >= sizeof(name)) {
+                fprintf(stderr, "checkasm: expected --cpuflags-subsystem=subsystem=flags\n");
+                return 1;
+            }
+            memcpy(name, arg, flags_str - arg);
+            name[flags_str - arg] = 0;
+            if (av_parse_cpu_caps(&flags, flags_str + 1) < 0 ||
+                av_cpu_set_subsystem_mask(name, flags) < 0) {
+                fprintf(stderr, "checkasm: invalid subsystem or flags %s\n", arg);
+                return 1;
+            }
         } else {
             seed = strtoul(argv[1], NULL, 10);
         }
@@ -697,6 +740,8 @@ int main(int argc, char *argv[])
         if (state.bench_pattern) {
             print_benchs(state.funcs);
         }
+        if (state.print_dispatch)
+            print_dispatch(state.funcs);
     }
 
     destroy_func_tree(state.funcs);
@@ -730,8 +775,10 @@ void *checkasm_check_func(void *func, const char *name, ...)
         CheckasmFuncVersion *prev;
         do {
             /* Only test functions that haven't already been tested */
-            if (v->func == func)
+            if (v->func == func) {
+                state.current_func->selected = v;
                 return NULL;
+            }
 
             if (v->ok)
                 ref = v->func;
@@ -746,6 +793,8 @@ void *checkasm_check_func(void *func, const char *name, ...)
     v->ok = 1;
     v->cpu = state.cpu_flag;
     state.current_func_ver = v;
+    state.current_func->selected  = v;
+    state.current_func->test_name = state.current_test_name;
 
     if (state.cpu_flag)
         state.num_checked++;
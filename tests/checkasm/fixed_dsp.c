@@ -36,6 +36,10 @@
         }                                     \
     } while (0)
 
+/* Lengths for the functions that only need a multiple of 4 elements, which
+ * also exercise the tails after the full vectors of the SIMD versions. */
+static const int tail_lens[] = { 4, 8, 12, 20, 28, 52 };
+
 static void check_vector_fmul(const int *src0, const int *src1)
 {
     LOCAL_ALIGNED_32(int, ref, [BUF_SIZE]);
@@ -68,13 +72,19 @@ static void check_vector_fmul_window(const int32_t *src0, const int32_t *src1, c
 {
     LOCAL_ALIGNED_32(int32_t, ref, [BUF_SIZE]);
     LOCAL_ALIGNED_32(int32_t, new, [BUF_SIZE]);
+    int i, len;
 
     declare_func(void, int32_t *dst, const int32_t *src0, const int32_t *src1, const int32_t *win, int len);
 
-    call_ref(ref, src0, src1, win, BUF_SIZE / 2);
-    call_new(new, src0, src1, win, BUF_SIZE / 2);
-    if (memcmp(ref, new, BUF_SIZE * sizeof(int32_t)))
-        fail();
+    for (i = 0; i <= FF_ARRAY_ELEMS(tail_lens); i++) {
+        len = i ? tail_lens[i - 1] : BUF_SIZE / 2;
+        memset(ref, 0, BUF_SIZE * sizeof(int32_t));
+        memset(new, 0, BUF_SIZE * sizeof(int32_t));
+        call_ref(ref, src0, src1, win, len);
+        call_new(new, src0, src1, win, len);
+        if (memcmp(ref, new, BUF_SIZE * sizeof(int32_t)))
+            fail();
+    }
     bench_new(new, src0, src1, win, BUF_SIZE / 2);
 }
 
@@ -82,13 +92,22 @@ static void check_vector_fmul_window_scaled(const int32_t *src0, const int32_t *
 {
     LOCAL_ALIGNED_16(int16_t, ref, [BUF_SIZE]);
     LOCAL_ALIGNED_16(int16_t, new, [BUF_SIZE]);
+    static const uint8_t bits[] = { 0, 2, 8 };
+    int i, j, len;
 
     declare_func(void, int16_t *dst, const int32_t *src0, const int32_t *src1, const int32_t *win, int len, uint8_t bits);
 
-    call_ref(ref, src0, src1, win, BUF_SIZE / 2, 2);
-    call_new(new, src0, src1, win, BUF_SIZE / 2, 2);
-    if (memcmp(ref, new, BUF_SIZE * sizeof(int16_t)))
-        fail();
+    for (j = 0; j < FF_ARRAY_ELEMS(bits); j++) {
+        for (i = 0; i <= FF_ARRAY_ELEMS(tail_lens); i++) {
+            len = i ? tail_lens[i - 1] : BUF_SIZE / 2;
+            memset(ref, 0, BUF_SIZE * sizeof(int16_t));
+            memset(new, 0, BUF_SIZE * sizeof(int16_t));
+            call_ref(ref, src0, src1, win, len, bits[j]);
+            call_new(new, src0, src1, win, len, bits[j]);
+            if (memcmp(ref, new, BUF_SIZE * sizeof(int16_t)))
+                fail();
+        }
+    }
     bench_new(new, src0, src1, win, BUF_SIZE / 2, 2);
 }
 
@@ -98,19 +117,23 @@ static void check_butterflies(const int *src0, const int *src1)
     LOCAL_ALIGNED_16(int, ref1, [BUF_SIZE]);
     LOCAL_ALIGNED_16(int, new0, [BUF_SIZE]);
     LOCAL_ALIGNED_16(int, new1, [BUF_SIZE]);
+    int i, len;
 
     declare_func(void, int *av_restrict src0, int *av_restrict src1, int len);
 
-    memcpy(ref0, src0, BUF_SIZE * sizeof(*src0));
-    memcpy(ref1, src1, BUF_SIZE * sizeof(*src1));
-    memcpy(new0, src0, BUF_SIZE * sizeof(*src0));
-    memcpy(new1, src1, BUF_SIZE * sizeof(*src1));
-
-    call_ref(ref0, ref1, BUF_SIZE);
-    call_new(new0, new1, BUF_SIZE);
-    if (memcmp(ref0, new0, BUF_SIZE * sizeof(*ref0)) ||
-        memcmp(ref1, new1, BUF_SIZE * sizeof(*ref1)))
-        fail();
+    for (i = 0; i <= FF_ARRAY_ELEMS(tail_lens); i++) {
+        len = i ? tail_lens[i - 1] : BUF_SIZE;
+        memcpy(ref0, src0, BUF_SIZE * sizeof(*src0));
+        memcpy(ref1, src1, BUF_SIZE * sizeof(*src1));
+        memcpy(new0, src0, BUF_SIZE * sizeof(*src0));
+        memcpy(new1, src1, BUF_SIZE * sizeof(*src1));
+
+        call_ref(ref0, ref1, len);
+        call_new(new0, new1, len);
+        if (memcmp(ref0, new0, BUF_SIZE * sizeof(*ref0)) ||
+            memcmp(ref1, new1, BUF_SIZE * sizeof(*ref1)))
+            fail();
+    }
     memcpy(new0, src0, BUF_SIZE * sizeof(*src0));
     memcpy(new1, src1, BUF_SIZE * sizeof(*src1));
     bench_new(new0, new1, BUF_SIZE);
@@ -118,14 +141,17 @@ static void check_butterflies(const int *src0, const int *src1)
 
 static void check_scalarproduct_fixed(const int *src0, const int *src1)
 {
-    int ref, new;
+    int ref, new, i, len;
 
     declare_func(int, const int *src0, const int *src1, int len);
 
-    ref = call_ref(src0, src1, BUF_SIZE);
-    new = call_new(src0, src1, BUF_SIZE);
-    if (ref != new)
-        fail();
+    for (i = 0; i <= FF_ARRAY_ELEMS(tail_lens); i++) {
+        len = i ? tail_lens[i - 1] : BUF_SIZE;
+        ref = call_ref(src0, src1, len);
+        new = call_new(src0, src1, len);
+        if (ref != new)
+            fail();
+    }
     bench_new(src0, src1, BUF_SIZE);
 }
 
@@ -39,6 +39,10 @@ do {                                          \
     }                                         \
 } while(0);
 
+/* Lengths for the functions that only need a multiple of 4 elements, which
+ * also exercise the tails after the full vectors of the SIMD versions. */
+static const int tail_lens[] = { 4, 8, 12, 20, 28, 52 };
+
 static void test_vector_fmul(const float *src0, const float *src1)
 {
     LOCAL_ALIGNED_32(float, cdst, [LEN]);
@@ -110,20 +114,25 @@ static void test_vector_fmul_scalar(const float *src0, const float *src1)
 {
     LOCAL_ALIGNED_16(float, cdst, [LEN]);
     LOCAL_ALIGNED_16(float, odst, [LEN]);
-    int i;
+    int i, j, len;
 
     declare_func(void, float *dst, const float *src, float mul, int len);
 
-    call_ref(cdst, src0, src1[0], LEN);
-    call_new(odst, src0, src1[0], LEN);
+    for (j = 0; j <= FF_ARRAY_ELEMS(tail_lens); j++) {
+        len = j ? tail_lens[j - 1] : LEN;
+        memset(cdst, 0, LEN * sizeof(*cdst));
+        memset(odst, 0, LEN * sizeof(*odst));
+        call_ref(cdst, src0, src1[0], len);
+        call_new(odst, src0, src1[0], len);
         for (i = 0; i < LEN; i++) {
             if (!float_near_abs_eps(cdst[i], odst[i], FLT_EPSILON)) {
-                fprintf(stderr, "%d: %- .12f - %- .12f = % .12g\n",
-                        i, cdst[i], odst[i], cdst[i] - odst[i]);
+                fprintf(stderr, "%d/%d: %- .12f - %- .12f = % .12g\n",
+                        i, len, cdst[i], odst[i], cdst[i] - odst[i]);
                 fail();
                 break;
             }
         }
+    }
     bench_new(odst, src0, src1[0], LEN);
 }
 
@@ -132,19 +141,24 @@ static void test_vector_fmul_window(const float *src0, const float *src1, const
 {
     LOCAL_ALIGNED_16(float, cdst, [LEN]);
     LOCAL_ALIGNED_16(float, odst, [LEN]);
-    int i;
+    int i, j, len;
 
     declare_func(void, float *dst, const float *src0, const float *src1,
                  const float *win, int len);
 
-    call_ref(cdst, src0, src1, win, LEN / 2);
-    call_new(odst, src0, src1, win, LEN / 2);
-    for (i = 0; i < LEN; i++) {
-        if (!float_near_abs_eps(cdst[i], odst[i], ARBITRARY_FMUL_WINDOW_CONST)) {
-            fprintf(stderr, "%d: %- .12f - %- .12f = % .12g\n",
-                    i, cdst[i], odst[i], cdst[i] - odst[i]);
-            fail();
-            break;
+    for (j = 0; j <= FF_ARRAY_ELEMS(tail_lens); j++) {
+        len = j ? tail_lens[j - 1] : LEN / 2;
+        memset(cdst, 0, LEN * sizeof(*cdst));
+        memset(odst, 0, LEN * sizeof(*odst));
+        call_ref(cdst, src0, src1, win, len);
+        call_new(odst, src0, src1, win, len);
+        for (i = 0; i < LEN; i++) {
+            if (!float_near_abs_eps(cdst[i], odst[i], ARBITRARY_FMUL_WINDOW_CONST)) {
+                fprintf(stderr, "%d/%d: %- .12f - %- .12f = % .12g\n",
+                        i, len, cdst[i], odst[i], cdst[i] - odst[i]);
+                fail();
+                break;
+            }
         }
     }
     bench_new(odst, src0, src1, win, LEN / 2);
@@ -229,27 +243,30 @@ static void test_butterflies_float(const float *src0, const float *src1)
     LOCAL_ALIGNED_16(float,  odst,  [LEN]);
     LOCAL_ALIGNED_16(float,  cdst1, [LEN]);
     LOCAL_ALIGNED_16(float,  odst1, [LEN]);
-    int i;
+    int i, j, len;
 
     declare_func(void, float *av_restrict src0, float *av_restrict src1,
     int len);
 
-    memcpy(cdst,  src0, LEN * sizeof(*src0));
-    memcpy(cdst1, src1, LEN * sizeof(*src1));
-    memcpy(odst,  src0, LEN * sizeof(*src0));
-    memcpy(odst1, src1, LEN * sizeof(*src1));
+    for (j = 0; j <= FF_ARRAY_ELEMS(tail_lens); j++) {
+        len = j ? tail_lens[j - 1] : LEN;
+        memcpy(cdst,  src0, LEN * sizeof(*src0));
+        memcpy(cdst1, src1, LEN * sizeof(*src1));
+        memcpy(odst,  src0, LEN * sizeof(*src0));
+        memcpy(odst1, src1, LEN * sizeof(*src1));
 
-    call_ref(cdst, cdst1, LEN);
-    call_new(odst, odst1, LEN);
-    for (i = 0; i < LEN; i++) {
-        if (!float_near_abs_eps(cdst[i],  odst[i],  FLT_EPSILON) ||
-            !float_near_abs_eps(cdst1[i], odst1[i], FLT_EPSILON)) {
-            fprintf(stderr, "%d: %- .12f - %- .12f = % .12g\n",
-                    i, cdst[i], odst[i], cdst[i] - odst[i]);
-            fprintf(stderr, "%d: %- .12f - %- .12f = % .12g\n",
-                    i, cdst1[i], odst1[i], cdst1[i] - odst1[i]);
-            fail();
-            break;
+        call_ref(cdst, cdst1, len);
+        call_new(odst, odst1, len);
+        for (i = 0; i < LEN; i++) {
+            if (!float_near_abs_eps(cdst[i],  odst[i],  FLT_EPSILON) ||
+                !float_near_abs_eps(cdst1[i], odst1[i], FLT_EPSILON)) {
+                fprintf(stderr, "%d/%d: %- .12f - %- .12f = % .12g\n",
+                        i, len, cdst[i], odst[i], cdst[i] - odst[i]);
+                fprintf(stderr, "%d/%d: %- .12f - %- .12f = % .12g\n",
+                        i, len, cdst1[i], odst1[i], cdst1[i] - odst1[i]);
+                fail();
+                break;
+            }
         }
     }
     memcpy(odst,  src0, LEN * sizeof(*src0));
@@ -261,15 +278,19 @@ static void test_butterflies_float(const float *src0, const float *src1)
 static void test_scalarproduct_float(const float *src0, const float *src1)
 {
     float cprod, oprod;
+    int j, len;
 
     declare_func_float(float, const float *src0, const float *src1, int len);
 
-    cprod = call_ref(src0, src1, LEN);
-    oprod = call_new(src0, src1, LEN);
-    if (!float_near_abs_eps(cprod, oprod, ARBITRARY_SCALARPRODUCT_CONST)) {
-        fprintf(stderr, "%- .12f - %- .12f = % .12g\n",
-                cprod, oprod, cprod - oprod);
-        fail();
+    for (j = 0; j <= FF_ARRAY_ELEMS(tail_lens); j++) {
+        len = j ? tail_lens[j - 1] : LEN;
+        cprod = call_ref(src0, src1, len);
+        oprod = call_new(src0, src1, len);
+        if (!float_near_abs_eps(cprod, oprod, ARBITRARY_SCALARPRODUCT_CONST)) {
+            fprintf(stderr, "%d: %- .12f - %- .12f = % .12g\n",
+                    len, cprod, oprod, cprod - oprod);
+            fail();
+        }
     }
     bench_new(src0, src1, LEN);
 }
@@ -0,0 +1,198 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/imgutils_internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#include "checkasm.h"
+
+#define WIDTH     1000
+#define HEIGHT    8
+#define LINESIZE  1088
+#define ROW_WIDTH 77
+
+/* per 16 bit sample, so that it does not write past buffers of an even
+ * but not a multiple of 4 size */
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j += 2)     \
+            AV_WN16(buf + j, rnd());      \
+    } while (0)
+
+static void check_copy_plane_large(FFImgUtilsDSPContext *c)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [HEIGHT * LINESIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [HEIGHT * LINESIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [HEIGHT * LINESIZE]);
+    int offset;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dst_linesize,
+                 const uint8_t *src, ptrdiff_t src_linesize,
+                 ptrdiff_t bytewidth, int height);
+
+    randomize_buffers(src, HEIGHT * LINESIZE);
+    if (check_func(c->copy_plane_large, "copy_plane_large")) {
+        /* the destination alignment determines the unaligned start */
+        for (offset = 0; offset < 64; offset += 21) {
+            memset(dst0, 0, HEIGHT * LINESIZE);
+            memset(dst1, 0, HEIGHT * LINESIZE);
+            call_ref(dst0 + offset, LINESIZE, src + 5, LINESIZE, WIDTH, HEIGHT);
+            call_new(dst1 + offset, LINESIZE, src + 5, LINESIZE, WIDTH, HEIGHT);
+            if (memcmp(dst0, dst1, HEIGHT * LINESIZE))
+                fail();
+        }
+        bench_new(dst1, LINESIZE, src, LINESIZE, WIDTH & ~63, HEIGHT);
+    }
+    report("copy_plane_large");
+}
+
+static void check_shift(FFImgUtilsDSPContext *c)
+{
+    static const int shifts[] = { -6, 6, -15, 15 };
+    LOCAL_ALIGNED_32(uint16_t, src,  [ROW_WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [ROW_WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [ROW_WIDTH]);
+    int i;
+
+    declare_func(void, uint16_t *dst, const uint16_t *src, int width, int shift);
+
+    randomize_buffers((uint8_t *)src, ROW_WIDTH * 2);
+    if (check_func(c->shift_row16, "shift_row16")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(shifts); i++) {
+            memset(dst0, 0, ROW_WIDTH * 2);
+            memset(dst1, 0, ROW_WIDTH * 2);
+            call_ref(dst0, src, ROW_WIDTH, shifts[i]);
+            call_new(dst1, src, ROW_WIDTH, shifts[i]);
+            if (memcmp(dst0, dst1, ROW_WIDTH * 2))
+                fail();
+        }
+        bench_new(dst1, src, ROW_WIDTH & ~15, 6);
+    }
+    report("shift");
+}
+
+static void check_interleave(FFImgUtilsDSPContext *c)
+{
+    static const int shifts[] = { 0, -6, 6 };
+    LOCAL_ALIGNED_32(uint8_t, src0, [ROW_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [ROW_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [ROW_WIDTH * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [ROW_WIDTH * 4]);
+    int i;
+
+    randomize_buffers(src0, ROW_WIDTH * 2);
+    randomize_buffers(src1, ROW_WIDTH * 2);
+
+    if (check_func(c->interleave_row8, "interleave_row8")) {
+        declare_func(void, uint8_t *dst, const uint8_t *src0,
+                     const uint8_t *src1, int width);
+
+        memset(dst0, 0, ROW_WIDTH * 2);
+        memset(dst1, 0, ROW_WIDTH * 2);
+        call_ref(dst0, src0, src1, ROW_WIDTH);
+        call_new(dst1, src0, src1, ROW_WIDTH);
+        if (memcmp(dst0, dst1, ROW_WIDTH * 2))
+            fail();
+        bench_new(dst1, src0, src1, ROW_WIDTH & ~31);
+    }
+
+    if (check_func(c->interleave_row16, "interleave_row16")) {
+        declare_func(void, uint16_t *dst, const uint16_t *src0,
+                     const uint16_t *src1, int width, int shift);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(shifts); i++) {
+            memset(dst0, 0, ROW_WIDTH * 4);
+            memset(dst1, 0, ROW_WIDTH * 4);
+            call_ref((uint16_t *)dst0, (uint16_t *)src0, (uint16_t *)src1,
+                     ROW_WIDTH, shifts[i]);
+            call_new((uint16_t *)dst1, (uint16_t *)src0, (uint16_t *)src1,
+                     ROW_WIDTH, shifts[i]);
+            if (memcmp(dst0, dst1, ROW_WIDTH * 4))
+                fail();
+        }
+        bench_new((uint16_t *)dst1, (uint16_t *)src0, (uint16_t *)src1,
+                  ROW_WIDTH & ~15, 6);
+    }
+    report("interleave");
+}
+
+static void check_deinterleave(FFImgUtilsDSPContext *c)
+{
+    static const int shifts[] = { 0, -6, 6 };
+    LOCAL_ALIGNED_32(uint8_t, src,   [ROW_WIDTH * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst00, [ROW_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst01, [ROW_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst10, [ROW_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst11, [ROW_WIDTH * 2]);
+    int i;
+
+    randomize_buffers(src, ROW_WIDTH * 4);
+
+    if (check_func(c->deinterleave_row8, "deinterleave_row8")) {
+        declare_func(void, uint8_t *dst0, uint8_t *dst1, const uint8_t *src,
+                     int width);
+
+        memset(dst00, 0, ROW_WIDTH);
+        memset(dst01, 0, ROW_WIDTH);
+        memset(dst10, 0, ROW_WIDTH);
+        memset(dst11, 0, ROW_WIDTH);
+        call_ref(dst00, dst01, src, ROW_WIDTH);
+        call_new(dst10, dst11, src, ROW_WIDTH);
+        if (memcmp(dst00, dst10, ROW_WIDTH) || memcmp(dst01, dst11, ROW_WIDTH))
+            fail();
+        bench_new(dst10, dst11, src, ROW_WIDTH & ~31);
+    }
+
+    if (check_func(c->deinterleave_row16, "deinterleave_row16")) {
+        declare_func(void, uint16_t *dst0, uint16_t *dst1, const uint16_t *src,
+                     int width, int shift);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(shifts); i++) {
+            memset(dst00, 0, ROW_WIDTH * 2);
+            memset(dst01, 0, ROW_WIDTH * 2);
+            memset(dst10, 0, ROW_WIDTH * 2);
+            memset(dst11, 0, ROW_WIDTH * 2);
+            call_ref((uint16_t *)dst00, (uint16_t *)dst01, (uint16_t *)src,
+                     ROW_WIDTH, shifts[i]);
+            call_new((uint16_t *)dst10, (uint16_t *)dst11, (uint16_t *)src,
+                     ROW_WIDTH, shifts[i]);
+            if (memcmp(dst00, dst10, ROW_WIDTH * 2) ||
+                memcmp(dst01, dst11, ROW_WIDTH * 2))
+                fail();
+        }
+        bench_new((uint16_t *)dst10, (uint16_t *)dst11, (uint16_t *)src,
+                  ROW_WIDTH & ~15, -6);
+    }
+    report("deinterleave");
+}
+
+void checkasm_check_imgutils(void)
+{
+    FFImgUtilsDSPContext c;
+
+    ff_imgutils_dsp_init(&c);
+    check_copy_plane_large(&c);
+    check_shift(&c);
+    check_interleave(&c);
+    check_deinterleave(&c);
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/jpeg2000dwt.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define MAX_ROWS 64
+#define BUF_SIZE ((2 * MAX_ROWS + 1) * FF_DWT_COLS)
+
+/* samples of up to 16 bits scaled by the 8 bit preshift of the 9/7
+ * transform, so that neither the sums nor the products overflow */
+#define randomize_buffers()                                      \
+    do {                                                         \
+        int i;                                                   \
+        for (i = 0; i < BUF_SIZE; i++)                           \
+            src[i] = (int)(rnd() & 0x1ffffff) - (1 << 24);       \
+    } while (0)
+
+static void check_sd53(void (*func)(int *p, int n), const char *name)
+{
+    LOCAL_ALIGNED_32(int, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, new, [BUF_SIZE]);
+    static const int nb_rows[] = { 1, 5, MAX_ROWS };
+    int i;
+
+    declare_func(void, int *p, int n);
+
+    if (check_func(func, "%s", name)) {
+        randomize_buffers();
+        for (i = 0; i < FF_ARRAY_ELEMS(nb_rows); i++) {
+            memcpy(ref, src, sizeof(src[0]) * BUF_SIZE);
+            memcpy(new, src, sizeof(src[0]) * BUF_SIZE);
+            call_ref(ref + FF_DWT_COLS, nb_rows[i]);
+            call_new(new + FF_DWT_COLS, nb_rows[i]);
+            if (memcmp(ref, new, sizeof(src[0]) * BUF_SIZE))
+                fail();
+        }
+        bench_new(new + FF_DWT_COLS, MAX_ROWS);
+    }
+}
+
+static void check_sd97_int(Jpeg2000DWTDSPContext *c)
+{
+    LOCAL_ALIGNED_32(int, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, new, [BUF_SIZE]);
+    /* the lifting steps of the encoder, the subtracted ones negated */
+    static const int coefs[][2] = {
+        { -103949, (1 << 15) - 1 },
+        {   -3472, (1 << 15) - 1 },
+        {   57862,  1 << 15      },
+        {   29066,  1 << 15      },
+    };
+    int i;
+
+    declare_func(void, int *p, int n, int coef, int rnd);
+
+    if (check_func(c->sd97_int_cols, "sd97_int_cols")) {
+        randomize_buffers();
+        for (i = 0; i < FF_ARRAY_ELEMS(coefs); i++) {
+            int n = i ? MAX_ROWS - i : 1;
+            memcpy(ref, src, sizeof(src[0]) * BUF_SIZE);
+            memcpy(new, src, sizeof(src[0]) * BUF_SIZE);
+            call_ref(ref + FF_DWT_COLS, n, coefs[i][0], coefs[i][1]);
+            call_new(new + FF_DWT_COLS, n, coefs[i][0], coefs[i][1]);
+            if (memcmp(ref, new, sizeof(src[0]) * BUF_SIZE))
+                fail();
+        }
+        bench_new(new + FF_DWT_COLS, MAX_ROWS, coefs[0][0], coefs[0][1]);
+    }
+}
+
+void checkasm_check_jpeg2000dwt(void)
+{
+    Jpeg2000DWTDSPContext c;
+
+    ff_jpeg2000dwt_dsp_init(&c);
+
+    check_sd53(c.sd53_predict_cols, "sd53_predict_cols");
+    check_sd53(c.sd53_update_cols,  "sd53_update_cols");
+    report("sd53");
+
+    check_sd97_int(&c);
+    report("sd97_int");
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/snow.h"
+#include "libavcodec/snow_dwt.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+
+#define WIDTH  64
+#define STRIDE 96
+#define LINES  32
+
+/* Values in the range of the wavelet coefficients of 8 bit video. */
+#define randomize_idwt(buf, size)                   \
+    do {                                            \
+        int i;                                      \
+        for (i = 0; i < size; i++)                  \
+            (buf)[i] = (int)(rnd() & 0x1FFF) - 0x1000; \
+    } while (0)
+
+/* The MMX version advances the block pointers it is given. */
+static void init_blocks(uint8_t **block, uint8_t *pred, int src_x)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        block[i] = pred + i * LINES * STRIDE + src_x;
+}
+
+static void check_inner_add_yblock(const SnowDWTContext *c)
+{
+    static const struct {
+        int b_w, obmc_depth;
+    } sizes[] = { { 16, 0 }, { 8, 1 }, { 4, 2 } };
+    LOCAL_ALIGNED_32(IDWTELEM, lines, [LINES * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, pred, [4 * LINES * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [LINES * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [LINES * STRIDE]);
+    IDWTELEM *line[LINES];
+    slice_buffer sb = { .line = line, .line_count = LINES };
+    int i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *obmc, const int obmc_stride,
+                      uint8_t **block, int b_w, int b_h, int src_x, int src_y,
+                      int src_stride, slice_buffer *sb, int add, uint8_t *dst8);
+
+    for (i = 0; i < LINES; i++)
+        line[i] = lines + i * STRIDE;
+    randomize_idwt(lines, LINES * STRIDE);
+    for (i = 0; i < 4 * LINES * STRIDE; i++)
+        pred[i] = rnd();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        const int b_w = sizes[i].b_w;
+
+        if (check_func(c->inner_add_yblock, "inner_add_yblock_%d", b_w)) {
+            const int obmc_stride = 2 * b_w;
+            const int src_x = (rnd() % (WIDTH - b_w)) & ~1;
+            const int src_y = rnd() % (LINES - b_w);
+            uint8_t *block[4], *block_orig[4];
+
+            memset(dst_ref, 0, LINES * STRIDE);
+            memset(dst_new, 0, LINES * STRIDE);
+            init_blocks(block, pred, src_x);
+            call_ref(ff_obmc_tab[sizes[i].obmc_depth], obmc_stride, block, b_w, b_w,
+                     src_x, src_y, STRIDE, &sb, 1, dst_ref + src_x);
+            init_blocks(block, pred, src_x);
+            call_new(ff_obmc_tab[sizes[i].obmc_depth], obmc_stride, block, b_w, b_w,
+                     src_x, src_y, STRIDE, &sb, 1, dst_new + src_x);
+            if (memcmp(dst_ref, dst_new, LINES * STRIDE))
+                fail();
+            /* The MMX versions advance the block pointers, so they cannot
+             * be called repeatedly on the same setup. */
+            init_blocks(block_orig, pred, src_x);
+            if (!memcmp(block, block_orig, sizeof(block)))
+                bench_new(ff_obmc_tab[sizes[i].obmc_depth], obmc_stride, block, b_w, b_w,
+                          src_x, src_y, STRIDE, &sb, 1, dst_new + src_x);
+        }
+    }
+    report("inner_add_yblock");
+}
+
+static void check_vertical_compose97i(const SnowDWTContext *c)
+{
+    LOCAL_ALIGNED_32(IDWTELEM, src,     [6 * STRIDE]);
+    LOCAL_ALIGNED_32(IDWTELEM, dst_ref, [6 * STRIDE]);
+    LOCAL_ALIGNED_32(IDWTELEM, dst_new, [6 * STRIDE]);
+    IDWTELEM *b_ref[6], *b_new[6];
+    int i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, IDWTELEM *b0, IDWTELEM *b1, IDWTELEM *b2,
+                      IDWTELEM *b3, IDWTELEM *b4, IDWTELEM *b5, int width);
+
+    if (check_func(c->vertical_compose97i, "vertical_compose97i")) {
+        for (i = 0; i < 6; i++) {
+            b_ref[i] = dst_ref + i * STRIDE;
+            b_new[i] = dst_new + i * STRIDE;
+        }
+        randomize_idwt(src, 6 * STRIDE);
+        memcpy(dst_ref, src, 6 * STRIDE * sizeof(*src));
+        memcpy(dst_new, src, 6 * STRIDE * sizeof(*src));
+        call_ref(b_ref[0], b_ref[1], b_ref[2], b_ref[3], b_ref[4], b_ref[5], WIDTH);
+        call_new(b_new[0], b_new[1], b_new[2], b_new[3], b_new[4], b_new[5], WIDTH);
+        if (memcmp(dst_ref, dst_new, 6 * STRIDE * sizeof(*src)))
+            fail();
+        bench_new(b_new[0], b_new[1], b_new[2], b_new[3], b_new[4], b_new[5], WIDTH);
+    }
+    report("vertical_compose97i");
+}
+
+static void check_horizontal_compose97i(const SnowDWTContext *c)
+{
+    LOCAL_ALIGNED_32(IDWTELEM, src,     [STRIDE]);
+    LOCAL_ALIGNED_32(IDWTELEM, dst_ref, [STRIDE]);
+    LOCAL_ALIGNED_32(IDWTELEM, dst_new, [STRIDE]);
+    LOCAL_ALIGNED_32(IDWTELEM, temp,    [STRIDE]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, IDWTELEM *b, IDWTELEM *temp, int width);
+
+    if (check_func(c->horizontal_compose97i, "horizontal_compose97i")) {
+        randomize_idwt(src, STRIDE);
+        memcpy(dst_ref, src, STRIDE * sizeof(*src));
+        memcpy(dst_new, src, STRIDE * sizeof(*src));
+        call_ref(dst_ref, temp, WIDTH);
+        call_new(dst_new, temp, WIDTH);
+        if (memcmp(dst_ref, dst_new, WIDTH * sizeof(*src)))
+            fail();
+        bench_new(dst_new, temp, WIDTH);
+    }
+    report("horizontal_compose97i");
+}
+
+void checkasm_check_snowdsp(void)
+{
+    SnowDWTContext c;
+
+    ff_dwt_init(&c);
+
+    check_inner_add_yblock(&c);
+    check_vertical_compose97i(&c);
+    check_horizontal_compose97i(&c);
+}
@@ -0,0 +1,305 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE     /* Needed for MAP_ANONYMOUS with glibc */
+
+#include <string.h>
+
+#include "config.h"
+#if HAVE_MMAP && HAVE_UNISTD_H
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/resample.h"
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define PHASES   32
+#define MAX_TAPS 48
+#define DST_LEN  67
+#define SRC_LEN  (2 * DST_LEN + MAX_TAPS + 16)
+#define MIX_LEN  77
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j += 4)     \
+            AV_WN32(buf + j, rnd());      \
+    } while (0)
+
+/* The taps are kept small enough that no sum overflows, the normalized
+ * filters swresample builds never get close to that. Like in the real filter
+ * bank, the taps past the filter length are zero, the SIMD versions read
+ * them. */
+static void init_filter_bank(ResampleContext *c, uint8_t *bank, int bps, int taps)
+{
+    int i;
+
+    c->filter_bank   = bank;
+    c->filter_length = taps;
+    c->filter_alloc  = FFALIGN(taps, 16);
+    c->phase_count   = PHASES;
+    c->src_incr      = 48000;
+    c->dst_incr      = 44100 * PHASES;
+    c->dst_incr_div  = c->dst_incr / c->src_incr;
+    c->dst_incr_mod  = c->dst_incr % c->src_incr;
+    c->index         = rnd() % PHASES;
+    c->frac          = rnd() % c->src_incr;
+
+    for (i = 0; i < (PHASES + 1) * c->filter_alloc; i++) {
+        if (i % c->filter_alloc >= taps)
+            memset(bank + i * bps, 0, bps);
+        else if (bps == 2)
+            ((int16_t *)bank)[i] = (int)(rnd() % 2048) - 1024;
+        else
+            ((int32_t *)bank)[i] = (int)(rnd() % (1 << 25)) - (1 << 24);
+    }
+}
+
+/* Returns the number of input samples the C version reads for n outputs. */
+static int src_samples_read(const ResampleContext *c, int n)
+{
+    int index = c->index, frac = c->frac, sample_index = 0, i;
+
+    for (i = 1; i < n; i++) {
+        frac  += c->dst_incr_mod;
+        index += c->dst_incr_div;
+        if (frac >= c->src_incr) {
+            frac -= c->src_incr;
+            index++;
+        }
+        sample_index += index / c->phase_count;
+        index        %= c->phase_count;
+    }
+    return sample_index + c->filter_length;
+}
+
+typedef struct GuardedBuffer {
+    uint8_t *data;
+    void    *base;
+    size_t   size;
+} GuardedBuffer;
+
+/* Allocate size bytes that end right before an inaccessible page where the
+ * system allows it, so that a function reading past them crashes. */
+static int alloc_guarded(GuardedBuffer *buf, size_t size)
+{
+#if HAVE_MMAP && HAVE_UNISTD_H && defined(MAP_ANONYMOUS)
+    size_t page = sysconf(_SC_PAGESIZE);
+
+    buf->size = FFALIGN(size, page) + page;
+    buf->base = mmap(NULL, buf->size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf->base != MAP_FAILED) {
+        buf->data = (uint8_t *)buf->base + buf->size - page - size;
+        if (!mprotect(buf->data + size, page, PROT_NONE))
+            return 0;
+        munmap(buf->base, buf->size);
+    }
+#endif
+    buf->size = 0;
+    buf->base = buf->data = av_malloc(size);
+    return buf->data ? 0 : AVERROR(ENOMEM);
+}
+
+static void free_guarded(GuardedBuffer *buf)
+{
+#if HAVE_MMAP && HAVE_UNISTD_H && defined(MAP_ANONYMOUS)
+    if (buf->size) {
+        munmap(buf->base, buf->size);
+        return;
+    }
+#endif
+    av_free(buf->base);
+}
+
+static void check_resample(enum AVSampleFormat fmt, const char *type)
+{
+    static const int taps[] = { 8, 17, 32, 36, 48 };
+    int bps = av_get_bytes_per_sample(fmt);
+    LOCAL_ALIGNED_32(uint8_t, bank, [(PHASES + 1) * MAX_TAPS * 4]);
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_LEN * 4]);
+    ResampleContext c = { 0 }, c0, c1;
+    GuardedBuffer end;
+    int i, linear, ret0, ret1, size;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    c.format = fmt;
+    randomize_buffers(src, SRC_LEN * bps);
+
+    for (linear = 0; linear < 2; linear++) {
+        for (i = 0; i < FF_ARRAY_ELEMS(taps); i++) {
+            /* the functions may depend on the filter length */
+            init_filter_bank(&c, bank, bps, taps[i]);
+            swri_resample_dsp_init(&c);
+            if (!check_func(linear ? c.dsp.resample_linear : c.dsp.resample_common,
+                            "resample_%s_%s_%d", linear ? "linear" : "common",
+                            type, taps[i]))
+                continue;
+
+            memset(dst0, 0, DST_LEN * bps);
+            memset(dst1, 0, DST_LEN * bps);
+            c0 = c1 = c;
+
+            ret0 = call_ref(&c0, dst0, src, DST_LEN, 1);
+            ret1 = call_new(&c1, dst1, src, DST_LEN, 1);
+            if (ret0 != ret1 || c0.index != c1.index || c0.frac != c1.frac ||
+                memcmp(dst0, dst1, DST_LEN * bps))
+                fail();
+
+            /* swresample only guarantees filter_overread samples of input
+             * past the last filter, check with the input at the end of a
+             * buffer */
+            size = (src_samples_read(&c, DST_LEN) + c.filter_overread) * bps;
+            if (alloc_guarded(&end, size) < 0) {
+                fail();
+                continue;
+            }
+            memcpy(end.data, src, size);
+            memset(dst1, 0, DST_LEN * bps);
+            c1 = c;
+            call_new(&c1, dst1, end.data, DST_LEN, 1);
+            if (memcmp(dst0, dst1, DST_LEN * bps))
+                fail();
+            free_guarded(&end);
+
+            bench_new(&c1, dst1, src, DST_LEN, 0);
+        }
+    }
+    report("resample_%s", type);
+}
+
+static SwrContext *alloc_rematrix(int64_t in_layout, int64_t out_layout,
+                                  enum AVSampleFormat fmt, double volume)
+{
+    SwrContext *s = swr_alloc_set_opts(NULL, out_layout, fmt, 48000,
+                                       in_layout, fmt, 48000, 0, NULL);
+    if (!s)
+        return NULL;
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0);
+    av_opt_set_double(s, "rmvol", volume, 0);
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static void check_mix_any(int64_t in_layout, const char *name,
+                          enum AVSampleFormat fmt, double volume)
+{
+    int bps = av_get_bytes_per_sample(fmt);
+    int nb_in = av_get_channel_layout_nb_channels(in_layout);
+    LOCAL_ALIGNED_32(uint8_t, src,  [8 * MIX_LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * MIX_LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * MIX_LEN * 4]);
+    const uint8_t *in[8];
+    uint8_t *out0[2] = { dst0, dst0 + MIX_LEN * 4 };
+    uint8_t *out1[2] = { dst1, dst1 + MIX_LEN * 4 };
+    SwrContext *s = alloc_rematrix(in_layout, AV_CH_LAYOUT_STEREO, fmt, volume);
+    int i;
+
+    declare_func(void, uint8_t **out, const uint8_t **in, void *coeffp,
+                 integer len);
+
+    if (!s)
+        fail();
+    else if (check_func(s->mix_any_f, "%s", name)) {
+        for (i = 0; i < nb_in; i++) {
+            in[i] = src + i * MIX_LEN * 4;
+            randomize_buffers(in[i], MIX_LEN * bps);
+        }
+        memset(dst0, 0, 2 * MIX_LEN * 4);
+        memset(dst1, 0, 2 * MIX_LEN * 4);
+
+        call_ref(out0, in, s->native_matrix, MIX_LEN);
+        call_new(out1, in, s->native_matrix, MIX_LEN);
+        if (memcmp(dst0, dst1, 2 * MIX_LEN * 4))
+            fail();
+
+        bench_new(out1, in, s->native_matrix, MIX_LEN & ~15);
+    }
+    swr_free(&s);
+}
+
+static void check_mix_n_1(void)
+{
+    LOCAL_ALIGNED_32(int16_t, src,  [6 * MIX_LEN]);
+    LOCAL_ALIGNED_32(int16_t, dst0, [MIX_LEN]);
+    LOCAL_ALIGNED_32(int16_t, dst1, [MIX_LEN]);
+    const void *in[6];
+    int32_t coeffs[6];
+    SwrContext *s = alloc_rematrix(AV_CH_LAYOUT_5POINT1, AV_CH_LAYOUT_MONO,
+                                   AV_SAMPLE_FMT_S16P, 1.0);
+    void *func;
+    int i, nb_in;
+
+    declare_func(void, void *out, const void **in, const int32_t *coeffp,
+                 integer nb_in, integer len);
+
+    if (!s) {
+        fail();
+        return;
+    }
+    func = s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f;
+    nb_in = s->matrix_ch[0][0];
+    if (nb_in > 2 && check_func(func, "mix_n_1_s16")) {
+        for (i = 0; i < nb_in; i++) {
+            in[i]     = src + i * MIX_LEN;
+            randomize_buffers((uint8_t *)in[i], MIX_LEN * 2);
+            coeffs[i] = s->matrix32[0][s->matrix_ch[0][1 + i]];
+        }
+        memset(dst0, 0, MIX_LEN * 2);
+        memset(dst1, 0, MIX_LEN * 2);
+
+        /* the SIMD versions are only called on multiples of 16 samples */
+        call_ref(dst0, in, coeffs, nb_in, MIX_LEN & ~15);
+        call_new(dst1, in, coeffs, nb_in, MIX_LEN & ~15);
+        if (memcmp(dst0, dst1, MIX_LEN * 2))
+            fail();
+
+        bench_new(dst1, in, coeffs, nb_in, MIX_LEN & ~15);
+    }
+    swr_free(&s);
+}
+
+void checkasm_check_sw_resample(void)
+{
+    check_resample(AV_SAMPLE_FMT_S16P, "int16");
+    check_resample(AV_SAMPLE_FMT_S32P, "int32");
+
+    check_mix_any(AV_CH_LAYOUT_5POINT1, "mix6to2_s16",      AV_SAMPLE_FMT_S16P, 1.0);
+    check_mix_any(AV_CH_LAYOUT_5POINT1, "mix6to2_clip_s16", AV_SAMPLE_FMT_S16P, 2.0);
+    check_mix_any(AV_CH_LAYOUT_7POINT1, "mix8to2_s16",      AV_SAMPLE_FMT_S16P, 1.0);
+    check_mix_any(AV_CH_LAYOUT_7POINT1, "mix8to2_clip_s16", AV_SAMPLE_FMT_S16P, 2.0);
+    check_mix_any(AV_CH_LAYOUT_5POINT1, "mix6to2_s32",      AV_SAMPLE_FMT_S32P, 1.0);
+    check_mix_any(AV_CH_LAYOUT_7POINT1, "mix8to2_s32",      AV_SAMPLE_FMT_S32P, 1.0);
+    check_mix_n_1();
+    report("rematrix");
+}
@@ -0,0 +1,661 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define SRC_W     512
+#define DST_W     203
+/* the filters are padded like in initFilter(), SIMD versions may read them
+ * for a few outputs past the end */
+#define DST_W_PAD FFALIGN(DST_W, 8)
+#define MAX_TAPS  40
+#define MAX_LINES 16
+#define LINE_W    256
+#define PACKED_W  192
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j += 4)     \
+            AV_WN32(buf + j, rnd());      \
+    } while (0)
+
+/* Create a context with the function pointers for the current cpu flags or,
+ * with c_only, for plain C, to compare against SIMD versions which take their
+ * arguments in a different layout or aren't bitexact. */
+static SwsContext *get_context(int srcW, enum AVPixelFormat src_fmt,
+                               int dstW, enum AVPixelFormat dst_fmt,
+                               int flags, int c_only)
+{
+    int cpu_flags = av_get_cpu_flags();
+    SwsContext *c;
+
+    if (c_only)
+        av_force_cpu_flags(0);
+    c = sws_getContext(srcW, 16, src_fmt, dstW, 16, dst_fmt, flags, NULL, NULL, NULL);
+    if (c_only)
+        av_force_cpu_flags(cpu_flags);
+    if (!c)
+        fail();
+    return c;
+}
+
+/* Random coefficients of the given precision which add up to one, like the
+ * ones built by initFilter(). */
+static void make_filter(int16_t *filter, int size, int one)
+{
+    int i, sum = 0;
+
+    for (i = 0; i < size; i++) {
+        filter[i] = (int)(rnd() % (one / 2)) - one / 4;
+        sum += filter[i];
+    }
+    filter[rnd() % size] += one - sum;
+}
+
+/* Coefficients without negative taps, the MMX vertical scalers sum in 16 bits
+ * and only stay in range for smooth filters, the SSE horizontal scalers
+ * saturate sums which the C code wraps. */
+static void make_smooth_filter(int16_t *filter, int size, int one)
+{
+    int i, sum = 0;
+
+    for (i = 0; i < size - 1; i++) {
+        filter[i] = rnd() % (one / size) + 1;
+        sum += filter[i];
+    }
+    filter[size - 1] = one - sum;
+}
+
+static void check_hscale(void)
+{
+    static const struct {
+        enum AVPixelFormat src, dst;
+    } fmts[] = {
+        { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P     },
+        { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P16LE },
+        { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P     },
+        { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P16LE },
+        { AV_PIX_FMT_YUV420P12LE, AV_PIX_FMT_YUV420P     },
+        { AV_PIX_FMT_YUV420P16LE, AV_PIX_FMT_YUV420P     },
+        { AV_PIX_FMT_YUV420P16LE, AV_PIX_FMT_YUV420P16LE },
+        { AV_PIX_FMT_RGB24,       AV_PIX_FMT_YUV420P     },
+        { AV_PIX_FMT_RGB48LE,     AV_PIX_FMT_YUV420P16LE },
+    };
+    static const int filter_sizes[] = { 4, 8, 12, 16, 20, MAX_TAPS };
+    LOCAL_ALIGNED_32(uint8_t, src,       [SRC_W * 2]);
+    LOCAL_ALIGNED_32(int16_t, filter,    [DST_W_PAD * MAX_TAPS]);
+    LOCAL_ALIGNED_32(int32_t, filterPos, [DST_W_PAD]);
+    LOCAL_ALIGNED_32(int32_t, dst_ref,   [LINE_W]);
+    LOCAL_ALIGNED_32(int32_t, dst_new,   [LINE_W]);
+    int i, j, k;
+
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW, const uint8_t *src,
+                 const int16_t *filter, const int32_t *filterPos, int filterSize);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmts[i].src);
+        SwsContext *c = get_context(SRC_W, fmts[i].src, DST_W, fmts[i].dst, SWS_BILINEAR, 0);
+        int rgb, bits;
+
+        if (!c)
+            return;
+        /* the RGB input converters produce 15 bit samples */
+        rgb  = isAnyRGB(fmts[i].src) && desc->comp[0].depth < 16;
+        bits = rgb ? 15 : c->srcBpc;
+        if (c->srcBpc == 8) {
+            randomize_buffers(src, SRC_W);
+        } else {
+            for (j = 0; j < SRC_W; j++)
+                AV_WN16A(src + 2 * j, rnd() & ((1 << bits) - 1));
+        }
+
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++) {
+            const int size = filter_sizes[j];
+
+            c->hLumFilterSize = c->hChrFilterSize = size;
+            ff_getSwsFunc(c);
+            if (check_func(c->hyScale, "hscale_%s_to_%d_%d", desc->name,
+                           c->dstBpc > 14 ? 19 : 15, size)) {
+                for (k = 0; k < DST_W_PAD; k++) {
+                    filterPos[k] = rnd() % (SRC_W - size + 1);
+                    make_smooth_filter(filter + k * size, size, 1 << 14);
+                }
+                memset(dst_ref, 0, sizeof(*dst_ref) * DST_W);
+                memset(dst_new, 0, sizeof(*dst_new) * DST_W);
+                call_ref(c, (int16_t *)dst_ref, DST_W, src, filter, filterPos, size);
+                call_new(c, (int16_t *)dst_new, DST_W, src, filter, filterPos, size);
+                if (memcmp(dst_ref, dst_new, DST_W * (c->dstBpc > 14 ? 4 : 2)))
+                    fail();
+                bench_new(c, (int16_t *)dst_new, DST_W, src, filter, filterPos, size);
+            }
+        }
+        sws_freeContext(c);
+    }
+    report("hscale");
+}
+
+static const enum AVPixelFormat planar_fmts[] = {
+    AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P9LE,  AV_PIX_FMT_YUV420P10LE,
+    AV_PIX_FMT_YUV420P12LE, AV_PIX_FMT_YUV420P14LE, AV_PIX_FMT_YUV420P16LE,
+    AV_PIX_FMT_YUV420P10BE, AV_PIX_FMT_YUV420P16BE,
+};
+
+/* 15 bit intermediate samples with some over- and undershoot, 19 bit ones
+ * for 16 bit output */
+static void fill_lines(int32_t *lines, int count, int dstBpc)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (dstBpc > 14)
+            lines[i] = (int)(rnd() & 0x7FFFF) - 0x1000;
+        else
+            ((int16_t *)lines)[i] = (int)(rnd() & 0x7FFF) - 0x400;
+    }
+}
+
+static void check_yuv2planeX(void)
+{
+    /* the vertical filter size is a multiple of 2 on x86 */
+    static const int filter_sizes[] = { 2, 4, 6, 8, 12, MAX_LINES };
+    LOCAL_ALIGNED_32(int32_t, lines,   [MAX_LINES], [LINE_W]);
+    LOCAL_ALIGNED_32(int16_t, filter,  [MAX_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, dither,  [8]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [LINE_W]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [LINE_W]);
+    const int16_t *src[MAX_LINES];
+    int i, j, offset;
+
+    declare_func(void, const int16_t *filter, int filterSize, const int16_t **src,
+                 uint8_t *dest, int dstW, const uint8_t *dither, int offset);
+
+    for (i = 0; i < MAX_LINES; i++)
+        src[i] = (const int16_t *)lines[i];
+
+    for (i = 0; i < FF_ARRAY_ELEMS(planar_fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(planar_fmts[i]);
+        /* the MMX vertical scaler takes a different filter layout and is
+         * checked separately */
+        SwsContext *c = get_context(SRC_W, AV_PIX_FMT_YUV420P, DST_W, planar_fmts[i],
+                                    SWS_BILINEAR | SWS_ACCURATE_RND | SWS_BITEXACT, 0);
+        int bytes;
+
+        if (!c)
+            return;
+        bytes = c->dstBpc > 8 ? 2 : 1;
+        fill_lines(lines[0], MAX_LINES * LINE_W, c->dstBpc);
+        randomize_buffers(dither, 8);
+
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++) {
+            const int size = filter_sizes[j];
+
+            if (check_func(c->yuv2planeX, "yuv2planeX_%s_%d", desc->name, size)) {
+                make_filter(filter, size, 1 << 12);
+                for (offset = 0; offset < 4; offset += 3) {
+                    memset(dst_ref, 0, sizeof(*dst_ref) * DST_W);
+                    memset(dst_new, 0, sizeof(*dst_new) * DST_W);
+                    call_ref(filter, size, src, (uint8_t *)dst_ref, DST_W, dither, offset);
+                    call_new(filter, size, src, (uint8_t *)dst_new, DST_W, dither, offset);
+                    if (memcmp(dst_ref, dst_new, DST_W * bytes))
+                        fail();
+                }
+                bench_new(filter, size, src, (uint8_t *)dst_new, DST_W, dither, 0);
+            }
+        }
+        sws_freeContext(c);
+    }
+    report("yuv2planeX");
+}
+
+/* Fill the vertical filter tables the MMX scalers read instead of the plain
+ * coefficients, as ff_updateMMXDitherTables() does for every output line. */
+static void set_mmx_filter(int32_t *mmx_filter, const int16_t *filter,
+                           const int16_t **src, int size, int accurate)
+{
+    int i;
+
+    memset(mmx_filter, 0, sizeof(int32_t) * 4 * MAX_FILTER_SIZE);
+    if (accurate) {
+        const int s = APCK_SIZE / 8;
+        for (i = 0; i < size; i += 2) {
+            *(const void **)&mmx_filter[s * i]                 = src[i];
+            *(const void **)&mmx_filter[s * i + APCK_PTR2 / 4] = src[i + 1];
+            mmx_filter[s * i + APCK_COEF / 4]     =
+            mmx_filter[s * i + APCK_COEF / 4 + 1] = (uint16_t)filter[i] +
+                                                    (filter[i + 1] * (1 << 16));
+        }
+    } else {
+        for (i = 0; i < size; i++) {
+            *(const void **)&mmx_filter[4 * i] = src[i];
+            mmx_filter[4 * i + 2] =
+            mmx_filter[4 * i + 3] = ((uint16_t)filter[i]) * 0x10001U;
+        }
+    }
+}
+
+/* The MMX vertical scaler used without SWS_ACCURATE_RND reads pointers and
+ * coefficients from c->lumMmxFilter and rounds differently, so it is compared
+ * against the C function with a tolerance. */
+static void check_yuv2planeX_mmx(void)
+{
+    static const int filter_sizes[] = { 2, 4, 7, MAX_LINES };
+    LOCAL_ALIGNED_32(int16_t, lines,   [MAX_LINES], [LINE_W]);
+    LOCAL_ALIGNED_32(int16_t, filter,  [MAX_LINES]);
+    LOCAL_ALIGNED_32(int32_t, mmx_filter, [4 * MAX_FILTER_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dither,  [8]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [LINE_W]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [LINE_W]);
+    const int16_t *src[MAX_LINES];
+    SwsContext *c, *c_ref;
+    int i, j;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *filter, int filterSize,
+                      const int16_t **src, uint8_t *dest, int dstW,
+                      const uint8_t *dither, int offset);
+
+    c     = get_context(SRC_W, AV_PIX_FMT_YUV420P, DST_W, AV_PIX_FMT_YUV420P, SWS_BILINEAR, 0);
+    c_ref = get_context(SRC_W, AV_PIX_FMT_YUV420P, DST_W, AV_PIX_FMT_YUV420P, SWS_BILINEAR, 1);
+    if (!c || !c_ref)
+        goto end;
+
+    for (i = 0; i < MAX_LINES; i++)
+        src[i] = lines[i];
+    fill_lines((int32_t *)lines[0], MAX_LINES * LINE_W, 8);
+    randomize_buffers(dither, 8);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(filter_sizes); i++) {
+        const int size = filter_sizes[i];
+
+        if (!c->use_mmx_vfilter)
+            break;
+        if (check_func(c->yuv2planeX, "yuv2planeX_mmx_%d", size)) {
+            make_smooth_filter(filter, size, 1 << 12);
+            set_mmx_filter(mmx_filter, filter, src, size, 0);
+            c_ref->yuv2planeX(filter, size, src, dst_ref, DST_W, dither, 0);
+            call_new((const int16_t *)mmx_filter, size, src, dst_new, DST_W, dither, 0);
+            for (j = 0; j < DST_W; j++)
+                if (FFABS(dst_ref[j] - dst_new[j]) > 2)
+                    break;
+            if (j < DST_W)
+                fail();
+            bench_new((const int16_t *)mmx_filter, size, src, dst_new, DST_W, dither, 0);
+        }
+    }
+    report("yuv2planeX_mmx");
+
+end:
+    sws_freeContext(c);
+    sws_freeContext(c_ref);
+}
+
+static void check_yuv2plane1(void)
+{
+    LOCAL_ALIGNED_32(int32_t, line,    [LINE_W]);
+    LOCAL_ALIGNED_32(uint8_t, dither,  [8]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [LINE_W]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [LINE_W]);
+    int i, offset;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *src, uint8_t *dest, int dstW,
+                      const uint8_t *dither, int offset);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(planar_fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(planar_fmts[i]);
+        SwsContext *c = get_context(SRC_W, AV_PIX_FMT_YUV420P, DST_W, planar_fmts[i],
+                                    SWS_BILINEAR | SWS_ACCURATE_RND | SWS_BITEXACT, 0);
+        int bytes;
+
+        if (!c)
+            return;
+        bytes = c->dstBpc > 8 ? 2 : 1;
+        fill_lines(line, LINE_W, c->dstBpc);
+        randomize_buffers(dither, 8);
+
+        if (check_func(c->yuv2plane1, "yuv2plane1_%s", desc->name)) {
+            for (offset = 0; offset < 4; offset += 3) {
+                memset(dst_ref, 0, sizeof(*dst_ref) * DST_W);
+                memset(dst_new, 0, sizeof(*dst_new) * DST_W);
+                call_ref((const int16_t *)line, (uint8_t *)dst_ref, DST_W, dither, offset);
+                call_new((const int16_t *)line, (uint8_t *)dst_new, DST_W, dither, offset);
+                if (memcmp(dst_ref, dst_new, DST_W * bytes))
+                    fail();
+            }
+            bench_new((const int16_t *)line, (uint8_t *)dst_new, DST_W, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+    report("yuv2plane1");
+}
+
+/* The packed and semi-planar input converters, the ones with SIMD versions */
+static void check_input(void)
+{
+    static const enum AVPixelFormat fmts[] = {
+        AV_PIX_FMT_YUYV422, AV_PIX_FMT_UYVY422, AV_PIX_FMT_NV12,  AV_PIX_FMT_NV21,
+        AV_PIX_FMT_YA8,     AV_PIX_FMT_RGB24,   AV_PIX_FMT_BGR24, AV_PIX_FMT_RGBA,
+        AV_PIX_FMT_BGRA,    AV_PIX_FMT_ARGB,    AV_PIX_FMT_ABGR,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src,     [SRC_W * 4]);
+    LOCAL_ALIGNED_32(int16_t, dst_ref, [2], [SRC_W]);
+    LOCAL_ALIGNED_32(int16_t, dst_new, [2], [SRC_W]);
+    int i;
+
+    randomize_buffers(src, SRC_W * 4);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmts[i]);
+        SwsContext *c = get_context(DST_W, fmts[i], DST_W, AV_PIX_FMT_YUVA444P,
+                                    SWS_BILINEAR | SWS_FULL_CHR_H_INP, 0);
+        /* the RGB converters output 15 bit samples, the others pass the 8 bit
+         * ones through, the SIMD versions may write past the width */
+        const int bytes = isAnyRGB(fmts[i]) ? 2 : 1;
+        uint32_t *pal;
+
+        if (!c)
+            return;
+        pal = (uint32_t *)c->input_rgb2yuv_table;
+
+        {
+            declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dst, const uint8_t *src,
+                              const uint8_t *src2, const uint8_t *src3, int width,
+                              uint32_t *pal);
+
+            if (check_func(c->lumToYV12, "%sToY", desc->name)) {
+                memset(dst_ref, 0, sizeof(int16_t) * 2 * SRC_W);
+                memset(dst_new, 0, sizeof(int16_t) * 2 * SRC_W);
+                call_ref((uint8_t *)dst_ref[0], src, src, src, DST_W, pal);
+                call_new((uint8_t *)dst_new[0], src, src, src, DST_W, pal);
+                if (memcmp(dst_ref[0], dst_new[0], DST_W * bytes))
+                    fail();
+                bench_new((uint8_t *)dst_new[0], src, src, src, DST_W, pal);
+            }
+            if (check_func(c->alpToYV12, "%sToA", desc->name)) {
+                memset(dst_ref, 0, sizeof(int16_t) * 2 * SRC_W);
+                memset(dst_new, 0, sizeof(int16_t) * 2 * SRC_W);
+                call_ref((uint8_t *)dst_ref[0], src, src, src, DST_W, pal);
+                call_new((uint8_t *)dst_new[0], src, src, src, DST_W, pal);
+                if (memcmp(dst_ref[0], dst_new[0], DST_W * bytes))
+                    fail();
+                bench_new((uint8_t *)dst_new[0], src, src, src, DST_W, pal);
+            }
+        }
+        {
+            declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dstU, uint8_t *dstV,
+                              const uint8_t *src1, const uint8_t *src2,
+                              const uint8_t *src3, int width, uint32_t *pal);
+
+            if (check_func(c->chrToYV12, "%sToUV", desc->name)) {
+                memset(dst_ref, 0, sizeof(int16_t) * 2 * SRC_W);
+                memset(dst_new, 0, sizeof(int16_t) * 2 * SRC_W);
+                call_ref((uint8_t *)dst_ref[0], (uint8_t *)dst_ref[1], src, src, src, DST_W, pal);
+                call_new((uint8_t *)dst_new[0], (uint8_t *)dst_new[1], src, src, src, DST_W, pal);
+                if (memcmp(dst_ref[0], dst_new[0], DST_W * bytes) ||
+                    memcmp(dst_ref[1], dst_new[1], DST_W * bytes))
+                    fail();
+                bench_new((uint8_t *)dst_new[0], (uint8_t *)dst_new[1], src, src, src, DST_W, pal);
+            }
+        }
+        sws_freeContext(c);
+    }
+    report("input");
+}
+
+/* The MMX packed writers round and dither differently than the C ones, allow
+ * a few steps of difference per 8 bit component and one or two for the 5 and
+ * 6 bit RGB fields. */
+static int packed_cmp(enum AVPixelFormat fmt, const uint8_t *a, const uint8_t *b, int w)
+{
+    int i;
+
+    if (fmt == AV_PIX_FMT_RGB565 || fmt == AV_PIX_FMT_RGB555) {
+        const int gbits = fmt == AV_PIX_FMT_RGB565 ? 6 : 5;
+        for (i = 0; i < w; i++) {
+            int pa = AV_RN16(a + 2 * i), pb = AV_RN16(b + 2 * i);
+            if (FFABS((pa & 31) - (pb & 31)) > 2 ||
+                FFABS((pa >> 5 & ((1 << gbits) - 1)) - (pb >> 5 & ((1 << gbits) - 1))) > 2 ||
+                FFABS((pa >> (5 + gbits) & 31) - (pb >> (5 + gbits) & 31)) > 2)
+                return 1;
+        }
+    } else {
+        const int bytes = av_get_padded_bits_per_pixel(av_pix_fmt_desc_get(fmt)) >> 3;
+        for (i = 0; i < w * bytes; i++)
+            if (FFABS(a[i] - b[i]) > 6)
+                return 1;
+    }
+    return 0;
+}
+
+static void check_yuv2packed(void)
+{
+    static const enum AVPixelFormat fmts[] = {
+        AV_PIX_FMT_RGB32,  AV_PIX_FMT_BGR32,  AV_PIX_FMT_BGR24,
+        AV_PIX_FMT_RGB555, AV_PIX_FMT_RGB565, AV_PIX_FMT_YUYV422,
+    };
+    static const int filter_sizes[] = { 2, 4, 8 };
+    LOCAL_ALIGNED_32(int16_t, lum,     [MAX_LINES], [LINE_W]);
+    LOCAL_ALIGNED_32(int16_t, chr,     [MAX_LINES], [2 * LINE_W]);
+    LOCAL_ALIGNED_32(int16_t, lum_filter, [MAX_LINES]);
+    LOCAL_ALIGNED_32(int16_t, chr_filter, [MAX_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [PACKED_W * 4 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [PACKED_W * 4 + 64]);
+    const int16_t *lum_src[MAX_LINES], *u_src[MAX_LINES], *v_src[MAX_LINES];
+    int i, j, k, accurate;
+
+    for (i = 0; i < MAX_LINES; i++) {
+        for (j = 0; j < LINE_W; j++)
+            lum[i][j] = rnd() & 0x7FFF;
+        for (j = 0; j < 2 * LINE_W; j++)
+            chr[i][j] = rnd() & 0x7FFF;
+        lum_src[i] = lum[i];
+    }
+
+    for (accurate = 0; accurate <= SWS_ACCURATE_RND; accurate += SWS_ACCURATE_RND) {
+        for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmts[i]);
+            const int flags = SWS_BILINEAR | accurate;
+            SwsContext *c     = get_context(SRC_W, AV_PIX_FMT_YUV420P, PACKED_W, fmts[i], flags, 0);
+            SwsContext *c_ref = get_context(SRC_W, AV_PIX_FMT_YUV420P, PACKED_W, fmts[i], flags, 1);
+
+            if (!c || !c_ref || c->uv_offx2 / 2 + PACKED_W > 2 * LINE_W) {
+                sws_freeContext(c);
+                sws_freeContext(c_ref);
+                return;
+            }
+            /* the MMX writers expect V at a fixed offset from U */
+            for (j = 0; j < MAX_LINES; j++) {
+                u_src[j] = chr[j];
+                v_src[j] = chr[j] + c->uv_offx2 / 2;
+            }
+
+            if (c->yuv2packed1) {
+                declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, const int16_t *lumSrc,
+                                  const int16_t *chrUSrc[2], const int16_t *chrVSrc[2],
+                                  const int16_t *alpSrc, uint8_t *dest, int dstW,
+                                  int uvalpha, int y);
+
+                if (check_func(c->yuv2packed1, "yuv2%s_1", desc->name)) {
+                    for (k = 0; k < 4096; k += 3000) {
+                        memset(dst_ref, 0, PACKED_W * 4);
+                        memset(dst_new, 0, PACKED_W * 4);
+                        c_ref->yuv2packed1(c_ref, lum_src[0], u_src, v_src, lum_src[1],
+                                           dst_ref, PACKED_W, k, 0);
+                        call_new(c, lum_src[0], u_src, v_src, lum_src[1],
+                                 dst_new, PACKED_W, k, 0);
+                        if (packed_cmp(fmts[i], dst_ref, dst_new, PACKED_W))
+                            fail();
+                    }
+                    bench_new(c, lum_src[0], u_src, v_src, lum_src[1],
+                              dst_new, PACKED_W, 3000, 0);
+                }
+            }
+            if (c->yuv2packed2) {
+                declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, const int16_t *lumSrc[2],
+                                  const int16_t *chrUSrc[2], const int16_t *chrVSrc[2],
+                                  const int16_t *alpSrc[2], uint8_t *dest, int dstW,
+                                  int yalpha, int uvalpha, int y);
+
+                if (check_func(c->yuv2packed2, "yuv2%s_2", desc->name)) {
+                    const int yalpha = 1000, uvalpha = 3000;
+
+                    c->lumMmxFilter[2] =
+                    c->lumMmxFilter[3] = (4096 - yalpha)  * 0x10001;
+                    c->chrMmxFilter[2] =
+                    c->chrMmxFilter[3] = (4096 - uvalpha) * 0x10001;
+                    memset(dst_ref, 0, PACKED_W * 4);
+                    memset(dst_new, 0, PACKED_W * 4);
+                    c_ref->yuv2packed2(c_ref, lum_src, u_src, v_src, lum_src,
+                                       dst_ref, PACKED_W, yalpha, uvalpha, 0);
+                    call_new(c, lum_src, u_src, v_src, lum_src,
+                             dst_new, PACKED_W, yalpha, uvalpha, 0);
+                    if (packed_cmp(fmts[i], dst_ref, dst_new, PACKED_W))
+                        fail();
+                    bench_new(c, lum_src, u_src, v_src, lum_src,
+                              dst_new, PACKED_W, yalpha, uvalpha, 0);
+                }
+            }
+            if (c->yuv2packedX) {
+                declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, const int16_t *lumFilter,
+                                  const int16_t **lumSrc, int lumFilterSize,
+                                  const int16_t *chrFilter, const int16_t **chrUSrc,
+                                  const int16_t **chrVSrc, int chrFilterSize,
+                                  const int16_t **alpSrc, uint8_t *dest, int dstW, int y);
+
+                for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++) {
+                    const int size = filter_sizes[j];
+
+                    if (!check_func(c->yuv2packedX, "yuv2%s_X%s_%d", desc->name,
+                                    accurate ? "_ar" : "", size))
+                        continue;
+                    make_smooth_filter(lum_filter, size, 1 << 12);
+                    make_smooth_filter(chr_filter, size, 1 << 12);
+                    set_mmx_filter(c->lumMmxFilter, lum_filter, lum_src, size, accurate);
+                    set_mmx_filter(c->chrMmxFilter, chr_filter, u_src,   size, accurate);
+                    memset(dst_ref, 0, PACKED_W * 4);
+                    memset(dst_new, 0, PACKED_W * 4);
+                    c_ref->yuv2packedX(c_ref, lum_filter, lum_src, size, chr_filter,
+                                       u_src, v_src, size, lum_src, dst_ref, PACKED_W, 0);
+                    call_new(c, lum_filter, lum_src, size, chr_filter,
+                             u_src, v_src, size, lum_src, dst_new, PACKED_W, 0);
+                    if (packed_cmp(fmts[i], dst_ref, dst_new, PACKED_W))
+                        fail();
+                    bench_new(c, lum_filter, lum_src, size, chr_filter,
+                              u_src, v_src, size, lum_src, dst_new, PACKED_W, 0);
+                }
+            }
+            sws_freeContext(c);
+            sws_freeContext(c_ref);
+        }
+    }
+    report("yuv2packed");
+}
+
+/* The unscaled YUV to RGB converters, compared against the C version with
+ * the same tolerance as the packed writers. */
+static void check_yuv2rgb(void)
+{
+    static const struct {
+        enum AVPixelFormat src, dst;
+    } fmts[] = {
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_RGB32  },
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_BGR32  },
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_RGB24  },
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_BGR24  },
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_RGB565 },
+        { AV_PIX_FMT_YUV420P,  AV_PIX_FMT_RGB555 },
+        { AV_PIX_FMT_YUVA420P, AV_PIX_FMT_RGB32  },
+        { AV_PIX_FMT_YUVA420P, AV_PIX_FMT_BGR32  },
+    };
+    const int w = PACKED_W, h = 16, dst_stride = w * 4 + 64;
+    LOCAL_ALIGNED_32(uint8_t, src_y,   [PACKED_W * 16]);
+    LOCAL_ALIGNED_32(uint8_t, src_u,   [PACKED_W / 2 * 16]);
+    LOCAL_ALIGNED_32(uint8_t, src_v,   [PACKED_W / 2 * 16]);
+    LOCAL_ALIGNED_32(uint8_t, src_a,   [PACKED_W * 16]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [(PACKED_W * 4 + 64) * 16]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [(PACKED_W * 4 + 64) * 16]);
+    const uint8_t *src[4] = { src_y, src_u, src_v, src_a };
+    uint8_t *dst_r[4] = { dst_ref }, *dst_n[4] = { dst_new };
+    int src_strides[4] = { PACKED_W, PACKED_W / 2, PACKED_W / 2, PACKED_W };
+    int dst_strides[4] = { dst_stride };
+    int log_level = av_log_get_level();
+    int i, j;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, SwsContext *c, const uint8_t *src[],
+                      int srcStride[], int srcSliceY, int srcSliceH,
+                      uint8_t *dst[], int dstStride[]);
+
+    randomize_buffers(src_y, w * h);
+    randomize_buffers(src_u, w / 2 * h);
+    randomize_buffers(src_v, w / 2 * h);
+    randomize_buffers(src_a, w * h);
+    /* silence the warning about missing converters for the C context */
+    av_log_set_level(AV_LOG_ERROR);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(fmts[i].src);
+        const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(fmts[i].dst);
+        SwsContext *c     = get_context(w, fmts[i].src, w, fmts[i].dst, SWS_BILINEAR, 0);
+        SwsContext *c_ref = get_context(w, fmts[i].src, w, fmts[i].dst, SWS_BILINEAR, 1);
+
+        if (!c || !c_ref) {
+            sws_freeContext(c);
+            sws_freeContext(c_ref);
+            break;
+        }
+        if (check_func(c->swscale, "yuv2rgb_%s_%s", src_desc->name, dst_desc->name)) {
+            memset(dst_ref, 0, dst_stride * h);
+            memset(dst_new, 0, dst_stride * h);
+            c_ref->swscale(c_ref, src, src_strides, 0, h, dst_r, dst_strides);
+            call_new(c, src, src_strides, 0, h, dst_n, dst_strides);
+            for (j = 0; j < h; j++)
+                if (packed_cmp(fmts[i].dst, dst_ref + j * dst_stride,
+                                dst_new + j * dst_stride, w))
+                    break;
+            if (j < h)
+                fail();
+            bench_new(c, src, src_strides, 0, h, dst_n, dst_strides);
+        }
+        sws_freeContext(c);
+        sws_freeContext(c_ref);
+    }
+    av_log_set_level(log_level);
+    report("yuv2rgb");
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    check_yuv2planeX();
+    check_yuv2planeX_mmx();
+    check_yuv2plane1();
+    check_input();
+    check_yuv2packed();
+    check_yuv2rgb();
+}
@@ -1096,3 +1096,11 @@ fate-swr-audioconvert: FUZZ = 0
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
 FATE_FFMPEG += $(FATE_SWR)
 fate-swr: $(FATE_SWR)
+
+FATE_LIBSWRESAMPLE += fate-swr-low-delay
+fate-swr-low-delay: libswresample/tests/low_delay$(EXESUF)
+fate-swr-low-delay: CMD = run libswresample/tests/low_delay
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_LIBSWRESAMPLE)
+fate-libswresample: $(FATE_LIBSWRESAMPLE)
+fate-swr: $(FATE_LIBSWRESAMPLE)
@@ -274,6 +274,18 @@ fate-vsynth%-mpeg2-thread:       ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
 fate-vsynth%-mpeg2-thread-ivlc:  ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
                                            -intra_vlc 1 -threads 2 -slices 2
 
+# frame threads code whole pictures or GOPs, as a single thread does
+FATE_MPEG2_FRAME_THREADS = fate-mpeg2-intra-threads-1 fate-mpeg2-intra-threads-4 \
+                           fate-mpeg2-gop-threads-1 fate-mpeg2-gop-threads-4
+FATE_MPEG2_FRAME_THREADS-$(call ENCMUX, MPEG2VIDEO, FRAMEMD5) += $(FATE_MPEG2_FRAME_THREADS)
+fate-mpeg2-intra-threads-%: CMD = framemd5 -f rawvideo -s 352x288 -pix_fmt yuv420p -i $(TARGET_PATH)/tests/data/vsynth1.yuv -vframes 10 -c:v mpeg2video -qscale:v 4 -g 1 -thread_type frame -threads $(@:fate-mpeg2-intra-threads-%=%)
+fate-mpeg2-intra-threads-%: REF = $(SRC_PATH)/tests/ref/fate/mpeg2-intra-threads
+fate-mpeg2-gop-threads-%: CMD = framemd5 -f rawvideo -s 352x288 -pix_fmt yuv420p -i $(TARGET_PATH)/tests/data/vsynth1.yuv -vframes 30 -c:v mpeg2video -qscale:v 4 -g 12 -bf 2 -flags +cgop+ildct+ilme -mpv_flags +strict_gop -sc_threshold 1000000000 -thread_type frame -threads $(@:fate-mpeg2-gop-threads-%=%)
+fate-mpeg2-gop-threads-%: REF = $(SRC_PATH)/tests/ref/fate/mpeg2-gop-threads
+$(FATE_MPEG2_FRAME_THREADS-yes): tests/data/vsynth1.yuv
+FATE_AVCONV += $(FATE_MPEG2_FRAME_THREADS-yes)
+fate-mpeg2-frame-threads: $(FATE_MPEG2_FRAME_THREADS-yes)
+
 FATE_MPEG4_MP4 = mpeg4
 FATE_MPEG4_AVI = mpeg4-rc                                               \
                  mpeg4-adv                                              \
@@ -334,6 +346,14 @@ fate-vsynth%-msmpeg4v2:          ENCOPTS = -qscale 10
 FATE_VCODEC-$(call ENCDEC, PNG, AVI)    += mpng
 fate-vsynth%-mpng:               CODEC   = png
 
+# the bands deflated by the slice threads must not depend on the thread count
+FATE_PNG_SLICE-$(call ENCMUX, PNG, IMAGE2PIPE) += fate-png-slice-1 fate-png-slice-4
+fate-png-slice-%: CMD = md5 -f rawvideo -s 352x288 -pix_fmt yuv420p -i $(TARGET_PATH)/tests/data/vsynth1.yuv -vframes 2 -pix_fmt rgb24 -c:v png -thread_type slice -threads $(@:fate-png-slice-%=%) -f image2pipe
+fate-png-slice-%: REF = $(SRC_PATH)/tests/ref/fate/png-slice
+$(FATE_PNG_SLICE-yes): tests/data/vsynth1.yuv
+FATE_AVCONV += $(FATE_PNG_SLICE-yes)
+fate-png-slice: $(FATE_PNG_SLICE-yes)
+
 FATE_VCODEC-$(call ENCDEC, MSVIDEO1, AVI) += msvideo1
 
 FATE_VCODEC-$(call ENCDEC, PRORES, MOV) += prores prores_int prores_444 prores_444_int prores_ks
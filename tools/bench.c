@@ -0,0 +1,1244 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Speed benchmarks on synthetic input.
+ *
+ * The first argument selects the test, the remaining ones are the options of
+ * that test, tools/bench <test> -h lists them. Build it with make tools/bench
+ * and run it against two builds to compare them, e.g.
+ * tools/bench aenc -c opus -b 128000 -l 0-10 -t 1
+ *
+ * The tests are
+ *  aenc      encode a stereo signal (tones plus noise) once for every
+ *            requested compression level and print the encoding speed
+ *  adec      encode a multichannel signal once, then decode it with several
+ *            independent decoder instances fed in turn, the way a server
+ *            handles many streams, and print the aggregate decoding speed
+ *  venc      encode a moving pattern single threaded and then with slice
+ *            and with frame threads for every thread count up to the
+ *            requested one, and print the speed of each run; -C codes
+ *            closed GOPs of a fixed length, which frame threads code in
+ *            parallel also with P- and B-frames
+ *  prores    encode a 10 bit clip alternating between detailed and flat
+ *            segments with prores_ks, once with a fixed quantiser and then
+ *            with the slice and the frame rate control modes, and print the
+ *            quantiser search time per frame and the data rate against the
+ *            profile target
+ *  sws       time sws_scale() for every combination of the given source and
+ *            destination formats, sizes and flags and print one CSV line for
+ *            each, with -c also the time with the CPU flags cleared and the
+ *            speedup of the SIMD code over the C code
+ *  imgutils  time the libavutil image copy and plane conversion functions
+ *            for every combination of the given formats and sizes and print
+ *            one CSV line for each operation, with the time per image and the
+ *            bandwidth (bytes read plus written)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+#include "libavutil/avstring.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/cpu.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+#include "libswscale/swscale.h"
+
+typedef struct AudioSource {
+    AVLFG lfg;
+    int   base_freq;
+} AudioSource;
+
+/* Fill frame n with tones at base_freq << channel plus a sweep and noise. */
+static void fill_audio_frame(AVFrame *frame, int n, void *opaque)
+{
+    AudioSource *src = opaque;
+    int planar  = av_sample_fmt_is_planar(frame->format);
+    int64_t pos = (int64_t)n * frame->nb_samples;
+    int ch, i;
+
+    for (i = 0; i < frame->nb_samples; i++) {
+        double t = (double)(pos + i) / frame->sample_rate;
+        for (ch = 0; ch < frame->channels; ch++) {
+            double v = 0.3 * sin(2 * M_PI * (src->base_freq << ch) * t) +
+                       0.2 * sin(2 * M_PI * 3000 * t * (1 + 0.1 * sin(t))) +
+                       0.1 * ((double)av_lfg_get(&src->lfg) / UINT_MAX - 0.5);
+            int idx = planar ? i : i * frame->channels + ch;
+            uint8_t *dst = frame->extended_data[planar ? ch : 0];
+
+            switch (frame->format) {
+            case AV_SAMPLE_FMT_FLT:
+            case AV_SAMPLE_FMT_FLTP:
+                ((float *)dst)[idx] = v;
+                break;
+            case AV_SAMPLE_FMT_S16:
+            case AV_SAMPLE_FMT_S16P:
+                ((int16_t *)dst)[idx] = lrint(v * 32767);
+                break;
+            case AV_SAMPLE_FMT_S32:
+            case AV_SAMPLE_FMT_S32P:
+                ((int32_t *)dst)[idx] = lrint(v * 2147483647.0);
+                break;
+            }
+        }
+    }
+    frame->pts = pos;
+}
+
+static int pick_sample_fmt(const AVCodec *codec)
+{
+    const enum AVSampleFormat *fmt;
+
+    for (fmt = codec->sample_fmts; fmt && *fmt != AV_SAMPLE_FMT_NONE; fmt++) {
+        switch (*fmt) {
+        case AV_SAMPLE_FMT_FLT:
+        case AV_SAMPLE_FMT_FLTP:
+        case AV_SAMPLE_FMT_S16:
+        case AV_SAMPLE_FMT_S16P:
+        case AV_SAMPLE_FMT_S32:
+        case AV_SAMPLE_FMT_S32P:
+            return *fmt;
+        }
+    }
+    return AV_SAMPLE_FMT_NONE;
+}
+
+static int open_audio_encoder(AVCodecContext *avctx, const AVCodec *codec,
+                              AVFrame *frame)
+{
+    int ret;
+
+    avctx->sample_fmt            = pick_sample_fmt(codec);
+    avctx->sample_rate           = 48000;
+    avctx->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+    avctx->time_base             = (AVRational){ 1, avctx->sample_rate };
+
+    if (avctx->sample_fmt == AV_SAMPLE_FMT_NONE) {
+        fprintf(stderr, "No supported sample format for %s\n", codec->name);
+        return AVERROR(EINVAL);
+    }
+    if ((ret = avcodec_open2(avctx, codec, NULL)) < 0) {
+        fprintf(stderr, "Could not open %s\n", codec->name);
+        return ret;
+    }
+
+    frame->format         = avctx->sample_fmt;
+    frame->sample_rate    = avctx->sample_rate;
+    frame->channels       = avctx->channels;
+    frame->channel_layout = avctx->channel_layout;
+    frame->nb_samples     = avctx->frame_size ? avctx->frame_size : 1024;
+    return av_frame_get_buffer(frame, 0);
+}
+
+/*
+ * Encode nb_frames frames produced by fill() and flush the encoder. The
+ * packets are appended to *pkts if pkts is not NULL and freed otherwise, the
+ * total packet size is added to *bytes.
+ */
+static int encode_frames(AVCodecContext *avctx, AVFrame *frame, int nb_frames,
+                         void (*fill)(AVFrame *frame, int n, void *opaque),
+                         void *opaque, AVPacket ***pkts, int *nb_pkts,
+                         int64_t *bytes)
+{
+    AVPacket *pkt = NULL;
+    int n = 0, ret;
+
+    while (1) {
+        if (n < nb_frames) {
+            if ((ret = av_frame_make_writable(frame)) < 0)
+                return ret;
+            fill(frame, n++, opaque);
+            ret = avcodec_send_frame(avctx, frame);
+        } else {
+            ret = avcodec_send_frame(avctx, NULL);
+        }
+        if (ret < 0 && ret != AVERROR_EOF)
+            return ret;
+
+        while (1) {
+            if (!pkt && !(pkt = av_packet_alloc()))
+                return AVERROR(ENOMEM);
+            if ((ret = avcodec_receive_packet(avctx, pkt)) < 0)
+                break;
+            *bytes += pkt->size;
+            if (pkts) {
+                AVPacket **tmp = av_realloc_array(*pkts, *nb_pkts + 1,
+                                                  sizeof(**pkts));
+                if (!tmp) {
+                    av_packet_free(&pkt);
+                    return AVERROR(ENOMEM);
+                }
+                *pkts = tmp;
+                (*pkts)[(*nb_pkts)++] = pkt;
+                pkt = NULL;
+            } else {
+                av_packet_unref(pkt);
+            }
+        }
+        if (ret == AVERROR_EOF)
+            break;
+        if (ret != AVERROR(EAGAIN)) {
+            av_packet_free(&pkt);
+            return ret;
+        }
+    }
+
+    av_packet_free(&pkt);
+    return 0;
+}
+
+static int aenc_run_level(const AVCodec *codec, int level, int64_t bit_rate,
+                          int threads, double duration)
+{
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    int64_t bytes = 0, start, elapsed;
+    AudioSource src = { .base_freq = 220 };
+    int ret;
+
+    if (!avctx || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    avctx->channels          = 2;
+    avctx->channel_layout    = AV_CH_LAYOUT_STEREO;
+    avctx->bit_rate          = bit_rate;
+    avctx->compression_level = level;
+    avctx->thread_count      = threads;
+    if ((ret = open_audio_encoder(avctx, codec, frame)) < 0)
+        goto end;
+
+    av_lfg_init(&src.lfg, 0xdeadbeef);
+    start = av_gettime_relative();
+    ret   = encode_frames(avctx, frame,
+                          ceil(duration * avctx->sample_rate / frame->nb_samples),
+                          fill_audio_frame, &src, NULL, NULL, &bytes);
+    if (ret < 0)
+        goto end;
+    elapsed = av_gettime_relative() - start;
+
+    printf("%-12s %5d %7d %10.3f %10.2f %10"PRId64"\n", codec->name, level,
+           threads, elapsed / 1000.0,
+           elapsed ? duration * 1000000.0 / elapsed : 0.0, bytes);
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&avctx);
+    return ret;
+}
+
+static int bench_aenc(int argc, char **argv)
+{
+    const char *codec_name = "opus";
+    const AVCodec *codec;
+    int64_t bit_rate = 128000;
+    int level_min = 0, level_max = 10, threads = 1;
+    double duration = 10.0;
+    int level, opt;
+
+    av_log_set_level(AV_LOG_WARNING);
+
+    while ((opt = getopt(argc, argv, "hc:b:l:t:d:")) != -1) {
+        switch (opt) {
+        case 'c':
+            codec_name = optarg;
+            break;
+        case 'b':
+            bit_rate = strtoll(optarg, NULL, 0);
+            break;
+        case 'l':
+            if (sscanf(optarg, "%d-%d", &level_min, &level_max) < 2)
+                level_max = level_min;
+            break;
+        case 't':
+            threads = strtol(optarg, NULL, 0);
+            break;
+        case 'd':
+            duration = strtod(optarg, NULL);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-c encoder] [-b bitrate] [-l min[-max]] "
+                    "[-t threads] [-d seconds]\n", argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    codec = avcodec_find_encoder_by_name(codec_name);
+    if (!codec || codec->type != AVMEDIA_TYPE_AUDIO) {
+        fprintf(stderr, "Audio encoder %s not found\n", codec_name);
+        return 1;
+    }
+
+    printf("%-12s %5s %7s %10s %10s %10s\n",
+           "encoder", "level", "threads", "time(ms)", "realtime", "bytes");
+    for (level = level_min; level <= level_max; level++)
+        if (aenc_run_level(codec, level, bit_rate, threads, duration) < 0)
+            return 1;
+
+    return 0;
+}
+
+#define MAX_STREAMS 64
+
+static int adec_run_streams(const AVCodec *codec, const AVCodecContext *enc,
+                            AVPacket **pkts, int nb_pkts, int nb_streams,
+                            int threads, double duration)
+{
+    AVCodecContext *dec[MAX_STREAMS] = { NULL };
+    AVFrame *frame = av_frame_alloc();
+    int64_t samples = 0, start, elapsed;
+    int i, j, ret;
+
+    if (!frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (j = 0; j < nb_streams; j++) {
+        if (!(dec[j] = avcodec_alloc_context3(codec))) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        dec[j]->sample_rate    = enc->sample_rate;
+        dec[j]->channels       = enc->channels;
+        dec[j]->channel_layout = enc->channel_layout;
+        dec[j]->thread_count   = threads;
+        if (enc->extradata_size) {
+            dec[j]->extradata = av_mallocz(enc->extradata_size +
+                                           AV_INPUT_BUFFER_PADDING_SIZE);
+            if (!dec[j]->extradata) {
+                ret = AVERROR(ENOMEM);
+                goto end;
+            }
+            memcpy(dec[j]->extradata, enc->extradata, enc->extradata_size);
+            dec[j]->extradata_size = enc->extradata_size;
+        }
+        if ((ret = avcodec_open2(dec[j], codec, NULL)) < 0) {
+            fprintf(stderr, "Could not open %s\n", codec->name);
+            goto end;
+        }
+    }
+
+    start = av_gettime_relative();
+    for (i = 0; i <= nb_pkts; i++) {
+        for (j = 0; j < nb_streams; j++) {
+            ret = avcodec_send_packet(dec[j], i < nb_pkts ? pkts[i] : NULL);
+            if (ret < 0 && ret != AVERROR_EOF)
+                goto end;
+            while ((ret = avcodec_receive_frame(dec[j], frame)) >= 0) {
+                samples += frame->nb_samples;
+                av_frame_unref(frame);
+            }
+            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+                goto end;
+        }
+    }
+    elapsed = av_gettime_relative() - start;
+
+    printf("%-12s %8d %7d %7d %10.3f %10.2f %12"PRId64"\n", codec->name,
+           enc->channels, nb_streams, threads, elapsed / 1000.0,
+           elapsed ? nb_streams * duration * 1000000.0 / elapsed : 0.0,
+           samples);
+    ret = 0;
+
+end:
+    for (j = 0; j < nb_streams; j++)
+        avcodec_free_context(&dec[j]);
+    av_frame_free(&frame);
+    return ret;
+}
+
+static int bench_adec(int argc, char **argv)
+{
+    const char *enc_name = "aac", *dec_name = NULL;
+    const AVCodec *encoder, *decoder;
+    AVCodecContext *enc = NULL;
+    AVFrame *frame = NULL;
+    AVPacket **pkts = NULL;
+    AudioSource src = { .base_freq = 110 };
+    int64_t bit_rate = 0, bytes = 0;
+    int channels = 6, nb_streams = 1, threads = 1, nb_pkts = 0;
+    double duration = 10.0;
+    int i, opt, ret;
+
+    av_log_set_level(AV_LOG_WARNING);
+
+    while ((opt = getopt(argc, argv, "he:c:b:n:s:t:d:")) != -1) {
+        switch (opt) {
+        case 'e':
+            enc_name = optarg;
+            break;
+        case 'c':
+            dec_name = optarg;
+            break;
+        case 'b':
+            bit_rate = strtoll(optarg, NULL, 0);
+            break;
+        case 'n':
+            channels = av_clip(strtol(optarg, NULL, 0), 1, 8);
+            break;
+        case 's':
+            nb_streams = av_clip(strtol(optarg, NULL, 0), 1, MAX_STREAMS);
+            break;
+        case 't':
+            threads = strtol(optarg, NULL, 0);
+            break;
+        case 'd':
+            duration = strtod(optarg, NULL);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-e encoder] [-c decoder] [-b bitrate] "
+                    "[-n channels] [-s streams] [-t threads] [-d seconds]\n",
+                    argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    encoder = avcodec_find_encoder_by_name(enc_name);
+    if (!encoder || encoder->type != AVMEDIA_TYPE_AUDIO) {
+        fprintf(stderr, "Audio encoder %s not found\n", enc_name);
+        return 1;
+    }
+    decoder = dec_name ? avcodec_find_decoder_by_name(dec_name)
+                       : avcodec_find_decoder(encoder->id);
+    if (!decoder || decoder->id != encoder->id) {
+        fprintf(stderr, "No matching decoder for %s\n", enc_name);
+        return 1;
+    }
+
+    enc   = avcodec_alloc_context3(encoder);
+    frame = av_frame_alloc();
+    if (!enc || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    enc->channels       = channels;
+    enc->channel_layout = av_get_default_channel_layout(channels);
+    enc->bit_rate       = bit_rate ? bit_rate : 64000 * channels;
+    if ((ret = open_audio_encoder(enc, encoder, frame)) < 0)
+        goto end;
+
+    av_lfg_init(&src.lfg, 0xdeadbeef);
+    ret = encode_frames(enc, frame,
+                        ceil(duration * enc->sample_rate / frame->nb_samples),
+                        fill_audio_frame, &src, &pkts, &nb_pkts, &bytes);
+    if (ret < 0)
+        goto end;
+
+    printf("%-12s %8s %7s %7s %10s %10s %12s\n", "decoder", "channels",
+           "streams", "threads", "time(ms)", "realtime", "samples");
+    ret = adec_run_streams(decoder, enc, pkts, nb_pkts, nb_streams, threads,
+                           duration);
+
+end:
+    for (i = 0; i < nb_pkts; i++)
+        av_packet_free(&pkts[i]);
+    av_freep(&pkts);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret < 0;
+}
+
+typedef struct VencParams {
+    int width, height;
+    int gop_size;
+    int max_b_frames;
+    int closed_gop;
+    int qscale;
+    int64_t bit_rate;
+    int nb_frames;
+} VencParams;
+
+typedef struct VideoSource {
+    AVLFG lfg;
+    int   qscale;
+} VideoSource;
+
+static void fill_video_frame(AVFrame *frame, int n, void *opaque)
+{
+    VideoSource *src = opaque;
+    int x, y, p;
+
+    for (p = 0; p < 3; p++) {
+        int w = p ? AV_CEIL_RSHIFT(frame->width,  1) : frame->width;
+        int h = p ? AV_CEIL_RSHIFT(frame->height, 1) : frame->height;
+
+        for (y = 0; y < h; y++) {
+            uint8_t *dst = frame->data[p] + y * frame->linesize[p];
+            for (x = 0; x < w; x++)
+                dst[x] = p ? 128 + ((x + 2 * n) >> 3) - ((y - n) >> 4) :
+                         ((x + 3 * n) ^ (y + n)) + (av_lfg_get(&src->lfg) & 7);
+        }
+    }
+    if (src->qscale)
+        frame->quality = FF_QP2LAMBDA * src->qscale;
+    frame->pts = n;
+}
+
+/* The first run sets the reference speed the others are scaled against. */
+static int venc_run(const AVCodec *codec, const VencParams *p,
+                    int thread_type, int threads, double *base)
+{
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    AVDictionary *opts = NULL;
+    VideoSource src = { .qscale = p->qscale };
+    int64_t bytes = 0, start, elapsed;
+    double fps;
+    int ret;
+
+    if (!avctx || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    avctx->width        = p->width;
+    avctx->height       = p->height;
+    avctx->pix_fmt      = AV_PIX_FMT_YUV420P;
+    avctx->time_base    = (AVRational){ 1, 25 };
+    avctx->gop_size     = p->gop_size;
+    avctx->max_b_frames = p->max_b_frames;
+    avctx->thread_count = threads;
+    avctx->thread_type  = thread_type;
+    if (p->qscale) {
+        avctx->flags         |= AV_CODEC_FLAG_QSCALE;
+        avctx->global_quality = FF_QP2LAMBDA * p->qscale;
+    } else {
+        avctx->bit_rate = p->bit_rate;
+    }
+    if (p->closed_gop) {
+        avctx->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+        av_dict_set(&opts, "mpv_flags", "+strict_gop", 0);
+        av_dict_set(&opts, "sc_threshold", "1000000000", 0);
+    }
+
+    ret = avcodec_open2(avctx, codec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        fprintf(stderr, "Could not open %s\n", codec->name);
+        goto end;
+    }
+
+    frame->format = avctx->pix_fmt;
+    frame->width  = avctx->width;
+    frame->height = avctx->height;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+
+    av_lfg_init(&src.lfg, 0xdeadbeef);
+    start = av_gettime_relative();
+    ret   = encode_frames(avctx, frame, p->nb_frames, fill_video_frame, &src,
+                          NULL, NULL, &bytes);
+    if (ret < 0)
+        goto end;
+    elapsed = av_gettime_relative() - start;
+
+    fps = elapsed ? p->nb_frames * 1000000.0 / elapsed : 0.0;
+    if (!*base)
+        *base = fps;
+    printf("%-12s %6s %7d %10.3f %10.2f %12"PRId64" %8.2f\n", codec->name,
+           avctx->active_thread_type == FF_THREAD_FRAME ? "frame" :
+           avctx->active_thread_type == FF_THREAD_SLICE ? "slice" : "none",
+           threads, elapsed / 1000.0, fps, bytes, *base ? fps / *base : 0.0);
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&avctx);
+    return ret;
+}
+
+static int bench_venc(int argc, char **argv)
+{
+    const char *codec_name = "mpeg2video";
+    const AVCodec *codec;
+    VencParams p = { 720, 576, 1, 0, 0, 4, 0, 100 };
+    int threads = 4, t, opt;
+    double base = 0;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    while ((opt = getopt(argc, argv, "hc:s:g:B:Cq:b:n:t:")) != -1) {
+        switch (opt) {
+        case 'c':
+            codec_name = optarg;
+            break;
+        case 's':
+            if (av_parse_video_size(&p.width, &p.height, optarg) < 0) {
+                fprintf(stderr, "Invalid size %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'g':
+            p.gop_size = strtol(optarg, NULL, 0);
+            break;
+        case 'B':
+            p.max_b_frames = strtol(optarg, NULL, 0);
+            break;
+        case 'C':
+            p.closed_gop = 1;
+            break;
+        case 'q':
+            p.qscale = strtol(optarg, NULL, 0);
+            break;
+        case 'b':
+            p.bit_rate = strtoll(optarg, NULL, 0);
+            p.qscale   = 0;
+            break;
+        case 'n':
+            p.nb_frames = strtol(optarg, NULL, 0);
+            break;
+        case 't':
+            threads = strtol(optarg, NULL, 0);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-c encoder] [-s WxH] [-g gop] "
+                    "[-B b-frames] [-C] [-q qscale | -b bitrate] [-n frames] [-t max threads]\n",
+                    argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    codec = avcodec_find_encoder_by_name(codec_name);
+    if (!codec || codec->type != AVMEDIA_TYPE_VIDEO) {
+        fprintf(stderr, "Video encoder %s not found\n", codec_name);
+        return 1;
+    }
+
+    printf("%-12s %6s %7s %10s %10s %12s %8s\n", "encoder", "mode",
+           "threads", "time(ms)", "fps", "bytes", "scaling");
+    if (venc_run(codec, &p, 0, 1, &base) < 0)
+        return 1;
+    for (t = 2; t <= threads; t++) {
+        if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS &&
+            venc_run(codec, &p, FF_THREAD_SLICE, t, &base) < 0)
+            return 1;
+        if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS &&
+            venc_run(codec, &p, FF_THREAD_FRAME, t, &base) < 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+typedef struct ProresParams {
+    int width, height;
+    const char *profile;
+    int qscale;
+    int lookahead;
+    int segment;
+    int threads;
+    int nb_frames;
+} ProresParams;
+
+typedef struct ProresSource {
+    AVLFG lfg;
+    int   segment;
+    int   quality;
+} ProresSource;
+
+static void fill_prores_frame(AVFrame *frame, int n, void *opaque)
+{
+    ProresSource *src = opaque;
+    int detailed = (n / src->segment) & 1;
+    int x, y, p;
+
+    for (p = 0; p < 3; p++) {
+        int w = p ? AV_CEIL_RSHIFT(frame->width, 1) : frame->width;
+
+        for (y = 0; y < frame->height; y++) {
+            uint16_t *dst = (uint16_t *)(frame->data[p] + y * frame->linesize[p]);
+            for (x = 0; x < w; x++) {
+                int v = p ? 512 + ((x + 2 * n) >> 2) - (y >> 3)
+                          : 64 + ((x + 3 * n) ^ (y + n)) % 896;
+                if (detailed)
+                    v += (av_lfg_get(&src->lfg) & 127) - 64;
+                dst[x] = av_clip_uintp2(v, 10);
+            }
+        }
+    }
+    frame->quality = src->quality;
+    frame->pts     = n;
+}
+
+/* The fixed quantiser run comes first and sets the time the others are
+ * compared against. */
+static int prores_run(const AVCodec *codec, const ProresParams *p,
+                      const char *rc, double *base)
+{
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    ProresSource src = { .segment = p->segment };
+    int64_t bytes = 0, start, elapsed, bits_per_mb = 0;
+    double ms, target;
+    int ret;
+
+    if (!avctx || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    avctx->width        = p->width;
+    avctx->height       = p->height;
+    avctx->pix_fmt      = AV_PIX_FMT_YUV422P10;
+    avctx->time_base    = (AVRational){ 1, 25 };
+    avctx->thread_count = p->threads;
+    avctx->thread_type  = FF_THREAD_SLICE;
+    if (rc) {
+        av_opt_set    (avctx->priv_data, "rc",           rc,           0);
+        av_opt_set_int(avctx->priv_data, "rc_lookahead", p->lookahead, 0);
+    } else {
+        avctx->flags         |= AV_CODEC_FLAG_QSCALE;
+        avctx->global_quality = FF_QP2LAMBDA * p->qscale;
+        src.quality           = avctx->global_quality;
+    }
+    if ((ret = av_opt_set(avctx->priv_data, "profile", p->profile, 0)) < 0) {
+        fprintf(stderr, "Invalid profile %s\n", p->profile);
+        goto end;
+    }
+
+    if ((ret = avcodec_open2(avctx, codec, NULL)) < 0) {
+        fprintf(stderr, "Could not open %s\n", codec->name);
+        goto end;
+    }
+    av_opt_get_int(avctx->priv_data, "bits_per_mb", 0, &bits_per_mb);
+
+    frame->format = avctx->pix_fmt;
+    frame->width  = avctx->width;
+    frame->height = avctx->height;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+
+    av_lfg_init(&src.lfg, 0xdeadbeef);
+    start = av_gettime_relative();
+    ret   = encode_frames(avctx, frame, p->nb_frames, fill_prores_frame, &src,
+                          NULL, NULL, &bytes);
+    if (ret < 0)
+        goto end;
+    elapsed = av_gettime_relative() - start;
+
+    ms     = elapsed / 1000.0 / p->nb_frames;
+    target = bits_per_mb * ((p->width + 15) >> 4) * ((p->height + 15) >> 4) / 1000.0;
+    if (!rc)
+        *base = ms;
+    printf("%-8s %7d %10.3f %10.3f %12.1f", rc ? rc : "qscale", p->threads,
+           ms, ms - *base, bytes * 8 / 1000.0 / p->nb_frames);
+    if (rc)
+        printf(" %12.1f %8.3f\n", target, bytes * 8 / 1000.0 / p->nb_frames / target);
+    else
+        printf(" %12s %8s\n", "-", "-");
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&avctx);
+    return ret;
+}
+
+static int bench_prores(int argc, char **argv)
+{
+    const AVCodec *codec;
+    ProresParams p = { 1920, 1080, "hq", 4, 8, 25, 1, 100 };
+    double base = 0;
+    int opt;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    while ((opt = getopt(argc, argv, "hs:p:q:l:g:t:n:")) != -1) {
+        switch (opt) {
+        case 's':
+            if (av_parse_video_size(&p.width, &p.height, optarg) < 0) {
+                fprintf(stderr, "Invalid size %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            p.profile = optarg;
+            break;
+        case 'q':
+            p.qscale = strtol(optarg, NULL, 0);
+            break;
+        case 'l':
+            p.lookahead = strtol(optarg, NULL, 0);
+            break;
+        case 'g':
+            p.segment = FFMAX(strtol(optarg, NULL, 0), 1);
+            break;
+        case 't':
+            p.threads = strtol(optarg, NULL, 0);
+            break;
+        case 'n':
+            p.nb_frames = FFMAX(strtol(optarg, NULL, 0), 1);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-s WxH] [-p profile] [-q qscale] "
+                    "[-l lookahead] [-g segment length] [-t threads] [-n frames]\n",
+                    argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    codec = avcodec_find_encoder_by_name("prores_ks");
+    if (!codec) {
+        fprintf(stderr, "Encoder prores_ks not found\n");
+        return 1;
+    }
+
+    printf("%-8s %7s %10s %10s %12s %12s %8s\n", "rc", "threads",
+           "ms/frame", "search ms", "kbit/frame", "target kbit", "ratio");
+    if (prores_run(codec, &p, NULL,    &base) < 0 ||
+        prores_run(codec, &p, "slice", &base) < 0 ||
+        prores_run(codec, &p, "frame", &base) < 0)
+        return 1;
+
+    return 0;
+}
+
+typedef struct Image {
+    uint8_t *data[4];
+    int linesize[4];
+} Image;
+
+static int alloc_image(Image *img, int w, int h, enum AVPixelFormat fmt,
+                           AVLFG *lfg)
+{
+    int i, size = av_image_alloc(img->data, img->linesize, w, h, fmt, 32);
+
+    if (size < 0)
+        return size;
+    for (i = 0; i + 4 <= size; i += 4)
+        AV_WN32(img->data[0] + i, av_lfg_get(lfg));
+    return 0;
+}
+
+/* Returns the time per call in milliseconds, or a negative error code. */
+static double sws_run(enum AVPixelFormat src_fmt, int src_w, int src_h,
+                      enum AVPixelFormat dst_fmt, int dst_w, int dst_h,
+                      const char *flags, int nb_runs, AVLFG *lfg)
+{
+    struct SwsContext *sws = sws_alloc_context();
+    Image src = { { NULL } }, dst = { { NULL } };
+    int64_t start;
+    double ret;
+    int i;
+
+    if (!sws) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    av_opt_set_int(sws, "srcw",       src_w,   0);
+    av_opt_set_int(sws, "srch",       src_h,   0);
+    av_opt_set_int(sws, "src_format", src_fmt, 0);
+    av_opt_set_int(sws, "dstw",       dst_w,   0);
+    av_opt_set_int(sws, "dsth",       dst_h,   0);
+    av_opt_set_int(sws, "dst_format", dst_fmt, 0);
+    if ((ret = av_opt_set(sws, "sws_flags", flags, 0)) < 0) {
+        fprintf(stderr, "Invalid flags %s\n", flags);
+        goto end;
+    }
+    if ((ret = sws_init_context(sws, NULL, NULL)) < 0)
+        goto end;
+
+    if ((ret = alloc_image(&src, src_w, src_h, src_fmt, lfg)) < 0 ||
+        (ret = alloc_image(&dst, dst_w, dst_h, dst_fmt, lfg)) < 0)
+        goto end;
+
+    /* one untimed run to fault in the buffers and the filter tables */
+    sws_scale(sws, (const uint8_t * const *)src.data, src.linesize, 0, src_h,
+              dst.data, dst.linesize);
+    start = av_gettime_relative();
+    for (i = 0; i < nb_runs; i++)
+        sws_scale(sws, (const uint8_t * const *)src.data, src.linesize, 0, src_h,
+                  dst.data, dst.linesize);
+    ret = (av_gettime_relative() - start) / 1000.0 / nb_runs;
+
+end:
+    av_freep(&src.data[0]);
+    av_freep(&dst.data[0]);
+    sws_freeContext(sws);
+    return ret;
+}
+
+static int bench_sws(int argc, char **argv)
+{
+    const char *src_fmts = "yuv420p,yuv420p10le,nv12,rgb24";
+    const char *dst_fmts = "yuv420p,yuv420p10le,rgb24";
+    const char *sizes    = "1920x1080:1280x720,1280x720:1920x1080";
+    const char *flags    = "bilinear,bicubic,lanczos+accurate_rnd";
+    char *src_list, *dst_list, *size_list, *flag_list;
+    char *src_save, *dst_save, *size_save, *flag_save;
+    char *s, *d, *z, *f;
+    int cpu_flags = av_get_cpu_flags();
+    int nb_runs = 20, compare_c = 0, opt, ret = 0;
+    AVLFG lfg;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    while ((opt = getopt(argc, argv, "hi:o:s:f:n:c")) != -1) {
+        switch (opt) {
+        case 'i':
+            src_fmts = optarg;
+            break;
+        case 'o':
+            dst_fmts = optarg;
+            break;
+        case 's':
+            sizes = optarg;
+            break;
+        case 'f':
+            flags = optarg;
+            break;
+        case 'n':
+            nb_runs = FFMAX(strtol(optarg, NULL, 0), 1);
+            break;
+        case 'c':
+            compare_c = 1;
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-i src formats] [-o dst formats] "
+                    "[-s WxH:WxH,...] [-f flags,...] [-n runs] [-c]\n", argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    printf("src_fmt,dst_fmt,src_size,dst_size,flags,ms");
+    if (compare_c)
+        printf(",c_ms,speedup");
+    printf("\n");
+
+    src_list = av_strdup(src_fmts);
+    for (s = av_strtok(src_list, ",", &src_save); s; s = av_strtok(NULL, ",", &src_save)) {
+        enum AVPixelFormat src_fmt = av_get_pix_fmt(s);
+
+        dst_list = av_strdup(dst_fmts);
+        for (d = av_strtok(dst_list, ",", &dst_save); d; d = av_strtok(NULL, ",", &dst_save)) {
+            enum AVPixelFormat dst_fmt = av_get_pix_fmt(d);
+
+            size_list = av_strdup(sizes);
+            for (z = av_strtok(size_list, ",", &size_save); z; z = av_strtok(NULL, ",", &size_save)) {
+                char *dst_size = strchr(z, ':');
+                int src_w, src_h, dst_w, dst_h;
+
+                if (dst_size)
+                    *dst_size++ = 0;
+                if (src_fmt == AV_PIX_FMT_NONE || dst_fmt == AV_PIX_FMT_NONE ||
+                    av_parse_video_size(&src_w, &src_h, z) < 0 ||
+                    av_parse_video_size(&dst_w, &dst_h, dst_size ? dst_size : z) < 0) {
+                    fprintf(stderr, "Invalid combination %s %s %s\n", s, d, z);
+                    ret = 1;
+                    continue;
+                }
+
+                flag_list = av_strdup(flags);
+                for (f = av_strtok(flag_list, ",", &flag_save); f; f = av_strtok(NULL, ",", &flag_save)) {
+                    double ms, c_ms;
+
+                    ms = sws_run(src_fmt, src_w, src_h, dst_fmt, dst_w, dst_h, f, nb_runs, &lfg);
+                    if (ms < 0) {
+                        fprintf(stderr, "Could not scale %s to %s with %s\n", s, d, f);
+                        ret = 1;
+                        continue;
+                    }
+                    printf("%s,%s,%dx%d,%dx%d,%s,%.3f", s, d, src_w, src_h,
+                           dst_w, dst_h, f, ms);
+                    if (compare_c) {
+                        av_force_cpu_flags(0);
+                        c_ms = sws_run(src_fmt, src_w, src_h, dst_fmt, dst_w, dst_h, f, nb_runs, &lfg);
+                        av_force_cpu_flags(cpu_flags);
+                        printf(",%.3f,%.2f", c_ms, c_ms / ms);
+                    }
+                    printf("\n");
+                    fflush(stdout);
+                }
+                av_free(flag_list);
+            }
+            av_free(size_list);
+        }
+        av_free(dst_list);
+    }
+    av_free(src_list);
+
+    return ret;
+}
+
+enum ImgOp {
+    IMG_COPY,
+    IMG_COPY_C,
+    IMG_THREADS,
+    IMG_SHIFT,
+    IMG_INTERLEAVE,
+    IMG_DEINTERLEAVE,
+    NB_IMG_OPS
+};
+
+/* copy_c is av_image_copy() with the CPU flags cleared, i.e. without the
+ * non-temporal stores for large planes, threads is av_image_copy_threaded()
+ * with one job per thread of a slice thread pool. shift shifts the luma plane by 6
+ * bits, interleave and deinterleave convert the chroma planes between the
+ * YUV420P and the NV12 layout. */
+static const char * const img_op_names[NB_IMG_OPS] = {
+    "copy", "copy_c", "threads", "shift", "interleave", "deinterleave",
+};
+
+typedef struct ImgThreads {
+    AVSliceThread *pool;
+    int nb_threads;
+    av_image_job_func *func;
+    void *arg;
+} ImgThreads;
+
+static void img_worker(void *priv, int jobnr, int threadnr, int nb_jobs,
+                       int nb_threads)
+{
+    ImgThreads *t = priv;
+
+    t->func(t->arg, jobnr, nb_jobs);
+}
+
+static void img_execute(void *opaque, av_image_job_func *func, void *arg,
+                        int nb_jobs)
+{
+    ImgThreads *t = opaque;
+
+    t->func = func;
+    t->arg  = arg;
+    avpriv_slicethread_execute(t->pool, nb_jobs, 0);
+}
+
+static void img_run(enum ImgOp op, Image *dst, Image *src,
+                    const AVPixFmtDescriptor *desc, enum AVPixelFormat fmt,
+                    int w, int h, ImgThreads *threads)
+{
+    int bps = (desc->comp[0].depth + 7) >> 3;
+    int cw  = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+    int ch  = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+    ptrdiff_t dst_linesizes[4], src_linesizes[4];
+    int i;
+
+    switch (op) {
+    case IMG_COPY:
+    case IMG_COPY_C:
+        av_image_copy(dst->data, dst->linesize, (const uint8_t **)src->data,
+                      src->linesize, fmt, w, h);
+        break;
+    case IMG_THREADS:
+        for (i = 0; i < 4; i++) {
+            dst_linesizes[i] = dst->linesize[i];
+            src_linesizes[i] = src->linesize[i];
+        }
+        av_image_copy_threaded(dst->data, dst_linesizes,
+                               (const uint8_t **)src->data, src_linesizes,
+                               fmt, w, h, img_execute, threads,
+                               threads->nb_threads);
+        break;
+    case IMG_SHIFT:
+        av_image_copy_plane_shift(dst->data[0], dst->linesize[0],
+                                  src->data[0], src->linesize[0], w, h, 6);
+        break;
+    /* the chroma planes of the image also hold the interleaved plane */
+    case IMG_INTERLEAVE:
+        av_image_interleave_planes(dst->data[1], 2 * dst->linesize[1],
+                                   src->data[1], src->linesize[1],
+                                   src->data[2], src->linesize[2],
+                                   cw, ch, bps, 0);
+        break;
+    case IMG_DEINTERLEAVE:
+        av_image_deinterleave_plane(dst->data[1], dst->linesize[1],
+                                    dst->data[2], dst->linesize[2],
+                                    src->data[1], 2 * src->linesize[1],
+                                    cw, ch, bps, 0);
+        break;
+    }
+}
+
+/* Returns the number of bytes read and written per image, 0 if the
+ * operation does not apply to the format. */
+static int64_t img_op_bytes(enum ImgOp op, const AVPixFmtDescriptor *desc,
+                            enum AVPixelFormat fmt, int w, int h)
+{
+    int bps = (desc->comp[0].depth + 7) >> 3;
+    int planar_chroma = desc->nb_components >= 3 &&
+                        desc->flags & AV_PIX_FMT_FLAG_PLANAR &&
+                        desc->comp[1].plane == 1 && desc->comp[2].plane == 2;
+
+    switch (op) {
+    case IMG_SHIFT:
+        if (bps != 2 || !(desc->flags & AV_PIX_FMT_FLAG_PLANAR))
+            return 0;
+        return 2LL * w * h * bps;
+    case IMG_INTERLEAVE:
+    case IMG_DEINTERLEAVE:
+        if (!planar_chroma || desc->log2_chroma_h == 0)
+            return 0;
+        return 4LL * AV_CEIL_RSHIFT(w, desc->log2_chroma_w) *
+               AV_CEIL_RSHIFT(h, desc->log2_chroma_h) * bps;
+    default:
+        return 2LL * av_image_get_buffer_size(fmt, w, h, 1);
+    }
+}
+
+static int bench_imgutils(int argc, char **argv)
+{
+    const char *fmts  = "yuv420p,yuv420p10le,rgb24";
+    const char *sizes = "1920x1080,3840x2160,7680x4320";
+    char *fmt_list, *size_list, *fmt_save, *size_save, *f, *z;
+    int cpu_flags = av_get_cpu_flags();
+    int nb_runs = 20, nb_threads = 0, opt, ret = 0;
+    ImgThreads threads = { NULL };
+    AVLFG lfg;
+
+    while ((opt = getopt(argc, argv, "hp:s:n:t:")) != -1) {
+        switch (opt) {
+        case 'p':
+            fmts = optarg;
+            break;
+        case 's':
+            sizes = optarg;
+            break;
+        case 'n':
+            nb_runs = FFMAX(strtol(optarg, NULL, 0), 1);
+            break;
+        case 't':
+            nb_threads = FFMAX(strtol(optarg, NULL, 0), 0);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-p pixel formats] [-s WxH,...] "
+                    "[-n runs] [-t threads]\n", argv[0]);
+            return opt != 'h';
+        }
+    }
+
+    /* without threads the threaded copy runs as a single job */
+    threads.nb_threads = FFMAX(avpriv_slicethread_create(&threads.pool, &threads,
+                                                         img_worker, NULL,
+                                                         nb_threads), 1);
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    printf("fmt,size,op,ms,gb_per_s\n");
+
+    fmt_list = av_strdup(fmts);
+    for (f = av_strtok(fmt_list, ",", &fmt_save); f; f = av_strtok(NULL, ",", &fmt_save)) {
+        enum AVPixelFormat fmt = av_get_pix_fmt(f);
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+
+        size_list = av_strdup(sizes);
+        for (z = av_strtok(size_list, ",", &size_save); z; z = av_strtok(NULL, ",", &size_save)) {
+            Image src = { { NULL } }, dst = { { NULL } };
+            int w, h, op, i;
+
+            if (!desc || av_parse_video_size(&w, &h, z) < 0) {
+                fprintf(stderr, "Invalid combination %s %s\n", f, z);
+                ret = 1;
+                continue;
+            }
+            if (alloc_image(&src, w, h, fmt, &lfg) < 0 ||
+                alloc_image(&dst, w, h, fmt, &lfg) < 0) {
+                fprintf(stderr, "Could not allocate %s %s\n", f, z);
+                ret = 1;
+                goto next;
+            }
+
+            for (op = 0; op < NB_IMG_OPS; op++) {
+                int64_t bytes = img_op_bytes(op, desc, fmt, w, h), start;
+                double ms;
+
+                if (!bytes)
+                    continue;
+                if (op == IMG_COPY_C)
+                    av_force_cpu_flags(0);
+                /* one untimed run to fault in the buffers */
+                img_run(op, &dst, &src, desc, fmt, w, h, &threads);
+                start = av_gettime_relative();
+                for (i = 0; i < nb_runs; i++)
+                    img_run(op, &dst, &src, desc, fmt, w, h, &threads);
+                ms = (av_gettime_relative() - start) / 1000.0 / nb_runs;
+                if (op == IMG_COPY_C)
+                    av_force_cpu_flags(cpu_flags);
+
+                printf("%s,%dx%d,%s,%.3f,%.2f\n", f, w, h, img_op_names[op],
+                       ms, bytes / ms / 1e6);
+                fflush(stdout);
+            }
+next:
+            av_freep(&src.data[0]);
+            av_freep(&dst.data[0]);
+        }
+        av_free(size_list);
+    }
+    av_free(fmt_list);
+    avpriv_slicethread_free(&threads.pool);
+
+    return ret;
+}
+
+static const struct {
+    const char *name;
+    int (*func)(int argc, char **argv);
+} tests[] = {
+    { "aenc",     bench_aenc     },
+    { "adec",     bench_adec     },
+    { "venc",     bench_venc     },
+    { "prores",   bench_prores   },
+    { "sws",      bench_sws      },
+    { "imgutils", bench_imgutils },
+};
+
+int main(int argc, char **argv)
+{
+    int i;
+
+    if (argc > 1) {
+        for (i = 0; i < FF_ARRAY_ELEMS(tests); i++)
+            if (!strcmp(argv[1], tests[i].name))
+                return tests[i].func(argc - 1, argv + 1);
+    }
+
+    fprintf(stderr, "Usage: %s <test> [options]\nTests:", argv[0]);
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++)
+        fprintf(stderr, " %s", tests[i].name);
+    fprintf(stderr, "\n");
+    return 1;
+}